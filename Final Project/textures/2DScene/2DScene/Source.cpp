@@ -1,8 +1,13 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-// For textures
+// For textures; stb_image's scratch memory comes from per-thread arenas (see decode_arena.h)
+#include <decode_arena.h>
 #define STB_IMAGE_IMPLEMENTATION
+#define STBI_MALLOC(size) decodeArenaMalloc(size)
+#define STBI_REALLOC_SIZED(pointer, oldSize, newSize) decodeArenaRealloc(pointer, oldSize, newSize)
+#define STBI_FREE(pointer) decodeArenaFree(pointer)
+#define STBI_MALLOC_RESULT(size) decodeArenaMallocResult(size)
 #include "stb_image.h"
 
 // GLM Math header
@@ -14,6 +19,24 @@
 #include <shader.h>
 // Include the camera header
 #include <camera.h>
+// Texture loading
+#include <texture_cache.h>
+// View frustum culling, to tell the texture cache what is on screen
+#include <frustum.h>
+// Compact vertex layout the meshes are uploaded in
+#include <vertex_format.h>
+#include <geometry_arena.h>
+#include <mesh_optimizer.h>
+#include <mesh_generators.h>
+#include <mesh_generator_benchmark.h>
+// Per-frame uniform buffer
+#include <frame_block.h>
+// Per-draw material constants
+#include <material_block.h>
+// Offscreen context and benchmark runner
+#include <alloc_counter.h>
+#include <headless.h>
+#include <benchmark.h>
 #include <iostream>
 #include <vector>
 
@@ -60,15 +83,32 @@ namespace
     // Stores the data relative to a given mesh
     struct GLMesh
     {
-        unsigned int VAOs[15];       // Vertex array objects
-        unsigned int lightCubeVAO;
-        unsigned int VBOs[15];       // Vertex buffer objects
-        unsigned int lightCubeVBO;
-        unsigned int EBOs[15];       // Element buffer objects
-        unsigned int indexCounts[11]; // Index counts
+        GeometryArena arena;         // vertex and index buffer every mesh below is suballocated from
+        MeshRange cube;              // Rubik's cube, all six faces with their texture array layer
+        MeshRange table;
+        MeshRange tableLeg;          // drawn once per leg
+        MeshRange plane;
+    };
+
 
+    // Uniform handles used by the render loop, resolved once after the shaders are linked.
+    // Camera and lights live in the FrameBlock uniform buffer instead.
+    struct SceneUniforms
+    {
+        // ourShader
+        Uniform<glm::mat4> model;
+        Uniform<glm::vec2> vertexScale;
+        Uniform<int> numTextures;
+        Uniform<bool> useTextureArray;
+
+        // lightCubeShader
+        Uniform<glm::mat4> lampModel;
+        Uniform<float> lampVertexScale;
     };
 
+    // FrameBlock slots: the scene lighting, and the dimmer directional light used for the floor
+    const int SCENE_LIGHTING = 0;
+    const int FLOOR_LIGHTING = 1;
 
     // Stores RGB values for specific colors
     struct color
@@ -95,13 +135,24 @@ namespace
     // Sets the color of the glass
     color glassColor;
 
+    // MaterialBlock slots, one per kind of surface (see createMaterials)
+    const int MATERIAL_GLASS = 0;   // first cylinder
+    const int MATERIAL_CAP = 1;     // second cylinder
+    const int MATERIAL_RUBIKS = 2;
+    const int MATERIAL_WOOD = 3;    // table top and legs
+    const int MATERIAL_FLOOR = 4;
+    const int MATERIAL_CAT = 5;
+    const int MATERIAL_COUNT = 6;
+
+    // Object color, specular and shininess of every draw
+    MaterialUniformBuffer materialBuffer;
+
     // Textures
-    unsigned int texture1;
-    unsigned int texture2;
-    unsigned int texture3;
-    unsigned int texture4;
-    unsigned int texture5;
-    unsigned int texture6;
+    TextureCache textureCache;
+    const size_t TEXTURE_UPLOAD_BUDGET = 8 * 1024 * 1024; // bytes streamed to the GPU per frame
+    const uint64_t TEXTURE_IDLE_FRAMES = 300; // frames a texture stays loaded after its last visible draw
+    const size_t TEXTURE_MEMORY_BUDGET = 256 * 1024 * 1024; // GPU bytes textures may hold
+    unsigned int cubeTexture;     // Rubik's cube faces, one GL_TEXTURE_2D_ARRAY layer each
     unsigned int texture7;
     unsigned int texture8;
 
@@ -111,6 +162,9 @@ namespace
     // Main window
     GLFWwindow* window = nullptr;
 
+    // Draw calls and triangles submitted in the current frame
+    FrameStats frameStats;
+
     // lighting
     glm::vec3 lightPos1(-3.0f, 1.5f, -3.0f);
     glm::vec3 lightPos2(4.0f, 0.5f, 0.0f);
@@ -124,24 +178,6 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 // Function to process input
 void processInput(GLFWwindow* window);
-// Function for generating cylinder side vertices
-std::vector<float> genCylSideVerts(int sides, float height, float radius, color color);
-// Function for generating cylinder top vertices
-std::vector<float> genCylTopVerts(int sides, float height, float radius, color color);
-// Funciton to generate cylinder top indices
-std::vector<unsigned int> genCylTopIndices(int sides);
-// Function for generating cylinder bottom vertices
-std::vector<float> genCylBottomVerts(int sides, float height, float radius, color color);
-// Funciton to generate cylinder bottom indices
-std::vector<unsigned int> genCylBottomIndices(int sides);
-// Function to generate sphere vertices
-std::vector<float> genSphereVerts(float radius, color color);
-// Function to generate sphere indices
-std::vector<unsigned int> genSphereIndices();
-// Function to generate a pyramids vertices
-std::vector<float> genPyramidVerts(int sides, float height, float radius, color color);
-// Function to generate a planes vertices
-std::vector<float> genPlaneVerts(int sections, color color);
 // Function to create textures
 void createTextures();
 
@@ -152,15 +188,43 @@ bool progInitialize(GLFWwindow** window);
 // Function to create the mesh
 void createMesh(GLMesh& mesh);
 
+// Fills materialBuffer with the scene's materials
+void createMaterials();
+// Function to look up the render loop's uniform handles
+SceneUniforms resolveSceneUniforms(const Shader& ourShader, const Shader& lightCubeShader);
+// Function to fill the per-frame camera and light constants
+FrameBlock makeFrameBlock(const glm::mat4& view, const DirLightStd140& dirLight);
+// Functions that issue a draw and record it in frameStats
+void drawArrays(GLenum mode, GLint first, GLsizei count);
+void drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+void drawMesh(const MeshRange& range);
 
-int main()
+
+int main(int argc, char** argv)
 {
-    if (!progInitialize(&window))
+    BenchmarkOptions options;
+    if (!options.parse(argc, argv))
+        return EXIT_FAILURE;
+    if (options.benchmarkMeshes)
+        return benchmarkMeshGenerators(std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    HeadlessContext headlessContext;
+    if (options.headless)
+    {
+        if (!headlessContext.create(SCR_WIDTH, SCR_HEIGHT))
+            return EXIT_FAILURE;
+    }
+    else if (!progInitialize(&window))
         return EXIT_FAILURE;
 
     createMesh(mesh);
+    createMaterials();
 
+    // the low-memory tier: every texture loads at most this large (JPEGs decode at reduced size)
+    textureCache.setMaxTextureSize(options.textureMaxSize);
     createTextures();
+    // --texture-budget 0 lifts the limit
+    textureCache.setMemoryBudget(options.textureBudgetMiB >= 0 ? static_cast<size_t>(options.textureBudgetMiB) * 1024 * 1024 : TEXTURE_MEMORY_BUDGET);
 
     glEnable(GL_DEPTH_TEST);
 
@@ -172,21 +236,78 @@ int main()
     ourShader.use();
     ourShader.setInt("material.diffuse1", 0);
     ourShader.setInt("material.diffuse2", 1);
+    ourShader.setInt("material.diffuseArray", 2);
+
+    // Resolve every uniform the render loop sets so it never looks a name up per frame
+    SceneUniforms uniforms = resolveSceneUniforms(ourShader, lightCubeShader);
+
+    // Camera and light constants, uploaded once per frame and shared by both programs
+    ourShader.bindUniformBlock("FrameBlock", FRAME_BLOCK_BINDING);
+    lightCubeShader.bindUniformBlock("FrameBlock", FRAME_BLOCK_BINDING);
+    ourShader.bindUniformBlock("MaterialBlock", MATERIAL_BLOCK_BINDING);
+    FrameUniformBuffer frameBuffer;
+    frameBuffer.create(2);
+
+    // directional light for the scene, and the dimmer one the floor is lit with
+    DirLightStd140 sceneDirLight = {};
+    sceneDirLight.direction = glm::vec3(-0.5f, -1.0f, 0.0f);
+    sceneDirLight.ambient = glm::vec3(0.4f, 0.4f, 0.4f);
+    sceneDirLight.diffuse = glm::vec3(0.6f, 0.6f, 0.6f);
+    sceneDirLight.specular = glm::vec3(0.3f, 0.3f, 0.3f);
+    DirLightStd140 floorDirLight = {};
+    floorDirLight.direction = glm::vec3(-0.5f, -1.0f, 0.0f);
+    floorDirLight.ambient = glm::vec3(0.1f, 0.1f, 0.1f);
+    floorDirLight.diffuse = glm::vec3(0.25f, 0.25f, 0.25f);
+    floorDirLight.specular = glm::vec3(0.01f, 0.01f, 0.01f);
 
     //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    // Headless runs follow a scripted camera path with a fixed timestep so every run renders the same frames
+    CameraPath cameraPath;
+    Frustum frustum;
+    BenchmarkRecorder recorder;
+    int totalFrames = options.warmupFrames + options.frames;
+    int frame = 0;
+    recorder.reserve(options.frames);
+    recorder.setVertexBufferBytes(mesh.arena.vertexBytes());
+    recorder.setIndexBufferBytes(mesh.arena.indexBytes());
+    if (options.headless)
+    {
+        toggleView(); // no input processing, so set the projection once
+    }
+
     // render loop
     // -----------
-    while (!glfwWindowShouldClose(window))
+    while (options.headless ? frame < totalFrames : !glfwWindowShouldClose(window))
     {
+        if (options.headless)
+        {
+            recorder.beginFrame();
+            deltaTime = 1.0f / 60.0f;
+            cameraPath.apply(camera, frame, totalFrames);
+        }
+        else
+        {
+            // per-frame time logic
+            float currentFrame = static_cast<float>(glfwGetTime());
+            deltaTime = currentFrame - lastFrame;
+            lastFrame = currentFrame;
+
+            // input
+            processInput(window);
+        }
 
-        // per-frame time logic
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
-        lastFrame = currentFrame;
+        frameStats.reset();
 
-        // input
-        processInput(window);
+        // upload a slice of any textures still streaming; decode/upload cost is written to stderr
+        // (stdout is kept free for the benchmark report) once the last one is resident
+        if (textureCache.update(TEXTURE_UPLOAD_BUDGET))
+            textureCache.writeReport(std::clog);
+        const TextureResidency& residency = textureCache.residency();
+        frameStats.textureBytes = residency.residentBytes;
+        frameStats.textureEvictions = static_cast<unsigned int>(residency.evictions);
+        frameStats.textureDrops = static_cast<unsigned int>(residency.drops);
+        frameStats.textureRestores = static_cast<unsigned int>(residency.restores);
 
         // Clears frame and sets background color
         //(0.698f, 0.863f, 1.0f, 1.0f); Original background color
@@ -194,40 +315,22 @@ int main()
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         
+        // camera/view transformation
+        glm::mat4 view = camera.GetViewMatrix();
+        // textures are loaded when a draw using them is first in view (textureCache.use)
+        frustum.extract(projection * view);
+
+        // camera, directional light and point lights for the whole frame in one buffer update
+        frameBuffer.write(SCENE_LIGHTING, makeFrameBlock(view, sceneDirLight));
+        frameBuffer.write(FLOOR_LIGHTING, makeFrameBlock(view, floorDirLight));
+        frameBuffer.upload();
+        frameBuffer.bind(SCENE_LIGHTING);
+
         // Activate Shader
         ourShader.use();
 
-        ourShader.setVec3("viewPos", camera.Position);
-
         // material properties
-        ourShader.setVec3("material.specular", 0.2f, 0.2f, 0.2f);
-        ourShader.setFloat("material.shininess", 30.0f);
-
-
-        // directional light
-        ourShader.setVec3("dirLight.direction", -0.5f, -1.0f, 0.0f);
-        ourShader.setVec3("dirLight.ambient", 0.4f, 0.4f, 0.4f);
-        ourShader.setVec3("dirLight.diffuse", 0.6f, 0.6f, 0.6f);
-        ourShader.setVec3("dirLight.specular", 0.3f, 0.3f, 0.3f);
-
-        // point light 1
-        ourShader.setVec3("pointLights[0].position", lightPos1);
-        ourShader.setVec3("pointLights[0].ambient", 0.1f, 0.1f, 0.1f);
-        ourShader.setVec3("pointLights[0].diffuse", 0.5f, 0.5f, 0.5f);
-        ourShader.setVec3("pointLights[0].specular", 0.6f, 0.6f, 0.6f);
-        ourShader.setFloat("pointLights[0].constant", 1.0f);
-        ourShader.setFloat("pointLights[0].linear", 0.007f);
-        ourShader.setFloat("pointLights[0].quadratic", 0.0002f);
-        ourShader.setVec3("pointLights[0].lightColor", 1.0f, 1.0f, 1.0f);
-        // point light 2
-        ourShader.setVec3("pointLights[1].position", lightPos2);
-        ourShader.setVec3("pointLights[1].ambient", 0.1f, 0.1f, 0.1f);
-        ourShader.setVec3("pointLights[1].diffuse", 0.3f, 0.3f, 0.3f);
-        ourShader.setVec3("pointLights[1].specular", 1.0f, 1.0f, 1.0f);
-        ourShader.setFloat("pointLights[1].constant", 1.0f);
-        ourShader.setFloat("pointLights[1].linear", 0.007f);
-        ourShader.setFloat("pointLights[1].quadratic", 0.0002f);
-        ourShader.setVec3("pointLights[1].lightColor", 1.0f, 1.0f, 1.0f);
+        materialBuffer.bind(MATERIAL_GLASS);
 
         // Check for OpenGL errors
         GLenum error = glGetError();
@@ -252,40 +355,17 @@ int main()
         glm::mat4 rotation = glm::rotate(glm::radians(30.0f), glm::vec3(0.f, 1.0f, 0.0f));
         // Sets the model
         model = translation * rotation;
-        ourShader.setMat4("model", model);
-
-        // Sets the projection (view type)
-        ourShader.setMat4("projection", projection); // Changes when P is pressed
-
-        // camera/view transformation
-        glm::mat4 view = camera.GetViewMatrix();
-        ourShader.setMat4("view", view);
+        ourShader.set(uniforms.model, model);
         
         // Bind textures For the first cylinder
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture3);
+        glBindTexture(GL_TEXTURE_2D, 0); // the cube face textures now live in cubeTexture
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, texture7);
-        glUniform1i(glGetUniformLocation(ourShader.ID, "numTextures"), 2);
+        ourShader.set(uniforms.numTextures, 2);
         
-        // First cylinder sides
-        glBindVertexArray(mesh.VAOs[0]);
-        // Draw the sides of the first cylinder
-        //glDrawElements(GL_TRIANGLES, mesh.indexCounts[0], GL_UNSIGNED_INT, 0);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, mesh.indexCounts[0]);
-
         glBindTexture(GL_TEXTURE_2D, 0);
-        glUniform1i(glGetUniformLocation(ourShader.ID, "numTextures"), 1);
-
-        // First cylinder top
-        glBindVertexArray(mesh.VAOs[1]);
-        // Draw the top of the first cylinder
-        glDrawElements(GL_TRIANGLES, mesh.indexCounts[1], GL_UNSIGNED_INT, 0);
-
-        // First cylinder bottom
-        glBindVertexArray(mesh.VAOs[2]);
-        // Draw the bottom of the first cylinder
-        glDrawElements(GL_TRIANGLES, mesh.indexCounts[2], GL_UNSIGNED_INT, 0);
+        ourShader.set(uniforms.numTextures, 1);
 
         // Unbind second texture
         glBindTexture(GL_TEXTURE_2D, 0);
@@ -298,179 +378,50 @@ int main()
         // Sets the model
         model = translation * rotation;
 
-        ourShader.setMat4("model", model);
-
-        // Second cylinder
-        glBindVertexArray(mesh.VAOs[3]);
+        ourShader.set(uniforms.model, model);
 
         // Bind texture for upper cylinder
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, 0);
-        glBindTexture(GL_TEXTURE_2D, texture2);
-        glUniform1i(glGetUniformLocation(ourShader.ID, "numTextures"), 1);
+        ourShader.set(uniforms.numTextures, 1);
 
         // Reset
-        ourShader.setVec3("material.specular", 0.0f, 0.0f, 0.0f);
-        ourShader.setFloat("material.shininess", 1.0f);
-
-        // Draw the second cylinder sides
-        //glDrawElements(GL_TRIANGLES, mesh.indexCounts[3], GL_UNSIGNED_INT, 0);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, mesh.indexCounts[3]);
-
-        // second cylinder top
-        glBindVertexArray(mesh.VAOs[4]);
-        // Draw the top of the first cylinder
-        glDrawElements(GL_TRIANGLES, mesh.indexCounts[4], GL_UNSIGNED_INT, 0);
-
-        // second cylinder bottom
-        glBindVertexArray(mesh.VAOs[5]);
-        // Draw the bottom of the first cylinder
-        glDrawElements(GL_TRIANGLES, mesh.indexCounts[5], GL_UNSIGNED_INT, 0); 
+        materialBuffer.bind(MATERIAL_CAP);
         
         /*
         Everything above this point is left in from the original code just to ensure proper function.
         The ONLY objects drawn are the rubik's cube, 1 light object, the table top and 4 table legs.
         */
 
-        // Bind textures for face 1 of cube
+        // Bind the face array for the Rubik's cube
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, cubeTexture);
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
+        ourShader.set(uniforms.useTextureArray, true);
 
         // Transforms the first object Rubik's Cube
-        // Face 1
         translation = glm::translate(glm::vec3(0.5f, 0.45f, 0.1f)); // places it on top of the table
         // Rotate the object slightly
         rotation = glm::rotate(glm::radians(-5.0f), glm::vec3(0.f, 1.0f, 0.0f));
         // Sets the model
         model = translation * rotation;
 
-        ourShader.setMat4("model", model);
-
-        // Make cube shiny
-        ourShader.setVec3("material.specular", 0.8f, 0.8f, 0.8f);
-        ourShader.setFloat("material.shininess", 70.0f);
-
-        // Next face (Cube)
-        glBindVertexArray(mesh.VAOs[0]);
-
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        // Bind textures for face 2 of cube
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindTexture(GL_TEXTURE_2D, texture2);
-
-        // Face 2
-        translation = glm::translate(glm::vec3(0.5f, 0.45f, 0.1f)); // places it ontop of the table
-        // Rotate the object slightly
-        rotation = glm::rotate(glm::radians(-5.0f), glm::vec3(0.f, 1.0f, 0.0f));
-        // Sets the model
-        model = translation * rotation;
-
-        ourShader.setMat4("model", model);
-
-        // Make cube shiny
-        ourShader.setVec3("material.specular", 0.8f, 0.8f, 0.8f);
-        ourShader.setFloat("material.shininess", 70.0f);
-
-        // Next face (Cube)
-        glBindVertexArray(mesh.VAOs[1]);
-
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        // Bind textures for face 3 of cube
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindTexture(GL_TEXTURE_2D, texture4);
-
-        // Face 3
-        translation = glm::translate(glm::vec3(0.5f, 0.45f, 0.1f)); // places it ontop of the table
-        // Rotate the object slightly
-        rotation = glm::rotate(glm::radians(-5.0f), glm::vec3(0.f, 1.0f, 0.0f));
-        // Sets the model
-        model = translation * rotation;
-
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
         // Make cube shiny
-        ourShader.setVec3("material.specular", 0.8f, 0.5f, 0.8f);
-        ourShader.setFloat("material.shininess", 70.0f);
+        materialBuffer.bind(MATERIAL_RUBIKS);
 
-        // Next face (Cube)
-        glBindVertexArray(mesh.VAOs[2]);
+        // All six faces (Cube), each vertex carrying the layer of its face
+        if (frustum.intersects(model, mesh.cube.bounds))
+            textureCache.use(cubeTexture);
+        // every mesh below draws from the arena's vertex array
+        mesh.arena.bind();
+        ourShader.set(uniforms.vertexScale, mesh.cube.scale);
 
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        drawMesh(mesh.cube);
 
-        // Bind textures for face 4 of cube
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindTexture(GL_TEXTURE_2D, texture3);
-
-        // Face 4
-        translation = glm::translate(glm::vec3(0.5f, 0.45f, 0.1f)); // places it ontop of the table
-        // Rotate the object slightly
-        rotation = glm::rotate(glm::radians(-5.0f), glm::vec3(0.f, 1.0f, 0.0f));
-        // Sets the model
-        model = translation * rotation;
-
-        ourShader.setMat4("model", model);
-
-        // Make cube shiny
-        ourShader.setVec3("material.specular", 0.8f, 0.8f, 0.8f);
-        ourShader.setFloat("material.shininess", 70.0f);
-
-        // Next face (Cube)
-        glBindVertexArray(mesh.VAOs[3]);
-
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        // Bind textures for face 5 of cube
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindTexture(GL_TEXTURE_2D, texture6);
-
-        // Face 5
-        translation = glm::translate(glm::vec3(0.5f, 0.45f, 0.1f)); // places it ontop of the table
-        // Rotate the object slightly
-        rotation = glm::rotate(glm::radians(-5.0f), glm::vec3(0.f, 1.0f, 0.0f));
-        // Sets the model
-        model = translation * rotation;
-
-        ourShader.setMat4("model", model);
-
-        // Make cube shiny
-        ourShader.setVec3("material.specular", 0.8f, 0.8f, 0.8f);
-        ourShader.setFloat("material.shininess", 70.0f);
-
-        // Next face (Cube)
-        glBindVertexArray(mesh.VAOs[4]);
-
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        // Bind textures for face 6 of cube
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glBindTexture(GL_TEXTURE_2D, texture5);
-
-        // Face 6
-        translation = glm::translate(glm::vec3(0.5f, 0.45f, 0.1f)); // places it ontop of the table
-        // Rotate the object slightly
-        rotation = glm::rotate(glm::radians(-5.0f), glm::vec3(0.f, 1.0f, 0.0f));
-        // Sets the model
-        model = translation * rotation;
-
-        ourShader.setMat4("model", model);
-
-        // Make cube shiny
-        ourShader.setVec3("material.specular", 0.8f, 0.8f, 0.8f);
-        ourShader.setFloat("material.shininess", 70.0f);
-
-        // Next object (Table)
-        glBindVertexArray(mesh.VAOs[5]);
-
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        ourShader.set(uniforms.useTextureArray, false);
 
         // Bind textures for table top
 
@@ -485,16 +436,17 @@ int main()
         // Sets the model
         model = translation * rotation;
 
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
         // Make table shiny
-        ourShader.setVec3("material.specular", 0.8f, 0.8f, 0.8f);
-        ourShader.setFloat("material.shininess", 70.0f);
+        materialBuffer.bind(MATERIAL_WOOD);
 
         // Next object (Table)
-        glBindVertexArray(mesh.VAOs[6]);
+        if (frustum.intersects(model, mesh.table.bounds))
+            textureCache.use(texture7);
+        ourShader.set(uniforms.vertexScale, mesh.table.scale);
 
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        drawMesh(mesh.table);
 
         // Bind textures for Table Leg 1
         glActiveTexture(GL_TEXTURE0);
@@ -509,16 +461,17 @@ int main()
         // Sets the model
         model = translation * rotation;
 
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
         // Make cube shiny
-        ourShader.setVec3("material.specular", 0.8f, 0.8f, 0.8f);
-        ourShader.setFloat("material.shininess", 70.0f);
+        materialBuffer.bind(MATERIAL_WOOD);
 
         // Next object (Table)
-        glBindVertexArray(mesh.VAOs[8]);
+        if (frustum.intersects(model, mesh.tableLeg.bounds))
+            textureCache.use(texture7);
+        ourShader.set(uniforms.vertexScale, mesh.tableLeg.scale);
 
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        drawMesh(mesh.tableLeg);
 
         // Bind textures for Table Leg 2
         glActiveTexture(GL_TEXTURE0);
@@ -533,16 +486,17 @@ int main()
         // Sets the model
         model = translation * rotation;
 
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
         // Make cube shiny
-        ourShader.setVec3("material.specular", 0.8f, 0.8f, 0.8f);
-        ourShader.setFloat("material.shininess", 70.0f);
+        materialBuffer.bind(MATERIAL_WOOD);
 
         // Next object (Table)
-        glBindVertexArray(mesh.VAOs[9]);
+        if (frustum.intersects(model, mesh.tableLeg.bounds))
+            textureCache.use(texture7);
+        ourShader.set(uniforms.vertexScale, mesh.tableLeg.scale);
 
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        drawMesh(mesh.tableLeg);
 
         // Bind textures for Table Leg 3
         glActiveTexture(GL_TEXTURE0);
@@ -556,16 +510,17 @@ int main()
         // Sets the model
         model = translation * rotation;
 
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
         // Make cube shiny
-        ourShader.setVec3("material.specular", 0.8f, 0.8f, 0.8f);
-        ourShader.setFloat("material.shininess", 70.0f);
+        materialBuffer.bind(MATERIAL_WOOD);
 
         // Next object (Table)
-        glBindVertexArray(mesh.VAOs[10]);
+        if (frustum.intersects(model, mesh.tableLeg.bounds))
+            textureCache.use(texture7);
+        ourShader.set(uniforms.vertexScale, mesh.tableLeg.scale);
 
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        drawMesh(mesh.tableLeg);
 
         // Bind textures for Table Leg 4
         glActiveTexture(GL_TEXTURE0);
@@ -579,16 +534,17 @@ int main()
         // Sets the model
         model = translation * rotation;
 
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
         // Make cube shiny
-        ourShader.setVec3("material.specular", 0.8f, 0.8f, 0.8f);
-        ourShader.setFloat("material.shininess", 70.0f);
+        materialBuffer.bind(MATERIAL_WOOD);
 
         // Next object (Plane)
-        glBindVertexArray(mesh.VAOs[11]);
+        if (frustum.intersects(model, mesh.tableLeg.bounds))
+            textureCache.use(texture7);
+        ourShader.set(uniforms.vertexScale, mesh.tableLeg.scale);
 
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        drawMesh(mesh.tableLeg);
 
         // Bind textures for Plane
         glActiveTexture(GL_TEXTURE0);
@@ -602,28 +558,23 @@ int main()
         // Sets the model
         model = translation * scale;
 
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
         // Adjust Specular/Shininess
-        ourShader.setVec3("material.specular", 0.6f, 0.6f, 0.6f);
-        ourShader.setFloat("material.shininess", 200.0f);
+        materialBuffer.bind(MATERIAL_FLOOR);
 
         // directional light
-        ourShader.setVec3("dirLight.direction", -0.5f, -1.0f, 0.0f);
-        ourShader.setVec3("dirLight.ambient", 0.1f, 0.1f, 0.1f);
-        ourShader.setVec3("dirLight.diffuse", 0.25f, 0.25f, 0.25f);
-        ourShader.setVec3("dirLight.specular", 0.01f, 0.01f, 0.01f);
+        frameBuffer.bind(FLOOR_LIGHTING);
 
         // Fourth Object (Plane)
-        glBindVertexArray(mesh.VAOs[7]);
+        if (frustum.intersects(model, mesh.plane.bounds))
+            textureCache.use(texture8);
+        ourShader.set(uniforms.vertexScale, mesh.plane.scale);
 
-        glDrawArrays(GL_TRIANGLES, 0, mesh.indexCounts[7]);
+        drawMesh(mesh.plane);
 
         // directional light
-        ourShader.setVec3("dirLight.direction", -0.5f, -1.0f, 0.0f);
-        ourShader.setVec3("dirLight.ambient", 0.2f, 0.2f, 0.2f);
-        ourShader.setVec3("dirLight.diffuse", 0.4f, 0.4f, 0.4f);
-        ourShader.setVec3("dirLight.specular", 0.3f, 0.3f, 0.3f);
+        frameBuffer.bind(SCENE_LIGHTING);
 
         float xScale = 0.625f / 0.5625f;
         float zScale = 0.125f / 0.5625f;
@@ -635,8 +586,7 @@ int main()
         glBindTexture(GL_TEXTURE_2D, texture8);
 
         // Reset
-        ourShader.setVec3("material.specular", 0.0f, 0.0f, 0.0f);
-        ourShader.setFloat("material.shininess", 1.0f);
+        materialBuffer.bind(MATERIAL_CAT);
         
         // Transforms the fifth object (sphere 1)
         // Scales the object
@@ -649,12 +599,12 @@ int main()
         // Sets the model
         model = translation * rotation2 * rotation * scale;
 
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
         // Fifth Object (Sphere 1)
         glBindVertexArray(mesh.VAOs[8]);
 
-        glDrawElements(GL_TRIANGLES, mesh.indexCounts[8], GL_UNSIGNED_INT, 0);
+        drawElements(GL_TRIANGLES, mesh.indexCounts[8], GL_UNSIGNED_INT, 0);
 
         // Bind textures for sphere 2
         glActiveTexture(GL_TEXTURE0);
@@ -664,7 +614,7 @@ int main()
         glBindTexture(GL_TEXTURE_2D, texture1);
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, texture6); // Face Texture 
-        glUniform1i(glGetUniformLocation(ourShader.ID, "numTextures"), 2); // Change to 2  for face
+        ourShader.set(uniforms.numTextures, 2); // Change to 2  for face
 
         zScale = 0.1875 / 0.5625;
 
@@ -679,15 +629,15 @@ int main()
         // Sets the model
         model = translation * rotation2 * rotation * scale;
 
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
-        glDrawElements(GL_TRIANGLES, mesh.indexCounts[8], GL_UNSIGNED_INT, 0);
+        drawElements(GL_TRIANGLES, mesh.indexCounts[8], GL_UNSIGNED_INT, 0);
 
         // Bind textures for cat body (cylinder 3)
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, 0);
         glBindTexture(GL_TEXTURE_2D, texture1);
-        glUniform1i(glGetUniformLocation(ourShader.ID, "numTextures"), 1);
+        ourShader.set(uniforms.numTextures, 1);
 
         // Transforms the sixth object (cylinder 3)
         // Scales the object
@@ -702,12 +652,12 @@ int main()
         model = translation * rotation3 * rotation2 * rotation * scale;
         
 
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
         // Sixth Object (cyl 3)
         glBindVertexArray(mesh.VAOs[9]);
         
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, mesh.indexCounts[9]);
+        drawArrays(GL_TRIANGLE_STRIP, 0, mesh.indexCounts[9]);
         
 
         // Transforms the seventh object (cone 1)
@@ -718,12 +668,12 @@ int main()
         // Sets the model
         model = translation * rotation2;
 
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
         // 8th Object (cone)
         glBindVertexArray(mesh.VAOs[10]);
 
-        glDrawArrays(GL_TRIANGLES, 0, mesh.indexCounts[10] / 9);
+        drawArrays(GL_TRIANGLES, 0, mesh.indexCounts[10] / 9);
 
         // Transforms the seventh object (gives cone 2)
         // Moves object
@@ -734,337 +684,171 @@ int main()
         // Sets the model
         model = translation * rotation2 * rotation;
 
-        ourShader.setMat4("model", model);
+        ourShader.set(uniforms.model, model);
 
         // seventh Object (cone)
         glBindVertexArray(mesh.VAOs[10]);
 
-        glDrawArrays(GL_TRIANGLES, 0, mesh.indexCounts[10] / 9);
+        drawArrays(GL_TRIANGLES, 0, mesh.indexCounts[10] / 9);
         */
 
-        glBindVertexArray(mesh.lightCubeVAO);
-
-        // also draw the lamp object
+        // also draw the lamp object (the lamps are scaled to nothing, so any arena mesh will do)
         lightCubeShader.use();
-        lightCubeShader.setMat4("projection", projection);
-        lightCubeShader.setMat4("view", view);
+        lightCubeShader.set(uniforms.lampVertexScale, mesh.cube.scale.x);
         model = glm::mat4(1.0f);
         model = glm::translate(model, lightPos1);
         model = glm::scale(model, glm::vec3(0.0f)); // a smaller cube
-        lightCubeShader.setMat4("model", model);
+        lightCubeShader.set(uniforms.lampModel, model);
 
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        drawMesh(mesh.cube);
         
         // also draw the lamp object
         lightCubeShader.use();
-        lightCubeShader.setMat4("projection", projection);
-        lightCubeShader.setMat4("view", view);
         model = glm::mat4(1.0f);
         model = glm::translate(model, lightPos2);
         model = glm::scale(model, glm::vec3(0.0f)); // a smaller cube
-        lightCubeShader.setMat4("model", model);
-
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-
-
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
-    }
-
-    // optional: de-allocate all resources once they've outlived their purpose:
-    // ------------------------------------------------------------------------
-    glDeleteVertexArrays(12, mesh.VAOs);
-    glDeleteBuffers(12, mesh.VBOs);
-    glDeleteBuffers(12, mesh.EBOs);
-
-    // glfw: terminate, clearing all previously allocated GLFW resources.
-    // ------------------------------------------------------------------
-    glfwTerminate();
-    return 0;
-}
-
-void createTextures() {
-    // load textures
-    // load image, create texture and generate mipmaps
-    int width, height, nrChannels;
-    // Find file
-    unsigned char* data = stbi_load(("resources/Rubiks1.png"), &width, &height, &nrChannels, 0);
-    if (data) {
-        stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-        glGenTextures(1, &texture1);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        // set the texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // Check channels
-        if (nrChannels == 3)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else if (nrChannels == 4)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else
-        {
-            std::cout << "Not implemented to handle image with " << nrChannels << " channels" << std::endl;
-        }
-
-
-        stbi_image_free(data);
-    }
-    // Find file
-    data = stbi_load(("resources/Rubiks2.png"), &width, &height, &nrChannels, 0);
-    if (data) {
-        stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-        glGenTextures(1, &texture2);
-        glBindTexture(GL_TEXTURE_2D, texture2);
-        // set the texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // Check channels
-        if (nrChannels == 3)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else if (nrChannels == 4)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else
-        {
-            std::cout << "Not implemented to handle image with " << nrChannels << " channels" << std::endl;
-        }
+        lightCubeShader.set(uniforms.lampModel, model);
 
-        glGenerateMipmap(GL_TEXTURE_2D);
+        drawMesh(mesh.cube);
 
-        stbi_image_free(data);
 
-        glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-    }
-    // Find file
-    data = stbi_load(("resources/Rubiks3.png"), &width, &height, &nrChannels, 0);
-    if (data) {
-        stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-        glGenTextures(1, &texture3);
-        glBindTexture(GL_TEXTURE_2D, texture3);
-        // set the texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // Check channels
-        if (nrChannels == 3)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else if (nrChannels == 4)
+        if (options.headless)
         {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
+            // wait for the GPU so the frame time includes rendering, not just command submission
+            glFinish();
+            if (frame >= options.warmupFrames)
+                recorder.endFrame(frameStats);
+
+            // finish loading what this frame first saw outside the timed region, so every run renders
+            // the same frames
+            if (textureCache.flush())
+                textureCache.writeReport(std::clog);
         }
         else
         {
-            std::cout << "Not implemented to handle image with " << nrChannels << " channels" << std::endl;
+            // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+            // -------------------------------------------------------------------------------
+            glfwSwapBuffers(window);
+            glfwPollEvents();
         }
-
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        stbi_image_free(data);
-
-        glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+        ++frame;
     }
-    // Find file
-    data = stbi_load(("resources/Rubiks4.png"), &width, &height, &nrChannels, 0);
-    if (data) {
-        stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-        glGenTextures(1, &texture4);
-        glBindTexture(GL_TEXTURE_2D, texture4);
-        // set the texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // Check channels
-        if (nrChannels == 3)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else if (nrChannels == 4)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else
-        {
-            std::cout << "Not implemented to handle image with " << nrChannels << " channels" << std::endl;
-        }
 
-        glGenerateMipmap(GL_TEXTURE_2D);
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    mesh.arena.destroy();
+    frameBuffer.destroy();
+    materialBuffer.destroy();
+    textureCache.clear();
 
-        stbi_image_free(data);
+    if (options.headless)
+    {
+        bool written = recorder.writeReport(options.reportPath, SCR_WIDTH, SCR_HEIGHT, options.warmupFrames);
+        if (!options.capturePath.empty())
+            written = headlessContext.capture(options.capturePath, SCR_WIDTH, SCR_HEIGHT) && written;
+        headlessContext.destroy();
 
-        glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-    }
-    // Find file
-    data = stbi_load(("resources/Rubiks5.png"), &width, &height, &nrChannels, 0);
-    if (data) {
-        stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-        glGenTextures(1, &texture5);
-        glBindTexture(GL_TEXTURE_2D, texture5);
-        // set the texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
-        // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // Check channels
-        if (nrChannels == 3)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else if (nrChannels == 4)
+        // the steady-state render loop must not touch the heap; treat a regression as a failed run
+        if (!recorder.allocationsWithin(options.maxFrameAllocations))
         {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
+            std::cout << "ERROR::BENCHMARK::RENDER_LOOP_ALLOCATES: more than " << options.maxFrameAllocations
+                << " heap allocation(s) in a measured frame" << std::endl;
+            return EXIT_FAILURE;
         }
-        else
-        {
-            std::cout << "Not implemented to handle image with " << nrChannels << " channels" << std::endl;
-        }
-
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        stbi_image_free(data);
-
-        glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+        return written ? EXIT_SUCCESS : EXIT_FAILURE;
     }
-    // Find file
-    data = stbi_load(("resources/Rubiks6.png"), &width, &height, &nrChannels, 0);
-    if (data) {
-        stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-        glGenTextures(1, &texture6);
-        glBindTexture(GL_TEXTURE_2D, texture6);
-        // set the texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // Check channels
-        if (nrChannels == 3)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else if (nrChannels == 4)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else
-        {
-            std::cout << "Not implemented to handle image with " << nrChannels << " channels" << std::endl;
-        }
-
-        glGenerateMipmap(GL_TEXTURE_2D);
 
-        stbi_image_free(data);
-
-        glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-    }
-    // Find file
-    data = stbi_load(("resources/WoodTexture.jpg"), &width, &height, &nrChannels, 0);
-    if (data) {
-        stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-        glGenTextures(1, &texture7);
-        glBindTexture(GL_TEXTURE_2D, texture7);
-        // set the texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // Check channels
-        if (nrChannels == 3)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else if (nrChannels == 4)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else
-        {
-            std::cout << "Not implemented to handle image with " << nrChannels << " channels" << std::endl;
-        }
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
 
-        glGenerateMipmap(GL_TEXTURE_2D);
+// Looks up the uniform handles the render loop uses
+SceneUniforms resolveSceneUniforms(const Shader& ourShader, const Shader& lightCubeShader)
+{
+    SceneUniforms uniforms;
+    uniforms.model = ourShader.uniform<glm::mat4>("model");
+    uniforms.vertexScale = ourShader.uniform<glm::vec2>("vertexScale");
+    uniforms.numTextures = ourShader.uniform<int>("numTextures");
+    uniforms.useTextureArray = ourShader.uniform<bool>("useTextureArray");
+
+    uniforms.lampModel = lightCubeShader.uniform<glm::mat4>("model");
+    uniforms.lampVertexScale = lightCubeShader.uniform<float>("vertexScale");
+    return uniforms;
+}
 
-        stbi_image_free(data);
+// Builds the FrameBlock for this frame: camera, the given directional light and both point lights
+FrameBlock makeFrameBlock(const glm::mat4& view, const DirLightStd140& dirLight)
+{
+    FrameBlock block = {};
+    block.view = view;
+    block.projection = projection; // Changes when P is pressed
+    block.viewPos = camera.Position;
+    block.dirLight = dirLight;
+
+    // point light 1
+    block.pointLights[0].position = lightPos1;
+    block.pointLights[0].ambient = glm::vec3(0.1f, 0.1f, 0.1f);
+    block.pointLights[0].diffuse = glm::vec3(0.5f, 0.5f, 0.5f);
+    block.pointLights[0].specular = glm::vec3(0.6f, 0.6f, 0.6f);
+    block.pointLights[0].constant = 1.0f;
+    block.pointLights[0].linear = 0.007f;
+    block.pointLights[0].quadratic = 0.0002f;
+    block.pointLights[0].lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+    // point light 2
+    block.pointLights[1].position = lightPos2;
+    block.pointLights[1].ambient = glm::vec3(0.1f, 0.1f, 0.1f);
+    block.pointLights[1].diffuse = glm::vec3(0.3f, 0.3f, 0.3f);
+    block.pointLights[1].specular = glm::vec3(1.0f, 1.0f, 1.0f);
+    block.pointLights[1].constant = 1.0f;
+    block.pointLights[1].linear = 0.007f;
+    block.pointLights[1].quadratic = 0.0002f;
+    block.pointLights[1].lightColor = glm::vec3(1.0f, 1.0f, 1.0f);
+    return block;
+}
 
-        glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-    }
-    // Find file
-    data = stbi_load(("resources/Black Texture.jpg"), &width, &height, &nrChannels, 0);
-    if (data) {
-        stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-        glGenTextures(1, &texture8);
-        glBindTexture(GL_TEXTURE_2D, texture8);
-        // set the texture wrapping parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        // set texture filtering parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // Check channels
-        if (nrChannels == 3)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else if (nrChannels == 4)
-        {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-        }
-        else
-        {
-            std::cout << "Not implemented to handle image with " << nrChannels << " channels" << std::endl;
-        }
+// Draws count vertices and records the call for the benchmark report
+void drawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    glDrawArrays(mode, first, count);
+    frameStats.addDraw(mode, count);
+}
 
-        glGenerateMipmap(GL_TEXTURE_2D);
+// Draws count indices and records the call for the benchmark report
+void drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    glDrawElements(mode, count, type, indices);
+    frameStats.addDraw(mode, count);
+}
 
-        stbi_image_free(data);
+// Draws one mesh of the bound geometry arena and records the call for the benchmark report
+void drawMesh(const MeshRange& range)
+{
+    glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, ARENA_INDEX_TYPE, range.indexOffset(), range.baseVertex);
+    frameStats.addDraw(GL_TRIANGLES, range.indexCount);
+}
 
-        glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-    }
+void createTextures() {
+    // every texture the scene uses is listed in the manifest (path, wrap/filter settings, flip).
+    // Textures baked into textures.pack by texbake are uploaded right away from the mapped pack;
+    // for the rest this only creates placeholders and queues the decodes, and the render loop
+    // streams the pixels in. Without a pack everything is decoded, or mapped from decoded_cache/
+    // when an earlier run has already decoded the same file.
+    textureCache.usePack("textures.pack");
+    textureCache.useDiskCache("decoded_cache", 256ull * 1024 * 1024);
+    textureCache.loadManifest("textures.txt");
+    textureCache.setIdleEviction(TEXTURE_IDLE_FRAMES);
+
+    cubeTexture = textureCache.get("rubiks");
+    texture7 = textureCache.get("wood");
+    texture8 = textureCache.get("black");
 }
 
 // createMesh features additional vertices for the table and the table legs. Scroll lower to see more. 
 
-// Function to create mesh
-void createMesh(GLMesh &mesh) {
-
+void createMaterials()
+{
     noColor.redValue = 1.0f;
     noColor.greenValue = 1.0f;
     noColor.blueValue = 1.0f;
@@ -1075,24 +859,46 @@ void createMesh(GLMesh &mesh) {
     glassColor.blueValue = 0.812f;
     glassColor.alphaValue = 1.0f;
 
+    catColor.redValue = 0.62f;
+    catColor.greenValue = 0.929f;
+    catColor.blueValue = 0.243f;
+    catColor.alphaValue = 1.0f;
+
+    auto material = [](const color& color, float specular, float shininess)
+    {
+        return MaterialBlock{ glm::vec4(color.redValue, color.greenValue, color.blueValue, color.alphaValue), glm::vec3(specular), shininess };
+    };
+    std::vector<MaterialBlock> materials(MATERIAL_COUNT);
+    materials[MATERIAL_GLASS] = material(glassColor, 0.2f, 30.0f);
+    materials[MATERIAL_CAP] = material(noColor, 0.0f, 1.0f);
+    materials[MATERIAL_RUBIKS] = material(noColor, 0.8f, 70.0f);
+    materials[MATERIAL_WOOD] = material(noColor, 0.8f, 70.0f);
+    materials[MATERIAL_FLOOR] = material(noColor, 0.6f, 200.0f);
+    materials[MATERIAL_CAT] = material(catColor, 0.0f, 1.0f);
+    materialBuffer.create(materials);
+}
+
+// Function to create mesh
+void createMesh(GLMesh &mesh) {
+
     // All size values are 1/4 of real life sizes in inches
     /*
     // Generates the first cylinder's side vetices and indices
-    std::vector<float> cylSideVertices1 = genCylSideVerts(sides, 0.75, 0.59375f, glassColor);
+    std::vector<float> cylSideVertices1 = genCylSideVerts(sides, 0.75, 0.59375f);
     // Generates the first cylinder's top vetices and indices
-    std::vector<float> cylTopVertices1 = genCylTopVerts(sides, 0.75, 0.59375f, glassColor);
+    std::vector<float> cylTopVertices1 = genCylTopVerts(sides, 0.75, 0.59375f);
     std::vector<unsigned int> cylTopIndices1 = genCylTopIndices(sides);
     // Generates the first cylinder's bottom vetices and indices
-    std::vector<float> cylBottomVertices1 = genCylBottomVerts(sides, 0.75, 0.59375f, glassColor);
+    std::vector<float> cylBottomVertices1 = genCylBottomVerts(sides, 0.75, 0.59375f);
     std::vector<unsigned int> cylBottomIndices1 = genCylBottomIndices(sides);
 
     // Generates the second cylinder's vetices and indices
-    std::vector<float> cylSideVertices2 = genCylSideVerts(sides, 0.03125f, 0.57f, noColor);
+    std::vector<float> cylSideVertices2 = genCylSideVerts(sides, 0.03125f, 0.57f);
     // Generates the second cylinder's top vetices and indices
-    std::vector<float> cylTopVertices2 = genCylTopVerts(sides, 0.03125f, 0.57f, noColor);
+    std::vector<float> cylTopVertices2 = genCylTopVerts(sides, 0.03125f, 0.57f);
     std::vector<unsigned int> cylTopIndices2 = genCylTopIndices(sides);
     // Generates the second cylinder's bottom vetices and indices
-    std::vector<float> cylBottomVertices2 = genCylBottomVerts(sides, 0.03125f, 0.57f, noColor);
+    std::vector<float> cylBottomVertices2 = genCylBottomVerts(sides, 0.03125f, 0.57f);
     std::vector<unsigned int> cylBottomIndices2 = genCylBottomIndices(sides);*/
 
     // Sets the length, width, and height of the cube
@@ -1100,223 +906,220 @@ void createMesh(GLMesh &mesh) {
     float width = 1.0f;
     float height = 1.0f;
 
-    // Define the vertices of the cube and their associated colors
+    // Define the vertices of the cube (their color comes from the draw's material)
     float cubeFace1Verts[] = { // Rubik's cube faces
         // Front Face Triangle 1
-        // width          height           length         normals              color                        texture
-       -width / 5,    -height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 0
-        width / 5,    -height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 1
-        width / 5,     height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 2
+        // width          height           length         normals              texture
+       -width / 5,    -height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    0.0f, 0.0f,     // Vertex 0
+        width / 5,    -height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    1.0f, 0.0f,     // Vertex 1
+        width / 5,     height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f,     // Vertex 2
 
         // Front Face Triangle 2
-       -width / 5,    -height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 0
-        width / 5,     height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 2
-       -width / 5,     height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 3
+       -width / 5,    -height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    0.0f, 0.0f,     // Vertex 0
+        width / 5,     height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f,     // Vertex 2
+       -width / 5,     height / 5,     -length / 5,    0.0f, 0.0f, 1.0f,    0.0f, 1.0f,     // Vertex 3
     };
     float cubeFace2Verts[] = {
-        // width          height           length         normals              color                        texture
+        // width          height           length         normals              texture
         // Left Face Triangle 1
-       -width / 5,    -height / 5,     -length / 5,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 0
-       -width / 5,    -height / 5,      length / 5,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 4
-       -width / 5,     height / 5,      length / 5,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+       -width / 5,    -height / 5,     -length / 5,    -1.0f, 0.0f, 0.0f,   1.0f, 0.0f,     // Vertex 0
+       -width / 5,    -height / 5,      length / 5,    -1.0f, 0.0f, 0.0f,   0.0f, 0.0f,     // Vertex 4
+       -width / 5,     height / 5,      length / 5,    -1.0f, 0.0f, 0.0f,   0.0f, 1.0f,     // Vertex 7
        
         // Left Face Triangle 2
-       -width / 5,    -height / 5,     -length / 5,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 0
-       -width / 5,     height / 5,     -length / 5,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 3
-       -width / 5,     height / 5,      length / 5,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+       -width / 5,    -height / 5,     -length / 5,    -1.0f, 0.0f, 0.0f,   1.0f, 0.0f,     // Vertex 0
+       -width / 5,     height / 5,     -length / 5,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f,     // Vertex 3
+       -width / 5,     height / 5,      length / 5,    -1.0f, 0.0f, 0.0f,   0.0f, 1.0f,     // Vertex 7
     };
     float cubeFace3Verts[] = {
         // Right Face Triangle 1
-        width / 5,    -height / 5,     -length / 5,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 1
-        width / 5,    -height / 5,      length / 5,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 5
-        width / 5,     height / 5,      length / 5,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,     1.0f, 1.0f,      // Vertex 6
+        width / 5,    -height / 5,     -length / 5,    1.0f, 0.0f, 0.0f,    0.0f, 0.0f,     // Vertex 1
+        width / 5,    -height / 5,      length / 5,    1.0f, 0.0f, 0.0f,    1.0f, 0.0f,     // Vertex 5
+        width / 5,     height / 5,      length / 5,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f,      // Vertex 6
 
         // Right Face Triangle 2
-        width / 5,    -height / 5,     -length / 5,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 1
-        width / 5,     height / 5,     -length / 5,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 2
-        width / 5,     height / 5,      length / 5,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,     1.0f, 1.0f,      // Vertex 6
+        width / 5,    -height / 5,     -length / 5,    1.0f, 0.0f, 0.0f,    0.0f, 0.0f,     // Vertex 1
+        width / 5,     height / 5,     -length / 5,    1.0f, 0.0f, 0.0f,    0.0f, 1.0f,     // Vertex 2
+        width / 5,     height / 5,      length / 5,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f,      // Vertex 6
     };
     float cubeFace4Verts[] = {
         // Back Face Triangle 1
-       -width / 5,    -height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 4
-        width / 5,    -height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 5
-        width / 5,     height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 6
+       -width / 5,    -height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   1.0f, 0.0f,     // Vertex 4
+        width / 5,    -height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   0.0f, 0.0f,     // Vertex 5
+        width / 5,     height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   0.0f, 1.0f,     // Vertex 6
 
         // Back Face Triangle 2
-       -width / 5,    -height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 4
-        width / 5,     height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 6
-       -width / 5,     height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 7
+       -width / 5,    -height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   1.0f, 0.0f,     // Vertex 4
+        width / 5,     height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   0.0f, 1.0f,     // Vertex 6
+       -width / 5,     height / 5,      length / 5,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f,     // Vertex 7
     };
     float cubeFace5Verts[] = {
         // Bottom Face Triangle 1
-       -width / 5,    -height / 5,     -length / 5,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 0
-        width / 5,    -height / 5,     -length / 5,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 1
-       -width / 5,    -height / 5,      length / 5,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 4
+       -width / 5,    -height / 5,     -length / 5,    0.0f, -1.0f, 0.0f,   0.0f, 0.0f,     // Vertex 0
+        width / 5,    -height / 5,     -length / 5,    0.0f, -1.0f, 0.0f,   1.0f, 0.0f,     // Vertex 1
+       -width / 5,    -height / 5,      length / 5,    0.0f, -1.0f, 0.0f,   0.0f, 1.0f,     // Vertex 4
 
        // Bottom Face Triangle 2
-        width / 5,    -height / 5,     -length / 5,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 1
-       -width / 5,    -height / 5,      length / 5,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 4
-        width / 5,    -height / 5,      length / 5,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 5
+        width / 5,    -height / 5,     -length / 5,    0.0f, -1.0f, 0.0f,   1.0f, 0.0f,     // Vertex 1
+       -width / 5,    -height / 5,      length / 5,    0.0f, -1.0f, 0.0f,   0.0f, 1.0f,     // Vertex 4
+        width / 5,    -height / 5,      length / 5,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f,     // Vertex 5
     };
     float cubeFace6Verts[] = {
         // Top Face Triangle 1
-        width / 5,     height / 5,     -length / 5,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 2
-       -width / 5,     height / 5,     -length / 5,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 3
-       -width / 5,     height / 5,      length / 5,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+        width / 5,     height / 5,     -length / 5,    0.0f, 1.0f, 0.0f,    1.0f, 0.0f,     // Vertex 2
+       -width / 5,     height / 5,     -length / 5,    0.0f, 1.0f, 0.0f,    0.0f, 0.0f,     // Vertex 3
+       -width / 5,     height / 5,      length / 5,    0.0f, 1.0f, 0.0f,    0.0f, 1.0f,     // Vertex 7
 
        // Top Face Triangle 2
-        width / 5,     height / 5,     -length / 5,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 2
-        width / 5,     height / 5,      length / 5,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 6
-       -width / 5,     height / 5,      length / 5,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+        width / 5,     height / 5,     -length / 5,    0.0f, 1.0f, 0.0f,    1.0f, 0.0f,     // Vertex 2
+        width / 5,     height / 5,      length / 5,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f,     // Vertex 6
+       -width / 5,     height / 5,      length / 5,    0.0f, 1.0f, 0.0f,    0.0f, 1.0f,     // Vertex 7
     };
     float tableVerts[] = { // table top
         // Front Face Triangle 1
-       -width / 0.5,    -height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 0
-        width / 0.5,    -height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 1
-        width / 0.5,     height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 2
+       -width / 0.5,    -height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    0.0f, 0.0f,     // Vertex 0
+        width / 0.5,    -height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    1.0f, 0.0f,     // Vertex 1
+        width / 0.5,     height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f,     // Vertex 2
 
         // Front Face Triangle 2
-       -width / 0.5,    -height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 0
-        width / 0.5,     height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 2
-       -width / 0.5,     height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 3
+       -width / 0.5,    -height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    0.0f, 0.0f,     // Vertex 0
+        width / 0.5,     height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f,     // Vertex 2
+       -width / 0.5,     height / 8,     -length / 1,    0.0f, 0.0f, 1.0f,    0.0f, 1.0f,     // Vertex 3
 
         // Top Face Triangle 1
-        width / 0.5,     height / 8,     -length / 1,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 2
-       -width / 0.5,     height / 8,     -length / 1,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 3
-       -width / 0.5,     height / 8,      length / 1,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+        width / 0.5,     height / 8,     -length / 1,    0.0f, 1.0f, 0.0f,    1.0f, 0.0f,     // Vertex 2
+       -width / 0.5,     height / 8,     -length / 1,    0.0f, 1.0f, 0.0f,    0.0f, 0.0f,     // Vertex 3
+       -width / 0.5,     height / 8,      length / 1,    0.0f, 1.0f, 0.0f,    0.0f, 1.0f,     // Vertex 7
 
        // Top Face Triangle 2
-        width / 0.5,     height / 8,     -length / 1,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 2
-        width / 0.5,     height / 8,      length / 1,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 6
-       -width / 0.5,     height / 8,      length / 1,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+        width / 0.5,     height / 8,     -length / 1,    0.0f, 1.0f, 0.0f,    1.0f, 0.0f,     // Vertex 2
+        width / 0.5,     height / 8,      length / 1,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f,     // Vertex 6
+       -width / 0.5,     height / 8,      length / 1,    0.0f, 1.0f, 0.0f,    0.0f, 1.0f,     // Vertex 7
 
         // Left Face Triangle 1
-       -width / 0.5,    -height / 8,     -length / 1,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 0
-       -width / 0.5,    -height / 8,      length / 1,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 4
-       -width / 0.5,     height / 8,      length / 1,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+       -width / 0.5,    -height / 8,     -length / 1,    -1.0f, 0.0f, 0.0f,   1.0f, 0.0f,     // Vertex 0
+       -width / 0.5,    -height / 8,      length / 1,    -1.0f, 0.0f, 0.0f,   0.0f, 0.0f,     // Vertex 4
+       -width / 0.5,     height / 8,      length / 1,    -1.0f, 0.0f, 0.0f,   0.0f, 1.0f,     // Vertex 7
 
        // Left Face Triangle 2
-       -width / 0.5,    -height / 8,     -length / 1,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 0
-       -width / 0.5,     height / 8,     -length / 1,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 3
-       -width / 0.5,     height / 8,      length / 1,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+       -width / 0.5,    -height / 8,     -length / 1,    -1.0f, 0.0f, 0.0f,   1.0f, 0.0f,     // Vertex 0
+       -width / 0.5,     height / 8,     -length / 1,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f,     // Vertex 3
+       -width / 0.5,     height / 8,      length / 1,    -1.0f, 0.0f, 0.0f,   0.0f, 1.0f,     // Vertex 7
 
        // Right Face Triangle 1
-        width / 0.5,    -height / 8,     -length / 1,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 1
-        width / 0.5,    -height / 8,      length / 1,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 5
-        width / 0.5,     height / 8,      length / 1,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,     1.0f, 1.0f,      // Vertex 6
+        width / 0.5,    -height / 8,     -length / 1,    1.0f, 0.0f, 0.0f,    0.0f, 0.0f,     // Vertex 1
+        width / 0.5,    -height / 8,      length / 1,    1.0f, 0.0f, 0.0f,    1.0f, 0.0f,     // Vertex 5
+        width / 0.5,     height / 8,      length / 1,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f,      // Vertex 6
 
         // Right Face Triangle 2
-        width / 0.5,    -height / 8,     -length / 1,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 1
-        width / 0.5,     height / 8,     -length / 1,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 2
-        width / 0.5,     height / 8,      length / 1,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,     1.0f, 1.0f,      // Vertex 6
+        width / 0.5,    -height / 8,     -length / 1,    1.0f, 0.0f, 0.0f,    0.0f, 0.0f,     // Vertex 1
+        width / 0.5,     height / 8,     -length / 1,    1.0f, 0.0f, 0.0f,    0.0f, 1.0f,     // Vertex 2
+        width / 0.5,     height / 8,      length / 1,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f,      // Vertex 6
 
         // Back Face Triangle 1
-       -width / 0.5,    -height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 4
-        width / 0.5,    -height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 5
-        width / 0.5,     height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 6
+       -width / 0.5,    -height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   1.0f, 0.0f,     // Vertex 4
+        width / 0.5,    -height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   0.0f, 0.0f,     // Vertex 5
+        width / 0.5,     height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   0.0f, 1.0f,     // Vertex 6
 
         // Back Face Triangle 2
-       -width / 0.5,    -height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 4
-        width / 0.5,     height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 6
-       -width / 0.5,     height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 7
+       -width / 0.5,    -height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   1.0f, 0.0f,     // Vertex 4
+        width / 0.5,     height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   0.0f, 1.0f,     // Vertex 6
+       -width / 0.5,     height / 8,      length / 1,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f,     // Vertex 7
 
        // Bottom Face Triangle 1
-       -width / 0.5,    -height / 8,     -length / 1,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 0
-        width / 0.5,    -height / 8,     -length / 1,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 1
-       -width / 0.5,    -height / 8,      length / 1,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 4
+       -width / 0.5,    -height / 8,     -length / 1,    0.0f, -1.0f, 0.0f,   0.0f, 0.0f,     // Vertex 0
+        width / 0.5,    -height / 8,     -length / 1,    0.0f, -1.0f, 0.0f,   1.0f, 0.0f,     // Vertex 1
+       -width / 0.5,    -height / 8,      length / 1,    0.0f, -1.0f, 0.0f,   0.0f, 1.0f,     // Vertex 4
 
        // Bottom Face Triangle 2
-        width / 0.5,    -height / 8,     -length / 1,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 1
-       -width / 0.5,    -height / 8,      length / 1,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 4
-        width / 0.5,    -height / 8,      length / 1,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 5
+        width / 0.5,    -height / 8,     -length / 1,    0.0f, -1.0f, 0.0f,   1.0f, 0.0f,     // Vertex 1
+       -width / 0.5,    -height / 8,      length / 1,    0.0f, -1.0f, 0.0f,   0.0f, 1.0f,     // Vertex 4
+        width / 0.5,    -height / 8,      length / 1,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f,     // Vertex 5
     };
     float tableLegVerts[] = { // table legs
         // Front Face Triangle 1
-       -width / 10,    -height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 0
-        width / 10,    -height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 1
-        width / 10,     height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 2
+       -width / 10,    -height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    0.0f, 0.0f,     // Vertex 0
+        width / 10,    -height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    1.0f, 0.0f,     // Vertex 1
+        width / 10,     height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f,     // Vertex 2
 
         // Front Face Triangle 2
-       -width / 10,    -height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 0
-        width / 10,     height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 2
-       -width / 10,     height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 3
+       -width / 10,    -height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    0.0f, 0.0f,     // Vertex 0
+        width / 10,     height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    1.0f, 1.0f,     // Vertex 2
+       -width / 10,     height / 2,     -length / 10,    0.0f, 0.0f, 1.0f,    0.0f, 1.0f,     // Vertex 3
 
         // Top Face Triangle 1
-        width / 10,     height / 2,     -length / 10,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 2
-       -width / 10,     height / 2,     -length / 10,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 3
-       -width / 10,     height / 2,      length / 10,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+        width / 10,     height / 2,     -length / 10,    0.0f, 1.0f, 0.0f,    1.0f, 0.0f,     // Vertex 2
+       -width / 10,     height / 2,     -length / 10,    0.0f, 1.0f, 0.0f,    0.0f, 0.0f,     // Vertex 3
+       -width / 10,     height / 2,      length / 10,    0.0f, 1.0f, 0.0f,    0.0f, 1.0f,     // Vertex 7
 
         // Top Face Triangle 2
-        width / 10,     height / 2,     -length / 10,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 2
-        width / 10,     height / 2,      length / 10,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 6
-       -width / 10,     height / 2,      length / 10,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+        width / 10,     height / 2,     -length / 10,    0.0f, 1.0f, 0.0f,    1.0f, 0.0f,     // Vertex 2
+        width / 10,     height / 2,      length / 10,    0.0f, 1.0f, 0.0f,    1.0f, 1.0f,     // Vertex 6
+       -width / 10,     height / 2,      length / 10,    0.0f, 1.0f, 0.0f,    0.0f, 1.0f,     // Vertex 7
 
         // Left Face Triangle 1
-       -width / 10,    -height / 2,     -length / 10,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 0
-       -width / 10,    -height / 2,      length / 10,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 4
-       -width / 10,     height / 2,      length / 10,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+       -width / 10,    -height / 2,     -length / 10,    -1.0f, 0.0f, 0.0f,   1.0f, 0.0f,     // Vertex 0
+       -width / 10,    -height / 2,      length / 10,    -1.0f, 0.0f, 0.0f,   0.0f, 0.0f,     // Vertex 4
+       -width / 10,     height / 2,      length / 10,    -1.0f, 0.0f, 0.0f,   0.0f, 1.0f,     // Vertex 7
 
         // Left Face Triangle 2
-       -width / 10,    -height / 2,     -length / 10,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 0
-       -width / 10,     height / 2,     -length / 10,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 3
-       -width / 10,     height / 2,      length / 10,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 7
+       -width / 10,    -height / 2,     -length / 10,    -1.0f, 0.0f, 0.0f,   1.0f, 0.0f,     // Vertex 0
+       -width / 10,     height / 2,     -length / 10,    -1.0f, 0.0f, 0.0f,   1.0f, 1.0f,     // Vertex 3
+       -width / 10,     height / 2,      length / 10,    -1.0f, 0.0f, 0.0f,   0.0f, 1.0f,     // Vertex 7
 
         // Right Face Triangle 1
-        width / 10,    -height / 2,     -length / 10,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 1
-        width / 10,    -height / 2,      length / 10,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 5
-        width / 10,     height / 2,      length / 10,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,     1.0f, 1.0f,      // Vertex 6
+        width / 10,    -height / 2,     -length / 10,    1.0f, 0.0f, 0.0f,    0.0f, 0.0f,     // Vertex 1
+        width / 10,    -height / 2,      length / 10,    1.0f, 0.0f, 0.0f,    1.0f, 0.0f,     // Vertex 5
+        width / 10,     height / 2,      length / 10,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f,      // Vertex 6
 
         // Right Face Triangle 2
-        width / 10,    -height / 2,     -length / 10,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 1
-        width / 10,     height / 2,     -length / 10,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 2
-        width / 10,     height / 2,      length / 10,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f, 1.0f, 1.0f,     1.0f, 1.0f,      // Vertex 6
+        width / 10,    -height / 2,     -length / 10,    1.0f, 0.0f, 0.0f,    0.0f, 0.0f,     // Vertex 1
+        width / 10,     height / 2,     -length / 10,    1.0f, 0.0f, 0.0f,    0.0f, 1.0f,     // Vertex 2
+        width / 10,     height / 2,      length / 10,    1.0f, 0.0f, 0.0f,    1.0f, 1.0f,      // Vertex 6
 
         // Back Face Triangle 1
-       -width / 10,    -height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 4
-        width / 10,    -height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 5
-        width / 10,     height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 6
+       -width / 10,    -height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   1.0f, 0.0f,     // Vertex 4
+        width / 10,    -height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   0.0f, 0.0f,     // Vertex 5
+        width / 10,     height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   0.0f, 1.0f,     // Vertex 6
         
         // Back Face Triangle 2
-       -width / 10,    -height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 4
-        width / 10,     height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 6
-       -width / 10,     height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 7
+       -width / 10,    -height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   1.0f, 0.0f,     // Vertex 4
+        width / 10,     height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   0.0f, 1.0f,     // Vertex 6
+       -width / 10,     height / 2,      length / 10,    0.0f, 0.0f, -1.0f,   1.0f, 1.0f,     // Vertex 7
 
          // Bottom Face Triangle 1
-       -width / 10,    -height / 2,     -length / 10,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 0.0f,     // Vertex 0
-        width / 10,    -height / 2,     -length / 10,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 1
-       -width / 10,    -height / 2,      length / 10,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 4
+       -width / 10,    -height / 2,     -length / 10,    0.0f, -1.0f, 0.0f,   0.0f, 0.0f,     // Vertex 0
+        width / 10,    -height / 2,     -length / 10,    0.0f, -1.0f, 0.0f,   1.0f, 0.0f,     // Vertex 1
+       -width / 10,    -height / 2,      length / 10,    0.0f, -1.0f, 0.0f,   0.0f, 1.0f,     // Vertex 4
 
          // Bottom Face Triangle 2
-        width / 10,    -height / 2,     -length / 10,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 0.0f,     // Vertex 1
-       -width / 10,    -height / 2,      length / 10,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      0.0f, 1.0f,     // Vertex 4
-        width / 10,    -height / 2,      length / 10,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f, 1.0f, 1.0f,      1.0f, 1.0f,     // Vertex 5
+        width / 10,    -height / 2,     -length / 10,    0.0f, -1.0f, 0.0f,   1.0f, 0.0f,     // Vertex 1
+       -width / 10,    -height / 2,      length / 10,    0.0f, -1.0f, 0.0f,   0.0f, 1.0f,     // Vertex 4
+        width / 10,    -height / 2,      length / 10,    0.0f, -1.0f, 0.0f,   1.0f, 1.0f,     // Vertex 5
     };
 
-    // Lines 1291-1307 were kept for consistency despite not being needed, initialize buffers changed to 12.
-
     // Generate the planes vertices
-    std::vector<float>planeVerts1 = genPlaneVerts(10, noColor);
-
-    catColor.redValue = 0.62f;
-    catColor.greenValue = 0.929f;
-    catColor.blueValue = 0.243f;
-    catColor.alphaValue = 1.0f;
+    std::vector<float>planeVerts1 = genPlaneVerts(10);
 
     // Shapes for the cat
     // Generates the first sphere's vertices and indices
-    std::vector<float> sphereVertices1 = genSphereVerts(0.5625, catColor);
-    std::vector<unsigned int> sphereIndices1 = genSphereIndices();
+    std::vector<float> sphereVertices1 = genSphereVerts(0.5625, rings, segments);
+    std::vector<unsigned int> sphereIndices1 = genSphereIndices(rings, segments);
 
     // Generates the third cylinder's vertices and indices
-    std::vector<float> cylVertices3 = genCylSideVerts(sides, 1.4375f, 0.5625f, catColor);
+    std::vector<float> cylVertices3 = genCylSideVerts(sides, 1.4375f, 0.5625f);
 
     // Generate the pyramid/cone vertices and indices
-    std::vector<float> coneVerts1 = genPyramidVerts(coneSides, 0.5f, 0.25f, catColor);
+    std::vector<float> coneVerts1 = genPyramidVerts(coneSides, 0.5f, 0.25f);
 
-    // Initialize buffers
-    glGenVertexArrays(12, mesh.VAOs);
-    glGenBuffers(12, mesh.VBOs);
-    glGenBuffers(12, mesh.EBOs);
+    // The meshes drawn below in the compact layout they are uploaded in (see vertex_format.h)
+    PackedMesh tablePacked = packVertices(tableVerts);
+    PackedMesh tableLegPacked = packVertices(tableLegVerts);
+    PackedMesh planePacked1 = packVertices(planeVerts1.data(), planeVerts1.size() / VERTEX_FLOATS, VERTEX_FLOATS);
+    // the plane has always had its texture coordinates on location 6, which shader.vs does not
+    // read, so it samples the floor texture at (0, 0); it keeps that look without them
+    for (PackedVertex& vertex : planePacked1.vertices)
+        vertex.texCoord[0] = vertex.texCoord[1] = 0;
 
     /*
     * The below commented chunk was like this when obtained. Leaving it in just in case.
@@ -1469,400 +1272,56 @@ void createMesh(GLMesh &mesh) {
     glEnableVertexAttribArray(3);
     */
 
-    // First Cube (First Object)
-    // Face 1
+    // Whole Rubik's cube (drawn in one call)
+    // The six faces above in one buffer, each vertex followed by the texture array layer of its
+    // face; layer n is rubiks[n] in textures.txt
+    const float* cubeFaceVerts[6] = { cubeFace1Verts, cubeFace2Verts, cubeFace3Verts, cubeFace4Verts, cubeFace5Verts, cubeFace6Verts };
+    const float cubeFaceLayers[6] = { 0.0f, 1.0f, 3.0f, 2.0f, 5.0f, 4.0f };
+    std::vector<float> cubeVerts;
+    for (int face = 0; face < 6; ++face)
+    {
+        for (int vertex = 0; vertex < 6; ++vertex)
+        {
+            cubeVerts.insert(cubeVerts.end(), cubeFaceVerts[face] + vertex * VERTEX_FLOATS, cubeFaceVerts[face] + (vertex + 1) * VERTEX_FLOATS);
+            cubeVerts.push_back(cubeFaceLayers[face]);
+        }
+    }
+    PackedMesh cubePacked = packVertices(cubeVerts.data(), cubeVerts.size() / (VERTEX_FLOATS + 1), VERTEX_FLOATS + 1);
+
+    // Every mesh is welded into an indexed, vertex-cache-ordered mesh (see mesh_optimizer.h), then
+    // suballocated from the one geometry arena and drawn from its vertex array. The four table legs
+    // differ only in placement, so they share one copy of the leg.
+    // What the optimizer did goes to stderr (stdout is kept free for the benchmark report).
+    struct { const char* name; PackedMesh* packed; MeshRange* range; } meshes[] = {
+        { "cube", &cubePacked, &mesh.cube },
+        { "table", &tablePacked, &mesh.table },
+        { "table leg", &tableLegPacked, &mesh.tableLeg },
+        { "plane", &planePacked1, &mesh.plane },
+    };
+    std::clog << "Meshes (ACMR on a " << VERTEX_CACHE_SIZE << "-entry FIFO vertex cache):" << std::endl;
+    for (auto& entry : meshes)
+    {
+        MeshOptimizerStats stats;
+        std::vector<ArenaIndex> indices = optimizeMesh(*entry.packed, &stats);
+        stats.writeReport(std::clog, entry.name);
+        *entry.range = mesh.arena.add(*entry.packed, indices);
+    }
+    mesh.arena.upload();
+
+    /*
+    * This code creates objects we will not use so it gets commented out.
+    * 
+    // Spheres (Fifth Object)
     // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[0]);
+    glBindVertexArray(mesh.VAOs[8]);
 
-    // VBO of the cube
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace1Verts), cubeFace1Verts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    // For the lights
-    glGenVertexArrays(1, &mesh.lightCubeVAO);
-    glBindVertexArray(mesh.lightCubeVAO);
-    glGenBuffers(1, &mesh.lightCubeVBO);
-
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace1Verts), cubeFace1Verts, GL_STATIC_DRAW);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Face 2
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[1]);
-
-    // VBO of the cube
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[1]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace2Verts), cubeFace2Verts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    // For the lights
-    glGenVertexArrays(1, &mesh.lightCubeVAO);
-    glBindVertexArray(mesh.lightCubeVAO);
-    glGenBuffers(1, &mesh.lightCubeVBO);
-
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace2Verts), cubeFace2Verts, GL_STATIC_DRAW);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Face 3
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[2]);
-
-    // VBO of the cube
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[2]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace3Verts), cubeFace3Verts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    // For the lights
-    glGenVertexArrays(1, &mesh.lightCubeVAO);
-    glBindVertexArray(mesh.lightCubeVAO);
-    glGenBuffers(1, &mesh.lightCubeVBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace3Verts), cubeFace3Verts, GL_STATIC_DRAW);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Face 4
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[3]);
-
-    // VBO of the cube
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[3]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace4Verts), cubeFace4Verts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    // For the lights
-    glGenVertexArrays(1, &mesh.lightCubeVAO);
-    glBindVertexArray(mesh.lightCubeVAO);
-    glGenBuffers(1, &mesh.lightCubeVBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace4Verts), cubeFace4Verts, GL_STATIC_DRAW);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-
-    // Face 5
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[4]);
-
-    // VBO of the cube
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[4]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace5Verts), cubeFace5Verts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    // For the lights
-    glGenVertexArrays(1, &mesh.lightCubeVAO);
-    glBindVertexArray(mesh.lightCubeVAO);
-    glGenBuffers(1, &mesh.lightCubeVBO);
-
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace5Verts), cubeFace5Verts, GL_STATIC_DRAW);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Face 6
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[5]);
-
-    // VBO of the cube
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[5]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace6Verts), cubeFace6Verts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    // For the lights
-    glGenVertexArrays(1, &mesh.lightCubeVAO);
-    glBindVertexArray(mesh.lightCubeVAO);
-    glGenBuffers(1, &mesh.lightCubeVBO);
-
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeFace6Verts), cubeFace6Verts, GL_STATIC_DRAW);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Table top
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[6]);
-
-    // VBO of the cube
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[6]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(tableVerts), tableVerts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    // For the lights
-    glGenVertexArrays(1, &mesh.lightCubeVAO);
-    glBindVertexArray(mesh.lightCubeVAO);
-    glGenBuffers(1, &mesh.lightCubeVBO);
-
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(tableVerts), tableVerts, GL_STATIC_DRAW);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Table leg 1
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[8]);
-
-    // VBO of the cube
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[8]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(tableLegVerts), tableLegVerts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    // For the lights
-    glGenVertexArrays(1, &mesh.lightCubeVAO);
-    glBindVertexArray(mesh.lightCubeVAO);
-    glGenBuffers(1, &mesh.lightCubeVBO);
-
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(tableLegVerts), tableLegVerts, GL_STATIC_DRAW);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Table leg 2
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[9]);
-
-    // VBO of the cube
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[9]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(tableLegVerts), tableLegVerts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    // For the lights
-    glGenVertexArrays(1, &mesh.lightCubeVAO);
-    glBindVertexArray(mesh.lightCubeVAO);
-    glGenBuffers(1, &mesh.lightCubeVBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(tableLegVerts), tableLegVerts, GL_STATIC_DRAW);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Table leg 3
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[10]);
-
-    // VBO of the cube
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[10]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(tableLegVerts), tableLegVerts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    // For the lights
-    glGenVertexArrays(1, &mesh.lightCubeVAO);
-    glBindVertexArray(mesh.lightCubeVAO);
-    glGenBuffers(1, &mesh.lightCubeVBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(tableLegVerts), tableLegVerts, GL_STATIC_DRAW);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Table leg 4
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[11]);
-
-    // VBO of the cube
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[11]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(tableLegVerts), tableLegVerts, GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    // For the lights
-    glGenVertexArrays(1, &mesh.lightCubeVAO);
-    glBindVertexArray(mesh.lightCubeVAO);
-    glGenBuffers(1, &mesh.lightCubeVBO);
-
-
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(tableLegVerts), tableLegVerts, GL_STATIC_DRAW);
-    // note that we update the lamp's position attribute's stride to reflect the updated buffer data
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Plane (Fourth Object)
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[7]);
-
-    // VBO of the plane
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[7]);
-    glBufferData(GL_ARRAY_BUFFER, planeVerts1.size() * sizeof(float), planeVerts1.data(), GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // normals attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // color attribute
-    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-    // texture attibute
-    glVertexAttribPointer(6, 2, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)(10 * sizeof(float)));
-    glEnableVertexAttribArray(6);
-
-    /*
-    * This code creates objects we will not use so it gets commented out.
-    * 
-    // Spheres (Fifth Object)
-    // bind the Vertex Array Object
-    glBindVertexArray(mesh.VAOs[8]);
-
-    // VBO of the sphere
-    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[8]);
-    glBufferData(GL_ARRAY_BUFFER, sphereVertices1.size() * sizeof(float), sphereVertices1.data(), GL_STATIC_DRAW);
-
-    // EBO of sphere
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBOs[8]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphereIndices1.size() * sizeof(unsigned int), sphereIndices1.data(), GL_STATIC_DRAW);
+    // VBO of the sphere
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBOs[8]);
+    glBufferData(GL_ARRAY_BUFFER, sphereVertices1.size() * sizeof(float), sphereVertices1.data(), GL_STATIC_DRAW);
+
+    // EBO of sphere
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBOs[8]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphereIndices1.size() * sizeof(unsigned int), sphereIndices1.data(), GL_STATIC_DRAW);
 
     // position attribute
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 12 * sizeof(float), (void*)0);
@@ -1928,508 +1387,17 @@ void createMesh(GLMesh &mesh) {
     //mesh.indexCounts[4] = cylTopIndices2.size();
     //mesh.indexCounts[5] = cylBottomIndices2.size();*/
 
-    mesh.indexCounts[7] = planeVerts1.size(); //This line must remain to draw the plan under our table
+    // bounding spheres for frustum tests
+    mesh.cube.bounds = boundingSphere(cubeVerts.data(), cubeVerts.size() / (VERTEX_FLOATS + 1), VERTEX_FLOATS + 1);
+    mesh.table.bounds = boundingSphere(tableVerts, sizeof(tableVerts) / sizeof(float) / VERTEX_FLOATS, VERTEX_FLOATS);
+    mesh.plane.bounds = boundingSphere(planeVerts1.data(), planeVerts1.size() / VERTEX_FLOATS, VERTEX_FLOATS);
+    mesh.tableLeg.bounds = boundingSphere(tableLegVerts, sizeof(tableLegVerts) / sizeof(float) / VERTEX_FLOATS, VERTEX_FLOATS);
 
     //mesh.indexCounts[8] = sphereIndices1.size();
     //mesh.indexCounts[9] = cylVertices3.size();
     //mesh.indexCounts[10] = coneVerts1.size();
 }
 
-/*
- * Unused function, but it remains because it isn't breaking anything.
- */
-
-// Function to generate the side veritces of a cylinder
-std::vector<float> genCylSideVerts(int sides, float height, float radius, color color) {
-
-    std::vector<float> vertices;
-
-    float angleStep = 2.0f * PI / sides;
-
-    float halfHeight = height / 2.0f;
-    
-
-    // Bottom circle vertices
-    for (int i = 0; i <= sides; ++i) {
-        float angle = i * angleStep;
-        float x = radius * cos(angle);
-        float z = radius * sin(angle);
-
-        // Bottom Vertex
-        // Position
-        vertices.push_back(x);
-        vertices.push_back(-halfHeight); // y (bottom)
-        vertices.push_back(z);
-
-        // Normal
-        vertices.push_back(x);
-        vertices.push_back(0.0f);
-        vertices.push_back(z);
-
-        // Color 
-        vertices.push_back(color.redValue);     // r
-        vertices.push_back(color.greenValue);   // g
-        vertices.push_back(color.blueValue);    // b
-        vertices.push_back(color.alphaValue);   // a
-
-        vertices.push_back(static_cast<float>(i) / static_cast<float>(sides));    // u
-        vertices.push_back(0.0f);   // v
-
-        // Top Vertex
-        // Position
-        vertices.push_back(x);
-        vertices.push_back(halfHeight); // y (top)
-        vertices.push_back(z);
-
-        // Normal
-        vertices.push_back(x);
-        vertices.push_back(0.0f);
-        vertices.push_back(z);
-
-        // Color 
-        vertices.push_back(color.redValue);     // r
-        vertices.push_back(color.greenValue);   // g
-        vertices.push_back(color.blueValue);    // b
-        vertices.push_back(color.alphaValue);   // a
-        
-
-        vertices.push_back(static_cast<float>(i) / static_cast<float>(sides));    // u
-        vertices.push_back(1.0f);   // v
-    }
-
-    return vertices;
-}
-
-/*
- * Unused function, but it remains because it isn't breaking anything.
- */
-
-// Function to generate the top veritces of a cylinder
-std::vector<float> genCylTopVerts(int sides, float height, float radius, color color) {
-
-    std::vector<float> vertices;
-
-    float angleStep = 2.0f * PI / sides;
-
-    float halfHeight = height / 2.0f;
-
-    // Top circle vertices
-    for (int i = 0; i < sides; ++i) {
-        float angle = i * angleStep;
-        float x = radius * cos(angle);
-        float z = radius * sin(angle);
-
-        // Position
-        vertices.push_back(x);
-        vertices.push_back(halfHeight); // y (top)
-        vertices.push_back(z);
-
-        // Normal
-        vertices.push_back(0.0f);
-        vertices.push_back(1.0f);
-        vertices.push_back(0.0f);
-
-        // Color 
-        vertices.push_back(color.redValue);     // r
-        vertices.push_back(color.greenValue);   // g
-        vertices.push_back(color.blueValue);    // b
-        vertices.push_back(color.alphaValue);   // a
-
-
-        // Texture coordinates for the top circle
-        vertices.push_back(0.5f + 0.5f * cos(angle));  // u
-        vertices.push_back(0.5f + 0.5f * sin(angle));  // v
-    }
-    
-    // For triangle fan
-    float y =  halfHeight; 
-
-    // Position
-    vertices.push_back(0.0f);  // x
-    vertices.push_back(y);     // y
-    vertices.push_back(0.0f);  // z
-
-    // Normal
-    vertices.push_back(0.0f);
-    vertices.push_back(1.0f);
-    vertices.push_back(0.0f);
-
-    // Color 
-    vertices.push_back(color.redValue);     // r
-    vertices.push_back(color.greenValue);   // g
-    vertices.push_back(color.blueValue);    // b
-    vertices.push_back(color.alphaValue);   // a
-         
-
-    // Texture coordinates for the center points
-    vertices.push_back(0.5f);  // u (center point)
-    vertices.push_back(0.5f);  // v (center point)
-        
-    return vertices;
-}
-
-/*
- * Unused function, but it remains because it isn't breaking anything.
- */
-
-// Function to generate the bottom veritces of a cylinder
-std::vector<float> genCylBottomVerts(int sides, float height, float radius, color color) {
-
-    std::vector<float> vertices;
-
-    float angleStep = 2.0f * PI / sides;
-
-    float halfHeight = height / 2.0f;
-
-    // Bottom circle vertices
-    for (int i = 0; i < sides ; ++i) {
-        float angle = i * angleStep;
-        float x = radius * cos(angle);
-        float z = radius * sin(angle);
-
-        // Position
-        vertices.push_back(x);
-        vertices.push_back(-halfHeight); // y (bottom)
-        vertices.push_back(z);
-
-        // Normal
-        vertices.push_back(0.0f);
-        vertices.push_back(-1.0f);
-        vertices.push_back(0.0f);
-
-        // Color 
-        vertices.push_back(color.redValue);     // r
-        vertices.push_back(color.greenValue);   // g
-        vertices.push_back(color.blueValue);    // b
-        vertices.push_back(color.alphaValue);   // a
-        
-
-        // Texture coordinates for the bottom circle
-        vertices.push_back(0.5f + 0.5f * cos(angle));  // u
-        vertices.push_back(0.5f + 0.5f * sin(angle));  // v
-    }
-
-    // For triangle fan
-    float y = -halfHeight;
-
-    // Position
-    vertices.push_back(0.0f);  // x
-    vertices.push_back(y);     // y
-    vertices.push_back(0.0f);  // z
-
-    // Normal
-    vertices.push_back(0.0f);
-    vertices.push_back(-1.0f);
-    vertices.push_back(0.0f);
-
-    // Color 
-    vertices.push_back(color.redValue);     // r
-    vertices.push_back(color.greenValue);   // g
-    vertices.push_back(color.blueValue);    // b
-    vertices.push_back(color.alphaValue);   // a
-
-
-    // Texture coordinates for the center points
-    vertices.push_back(0.5f);  // u (center point)
-    vertices.push_back(0.5f);  // v (center point)
-
-    return vertices;
-}
-
-/*
- * Unused function, but it remains because it isn't breaking anything.
- */
-
-// Function to generate a cylinder's bottom indices
-std::vector<unsigned int> genCylBottomIndices(int sides) {
-    std::vector<unsigned int> indices;
-
-    for (int i = 0; i < sides; ++i) {
-        int currentVertex = i;
-        int nextVertex = (i + 1) % sides;
-
-        // Triangle fan indices
-        indices.push_back(currentVertex);
-        indices.push_back(nextVertex);
-        indices.push_back(sides);
-    }
-
-    return indices;
-}
-
-/*
- * Unused function, but it remains because it isn't breaking anything.
- */
-
-// Function to generate a cylinder's top indices
-std::vector<unsigned int> genCylTopIndices(int sides) {
-    std::vector<unsigned int> indices;
-
-    for (int i = 0; i < sides; ++i) {
-        int currentVertex = i;
-        int nextVertex = (i + 1) % sides;
-
-        // Triangle fan indices
-        indices.push_back(currentVertex);
-        indices.push_back(nextVertex);
-        indices.push_back(sides); // Center point
-    }
-
-    return indices;
-}
-
-/*
- * Unused function, but it remains because it isn't breaking anything.
- */
-
-// Function for generating a sphere's vertices
-std::vector<float> genSphereVerts(float radius, color color) {
-    std::vector<float> vertices;
-    float phi, theta;
-
-    // Generate vertices and colors for the sphere
-    for (int i = 0; i <= rings; ++i) {
-        phi = static_cast<float>((-PI / 2.0f) + PI *  i / rings); // Vertical angle
-
-        for (int j = 0; j <= segments; ++j) {
-            theta = static_cast<float>(2 * PI) * j / segments; // Horizontal angle
-
-            // Calculate the vertex position
-            float x = radius * std::cos(phi) * std::cos(theta);
-            float y = radius * std::sin(phi);
-            float z = radius * std::cos(phi) * std::sin(theta);
-
-            // Add the vertex position to the vector
-            vertices.push_back(x);
-            vertices.push_back(y);
-            vertices.push_back(z);
-
-            // Normals
-            vertices.push_back(x / radius);
-            vertices.push_back(y / radius);
-            vertices.push_back(z / radius);
-
-            // Color 
-            vertices.push_back(color.redValue);     // r
-            vertices.push_back(color.greenValue);   // g
-            vertices.push_back(color.blueValue);    // b
-            vertices.push_back(color.alphaValue);   // a
-
-            // Calculate and push texture coordinates
-            float u = static_cast<float>(j) / segments; // U texture coordinate
-            float v = static_cast<float>(i) / rings;    // V texture coordinate
-            vertices.push_back(u);
-            vertices.push_back(v);
-        }
-    }
-
-    return vertices;
-}
-
-/*
- * Unused function, but it remains because it isn't breaking anything.
- */
-
-// Function for generating a sphere's indices
-std::vector<unsigned int> genSphereIndices()
-{
-    std::vector<unsigned int> indices;
-
-    // Generate indices for rendering triangles
-    for (int i = 0; i < rings; ++i) {
-        for (int j = 0; j < segments; ++j) {
-            int current = i * (segments + 1) + j;
-            int next = current + segments + 1;
-
-            // Define two triangles using indices
-            indices.push_back(current);
-            indices.push_back(current + 1);
-            indices.push_back(next);
-
-            indices.push_back(current + 1);
-            indices.push_back(next + 1);
-            indices.push_back(next);
-        }
-    }
-
-    return indices;
-}
-
-/*
- * Unused function, but it remains because it isn't breaking anything.
- */
-
-// Function to generate a pyramid's vertices
-std::vector<float> genPyramidVerts(int sides, float height, float radius, color color)
-{
-    std::vector<float> vertices;
-    vertices.reserve((sides + 1) * 9); // Each vertex has 9 components now (including alpha)
-
-    float angleIncrement = 2 * PI / static_cast<float>(sides);
-
-    float r = color.redValue;
-    float g = color.greenValue;
-    float b = color.blueValue;
-    float a = color.alphaValue;
-
-    // Vertex at the top of the pyramid/cone
-    float topVertex[] = { 0.0f, height / 2.0f, 0.0f, r, g, b, a, 0.5f, 1.0f }; // Center of the texture
-
-    for (int i = 0; i < sides; ++i) {
-        // Calculate the coordinates for the base of the pyramid/cone
-        float x1 = radius * cos(i * angleIncrement);
-        float z1 = radius * sin(i * angleIncrement);
-        float x2 = radius * cos((i + 1) * angleIncrement);
-        float z2 = radius * sin((i + 1) * angleIncrement);
-
-        // Calculate normals for the side vertices using the parametric approach
-        float tangent1[3] = { x2 - x1, -height, z2 - z1 };
-        float tangent2[3] = { x1, height, z1 };
-        float normal[3] = {
-            tangent1[1] * tangent2[2] - tangent1[2] * tangent2[1],
-            tangent1[2] * tangent2[0] - tangent1[0] * tangent2[2],
-            tangent1[0] * tangent2[1] - tangent1[1] * tangent2[0]
-        };
-
-        // Normalize the normal vector
-        float normalLength = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
-        normal[0] /= normalLength;
-        normal[1] /= normalLength;
-        normal[2] /= normalLength;
-
-        // Calculate the texture coordinates for the sides
-        float u1 = static_cast<float>(i) / static_cast<float>(sides - 1); // Range [0, 1]
-        float u2 = static_cast<float>(i + 1) / static_cast<float>(sides - 1);
-
-        // Add vertices for the base triangle with texture coordinates
-        vertices.insert(vertices.end(), {
-            x1, -height / 2.0f, z1,
-            normal[0], normal[1], normal[2],
-            r, g, b, a,
-            u1, 0.0f,
-
-            x2, -height / 2.0f, z2,
-            normal[0], normal[1], normal[2],
-            r, g, b, a,
-            u2, 0.0f,
-
-            0.0f, -height / 2.0f, 0.0f,
-            0.0f, 0.0f, 0.0f,
-            r, g, b, a,
-            0.5f, 0.5f
-            });
-
-        // Add vertices for the side triangle with texture coordinates
-        vertices.insert(vertices.end(), {
-            x1, -height / 2.0f, z1,
-            normal[0], normal[1], normal[2],
-            r, g, b, a,
-            u1, 0.0f,
-
-            x2, -height / 2.0f, z2,
-            normal[0], normal[1], normal[2],
-            r, g, b, a,
-            u2, 0.0f,
-
-            0.0f, height / 2.0f, 0.0f,
-            0.0f, 0.0f, 0.0f,
-            r, g, b, a,
-            0.5f, 1.0f
-            });
-    }
-
-    // Add vertices for the base
-    for (int i = 0; i < sides; ++i) {
-        float x1 = radius * cos(i * angleIncrement);
-        float z1 = radius * sin(i * angleIncrement);
-        float x2 = radius * cos((i + 1) * angleIncrement);
-        float z2 = radius * sin((i + 1) * angleIncrement);
-
-        // Calculate normals for the base vertices
-        float baseNormal[] = { 0.0f, -1.0f, 0.0f };
-
-
-        // Calculate the texture coordinates for the base
-        float u1 = 0.5f + 0.5f * cos(i * angleIncrement);
-        float u2 = 0.5f + 0.5f * cos((i + 1) * angleIncrement);
-
-        // Add vertices for the base triangle with texture coordinates
-        vertices.insert(vertices.end(), {
-            x1, -height / 2.0f, z1,
-            baseNormal[0], baseNormal[1], baseNormal[2],
-            r, g, b, a,
-            u1, 0.0f,
-
-            x2, -height / 2.0f, z2,
-            baseNormal[0], baseNormal[1], baseNormal[2],
-            r, g, b, a,
-            u2, 0.0f,
-
-            0.0f, -height / 2.0f, 0.0f,
-            baseNormal[0], baseNormal[1], baseNormal[2],
-            r, g, b, a,
-            0.5f, 0.5f
-            });
-    }
-
-    return vertices;
-}
-
-// Function to generate a plane's vertices
-std::vector<float> genPlaneVerts(int sections, color color) {
-
-    std::vector<float> vertices;
-
-    float r = color.redValue;
-    float g = color.greenValue;
-    float b = color.blueValue;
-    float a = color.alphaValue;
-
-    float step = 2.0f / sections;
-
-    for (float x = 1.0f; x > -1.0f; x -= step) {
-        for (float z = 1.0f; z >= -1.0f; z -= step) {
-            // Triangle 1
-            vertices.insert(vertices.end(), {
-            x, 0.0f, z,
-            0.0f, 1.0f, 0.0f,
-            r, g, b, a,
-            2.0f, 0.0f,
-
-            x - step, 0.0f, z,
-            0.0f, 1.0f, 0.0f,
-            r, g, b, a,
-            0.0f, 0.0f,
-
-            x, 0.0f, z - step,
-            0.0f, 1.0f, 0.0f,
-            r, g, b, a,
-            2.0f, 2.0f,
-            });
-            // Triangle 2
-            vertices.insert(vertices.end(), {
-            x - step, 0.0f, z - step,
-            0.0f, 1.0f, 0.0f,
-            r, g, b, a,
-            0.0f, 2.0f,
-
-            x - step, 0.0f, z,
-            0.0f, 1.0f, 0.0f,
-            r, g, b, a,
-            0.0f, 0.0f,
-
-            x, 0.0f, z - step,
-            0.0f, 1.0f, 0.0f,
-            r, g, b, a,
-            2.0f, 2.0f,
-            });
-
-        }
-    }
-
-    return vertices;
-}
-
 bool progInitialize(GLFWwindow** window) {
     // glfw: initialize and configure
     // ------------------------------
@@ -0,0 +1,15 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+// Counts heap allocations made through operator new so the benchmark can check that the render
+// loop stays allocation free. The counter is per thread: background loader threads do not show up
+// in the render thread's numbers.
+//
+// The replacement operator new/delete live in alloc_counter.cpp, which must be linked into the
+// program. They sit in a translation unit of their own so the compiler never inlines a malloc
+// behind new and a free behind delete into the same caller.
+
+// number of operator new calls made by the calling thread so far
+unsigned long long allocationCount();
+
+#endif
@@ -0,0 +1,261 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <camera.h>
+#include <alloc_counter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Command line options for the fixed-frame benchmark runner
+struct BenchmarkOptions
+{
+    bool headless = false;      // --headless: render offscreen and exit after a fixed number of frames
+    int frames = 300;           // --frames N: measured frames
+    int warmupFrames = 30;      // --warmup N: frames rendered before measuring starts
+    std::string reportPath;     // --report FILE: where the JSON report goes (stdout when empty)
+    std::string capturePath;    // --capture FILE: write the last rendered frame as a PPM image
+    long long maxFrameAllocations = 0; // --max-frame-allocations N: heap allocations a measured frame may make
+    long long textureBudgetMiB = -1; // --texture-budget N: MiB of GPU memory for textures (0 = no limit, scene default if negative)
+    int textureMaxSize = 0;     // --texture-max-size N: largest width or height textures load at (0 = as stored)
+    bool benchmarkMeshes = false; // --benchmark-meshes: time the mesh generators instead of rendering, then exit
+
+    // returns false (after printing usage) on an unknown or malformed argument
+    bool parse(int argc, char** argv)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            bool hasValue = i + 1 < argc;
+            if (std::strcmp(argv[i], "--headless") == 0)
+                headless = true;
+            else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+                frames = std::max(1, std::atoi(argv[++i]));
+            else if (std::strcmp(argv[i], "--warmup") == 0 && hasValue)
+                warmupFrames = std::max(0, std::atoi(argv[++i]));
+            else if (std::strcmp(argv[i], "--report") == 0 && hasValue)
+                reportPath = argv[++i];
+            else if (std::strcmp(argv[i], "--capture") == 0 && hasValue)
+                capturePath = argv[++i];
+            else if (std::strcmp(argv[i], "--max-frame-allocations") == 0 && hasValue)
+                maxFrameAllocations = std::atoll(argv[++i]);
+            else if (std::strcmp(argv[i], "--texture-budget") == 0 && hasValue)
+                textureBudgetMiB = std::max(0LL, std::atoll(argv[++i]));
+            else if (std::strcmp(argv[i], "--texture-max-size") == 0 && hasValue)
+                textureMaxSize = std::max(0, std::atoi(argv[++i]));
+            else if (std::strcmp(argv[i], "--benchmark-meshes") == 0)
+                benchmarkMeshes = true;
+            else
+            {
+                std::cout << "Usage: " << argv[0] << " [--headless] [--frames N] [--warmup N] [--report FILE] [--capture FILE] [--max-frame-allocations N]"
+                    << " [--texture-budget MiB] [--texture-max-size N] [--benchmark-meshes]" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Draw calls and triangles submitted during one frame, and the texture residency after it
+struct FrameStats
+{
+    unsigned int drawCalls = 0;
+    unsigned long long triangles = 0;
+    unsigned long long textureBytes = 0;    // GPU memory held by textures
+    unsigned int textureEvictions = 0;      // textures evicted to stay within the budget
+    unsigned int textureDrops = 0;          // top mip levels released to stay within the budget
+    unsigned int textureRestores = 0;       // textures reloading released levels
+
+    void reset()
+    {
+        drawCalls = 0;
+        triangles = 0;
+        textureBytes = 0;
+        textureEvictions = textureDrops = textureRestores = 0;
+    }
+
+    // records one draw of count vertices/indices with the given primitive mode
+    void addDraw(GLenum mode, GLsizei count)
+    {
+        ++drawCalls;
+        if (mode == GL_TRIANGLES)
+            triangles += count / 3;
+        else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2)
+            triangles += count - 2;
+    }
+};
+
+// Moves the camera along a fixed orbit around the table so every run renders the same frames
+class CameraPath
+{
+public:
+    glm::vec3 Target;
+    float Radius;
+    float Height;
+
+    CameraPath(glm::vec3 target = glm::vec3(0.5f, 0.1f, 0.1f), float radius = 3.5f, float height = 1.2f)
+        : Target(target), Radius(radius), Height(height)
+    {
+    }
+
+    // places the camera for frame out of frameCount; one full revolution over the run
+    void apply(Camera& camera, int frame, int frameCount) const
+    {
+        float t = frameCount > 0 ? static_cast<float>(frame) / static_cast<float>(frameCount) : 0.0f;
+        float angle = glm::radians(360.0f) * t;
+        glm::vec3 position(Target.x + Radius * std::cos(angle), Target.y + Height, Target.z + Radius * std::sin(angle));
+        glm::vec3 dir = glm::normalize(Target - position);
+        float yaw = glm::degrees(std::atan2(dir.z, dir.x));
+        float pitch = glm::degrees(std::asin(dir.y));
+        camera.SetPose(position, yaw, pitch);
+    }
+};
+
+// Collects per-frame timings and draw statistics and writes them out as a JSON report
+class BenchmarkRecorder
+{
+public:
+    void reserve(int frames)
+    {
+        frameTimesMs.reserve(frames);
+    }
+
+    void beginFrame()
+    {
+        frameStart = std::chrono::steady_clock::now();
+        frameStartAllocations = allocationCount();
+    }
+
+    // call after the frame's GPU work has finished (glFinish) so the time covers rendering
+    void endFrame(const FrameStats& stats)
+    {
+        unsigned long long allocations = allocationCount() - frameStartAllocations;
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - frameStart;
+        frameTimesMs.push_back(elapsed.count());
+        totalDrawCalls += stats.drawCalls;
+        totalTriangles += stats.triangles;
+        peakTextureBytes = std::max(peakTextureBytes, stats.textureBytes);
+        totalTextureEvictions += stats.textureEvictions;
+        totalTextureDrops += stats.textureDrops;
+        totalTextureRestores += stats.textureRestores;
+        totalAllocations += allocations;
+        maxAllocations = std::max(maxAllocations, allocations);
+        if (allocations > 0)
+            ++framesWithAllocations;
+    }
+
+    // bytes of vertex data the scene keeps in GPU buffers, for the report
+    void setVertexBufferBytes(unsigned long long bytes)
+    {
+        vertexBufferBytes = bytes;
+    }
+
+    // bytes of index data the scene keeps in GPU buffers, for the report
+    void setIndexBufferBytes(unsigned long long bytes)
+    {
+        indexBufferBytes = bytes;
+    }
+
+    // false when some measured frame made more heap allocations than allowed
+    bool allocationsWithin(long long maxPerFrame) const
+    {
+        return maxPerFrame < 0 || maxAllocations <= static_cast<unsigned long long>(maxPerFrame);
+    }
+
+    void writeReport(std::ostream& out, int width, int height, int warmupFrames) const
+    {
+        std::vector<double> sorted(frameTimesMs);
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double t : sorted)
+            sum += t;
+        size_t n = sorted.size();
+        double frames = n > 0 ? static_cast<double>(n) : 1.0;
+        const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+
+        out << "{\n";
+        out << "  \"renderer\": \"" << (renderer ? renderer : "unknown") << "\",\n";
+        out << "  \"width\": " << width << ",\n";
+        out << "  \"height\": " << height << ",\n";
+        out << "  \"warmup_frames\": " << warmupFrames << ",\n";
+        out << "  \"frames\": " << n << ",\n";
+        out << "  \"frame_time_ms\": {\n";
+        out << "    \"min\": " << (n ? sorted.front() : 0.0) << ",\n";
+        out << "    \"mean\": " << sum / frames << ",\n";
+        out << "    \"p50\": " << percentile(sorted, 50.0) << ",\n";
+        out << "    \"p95\": " << percentile(sorted, 95.0) << ",\n";
+        out << "    \"p99\": " << percentile(sorted, 99.0) << ",\n";
+        out << "    \"max\": " << (n ? sorted.back() : 0.0) << "\n";
+        out << "  },\n";
+        out << "  \"draw_calls_per_frame\": " << totalDrawCalls / frames << ",\n";
+        out << "  \"triangles_per_frame\": " << totalTriangles / frames << ",\n";
+        out << "  \"vertex_buffer_bytes\": " << vertexBufferBytes << ",\n";
+        out << "  \"index_buffer_bytes\": " << indexBufferBytes << ",\n";
+        out << "  \"texture_residency\": {\n";
+        out << "    \"peak_bytes\": " << peakTextureBytes << ",\n";
+        out << "    \"evictions\": " << totalTextureEvictions << ",\n";
+        out << "    \"level_drops\": " << totalTextureDrops << ",\n";
+        out << "    \"restores\": " << totalTextureRestores << "\n";
+        out << "  },\n";
+        out << "  \"heap_allocations\": {\n";
+        out << "    \"total\": " << totalAllocations << ",\n";
+        out << "    \"max_per_frame\": " << maxAllocations << ",\n";
+        out << "    \"frames_with_allocations\": " << framesWithAllocations << "\n";
+        out << "  }\n";
+        out << "}" << std::endl;
+    }
+
+    // writes the report to path, or to stdout when path is empty
+    bool writeReport(const std::string& path, int width, int height, int warmupFrames) const
+    {
+        if (path.empty())
+        {
+            writeReport(std::cout, width, height, warmupFrames);
+            return true;
+        }
+        std::ofstream file(path);
+        if (!file)
+        {
+            std::cout << "ERROR::BENCHMARK::CANNOT_WRITE_REPORT: " << path << std::endl;
+            return false;
+        }
+        writeReport(file, width, height, warmupFrames);
+        return true;
+    }
+
+private:
+    std::vector<double> frameTimesMs;
+    unsigned long long totalDrawCalls = 0;
+    unsigned long long totalTriangles = 0;
+    unsigned long long vertexBufferBytes = 0;
+    unsigned long long indexBufferBytes = 0;
+    unsigned long long peakTextureBytes = 0;
+    unsigned long long totalTextureEvictions = 0;
+    unsigned long long totalTextureDrops = 0;
+    unsigned long long totalTextureRestores = 0;
+    unsigned long long totalAllocations = 0;
+    unsigned long long maxAllocations = 0;
+    unsigned long long framesWithAllocations = 0;
+    unsigned long long frameStartAllocations = 0;
+    std::chrono::steady_clock::time_point frameStart;
+
+    // nearest-rank percentile of an already sorted sample
+    static double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty())
+            return 0.0;
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+        rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+        return sorted[rank - 1];
+    }
+};
+#endif
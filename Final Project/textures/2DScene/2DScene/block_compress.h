@@ -0,0 +1,624 @@
+#ifndef BLOCK_COMPRESS_H
+#define BLOCK_COMPRESS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// CPU encoders for the BC1 (DXT1), BC3 (DXT5) and BC7 block-compressed texture formats. Every 4x4
+// block of texels becomes 8 (BC1) or 16 (BC3, BC7) bytes that the GPU samples directly, so a
+// compressed texture takes 1/4 to 1/8 of the memory and bandwidth of RGB8/RGBA8.
+//
+//     BC1  opaque RGB, 4 bits per texel
+//     BC3  RGB as BC1 plus a separately interpolated alpha, 8 bits per texel
+//     BC7  RGBA, 8 bits per texel, much higher quality than BC1/BC3 (only mode 6 is produced:
+//          one pair of 7-bit-plus-p-bit RGBA endpoints and 16 interpolation steps)
+//
+// Images are read as tightly packed 8-bit RGB or RGBA rows; blocks running past the right or
+// bottom edge repeat the last column or row.
+
+enum BlockFormat
+{
+    BLOCK_BC1,
+    BLOCK_BC3,
+    BLOCK_BC7
+};
+
+// speed/quality trade-off shared by all encoders
+//     fast    endpoints from the extremes of the block along its bounding-box diagonal
+//     normal  endpoints from the extremes along the principal axis of the block's colours
+//     high    normal, then least-squares refinement of the endpoints; BC3 also tries the
+//             6-step alpha mode and BC7 every p-bit combination
+enum CompressionQuality
+{
+    COMPRESS_FAST,
+    COMPRESS_NORMAL,
+    COMPRESS_HIGH
+};
+
+inline size_t compressedBlockBytes(BlockFormat format)
+{
+    return format == BLOCK_BC1 ? 8 : 16;
+}
+
+// bytes of a width x height image in format
+inline size_t compressedImageBytes(BlockFormat format, int width, int height)
+{
+    return static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4) * compressedBlockBytes(format);
+}
+
+namespace block_compress_detail
+{
+    // 16 texels of one block, 4 bytes (RGBA) each
+    typedef unsigned char Block[64];
+
+    inline int clampByte(float value)
+    {
+        int rounded = static_cast<int>(value + 0.5f);
+        return rounded < 0 ? 0 : (rounded > 255 ? 255 : rounded);
+    }
+
+    // squared distance over the first dims channels
+    inline int distance(const unsigned char* a, const int* b, int dims)
+    {
+        int sum = 0;
+        for (int c = 0; c < dims; ++c)
+        {
+            int d = a[c] - b[c];
+            sum += d * d;
+        }
+        return sum;
+    }
+
+    // fits a line through the block's texels in the first dims channels and returns its ends:
+    // the extreme projections of the texels onto the fitted axis
+    inline void fitEndpoints(const Block block, int dims, CompressionQuality quality, float lo[4], float hi[4])
+    {
+        float mean[4] = {}, low[4], high[4];
+        for (int c = 0; c < dims; ++c)
+        {
+            low[c] = high[c] = block[c];
+            for (int i = 0; i < 16; ++i)
+            {
+                float value = block[i * 4 + c];
+                mean[c] += value;
+                low[c] = value < low[c] ? value : low[c];
+                high[c] = value > high[c] ? value : high[c];
+            }
+            mean[c] /= 16.0f;
+        }
+
+        float axis[4] = {};
+        float length = 0.0f;
+        for (int c = 0; c < dims; ++c)
+        {
+            axis[c] = high[c] - low[c];
+            length += axis[c] * axis[c];
+        }
+        if (length < 1e-6f)
+        {
+            for (int c = 0; c < dims; ++c)
+                lo[c] = hi[c] = mean[c];
+            return;
+        }
+
+        if (quality != COMPRESS_FAST)
+        {
+            // principal axis by power iteration on the covariance, starting from the diagonal
+            float covariance[4][4] = {};
+            for (int i = 0; i < 16; ++i)
+            {
+                for (int a = 0; a < dims; ++a)
+                {
+                    for (int b = a; b < dims; ++b)
+                        covariance[a][b] += (block[i * 4 + a] - mean[a]) * (block[i * 4 + b] - mean[b]);
+                }
+            }
+            for (int a = 0; a < dims; ++a)
+            {
+                for (int b = 0; b < a; ++b)
+                    covariance[a][b] = covariance[b][a];
+            }
+            for (int iteration = 0; iteration < 8; ++iteration)
+            {
+                float next[4] = {};
+                float norm = 0.0f;
+                for (int a = 0; a < dims; ++a)
+                {
+                    for (int b = 0; b < dims; ++b)
+                        next[a] += covariance[a][b] * axis[b];
+                    norm += next[a] * next[a];
+                }
+                if (norm < 1e-12f)
+                    break;
+                norm = 1.0f / std::sqrt(norm);
+                for (int a = 0; a < dims; ++a)
+                    axis[a] = next[a] * norm;
+            }
+        }
+
+        length = 0.0f;
+        for (int c = 0; c < dims; ++c)
+            length += axis[c] * axis[c];
+        float tMin = 0.0f, tMax = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            float t = 0.0f;
+            for (int c = 0; c < dims; ++c)
+                t += (block[i * 4 + c] - mean[c]) * axis[c];
+            tMin = i == 0 || t < tMin ? t : tMin;
+            tMax = i == 0 || t > tMax ? t : tMax;
+        }
+        for (int c = 0; c < dims; ++c)
+        {
+            lo[c] = mean[c] + axis[c] * tMin / length;
+            hi[c] = mean[c] + axis[c] * tMax / length;
+        }
+    }
+
+    // least-squares endpoints for fixed per-texel weights (0 = lo, 1 = hi); false if degenerate
+    inline bool refineEndpoints(const Block block, int dims, const float weights[16], float lo[4], float hi[4])
+    {
+        float aa = 0.0f, bb = 0.0f, ab = 0.0f, ax[4] = {}, bx[4] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            float b = weights[i], a = 1.0f - b;
+            aa += a * a;
+            bb += b * b;
+            ab += a * b;
+            for (int c = 0; c < dims; ++c)
+            {
+                ax[c] += a * block[i * 4 + c];
+                bx[c] += b * block[i * 4 + c];
+            }
+        }
+        float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1e-6f)
+            return false;
+        for (int c = 0; c < dims; ++c)
+        {
+            lo[c] = static_cast<float>(clampByte((ax[c] * bb - bx[c] * ab) / determinant));
+            hi[c] = static_cast<float>(clampByte((bx[c] * aa - ax[c] * ab) / determinant));
+        }
+        return true;
+    }
+
+    // BC1/BC3 colour block ---------------------------------------------------------------------
+
+    inline int packRGB565(const float color[4])
+    {
+        int r = (clampByte(color[0]) * 31 + 127) / 255;
+        int g = (clampByte(color[1]) * 63 + 127) / 255;
+        int b = (clampByte(color[2]) * 31 + 127) / 255;
+        return (r << 11) | (g << 5) | b;
+    }
+
+    inline void unpackRGB565(int packed, int color[3])
+    {
+        int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // picks the nearest of the four palette entries for every texel; returns the total error
+    inline int colorIndices(const Block block, int c0, int c1, unsigned char indices[16])
+    {
+        int palette[4][3];
+        unpackRGB565(c0, palette[0]);
+        unpackRGB565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        int error = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0, bestError = distance(block + i * 4, palette[0], 3);
+            for (int p = 1; p < 4; ++p)
+            {
+                int e = distance(block + i * 4, palette[p], 3);
+                if (e < bestError)
+                {
+                    best = p;
+                    bestError = e;
+                }
+            }
+            indices[i] = static_cast<unsigned char>(best);
+            error += bestError;
+        }
+        return error;
+    }
+
+    // four-colour BC1 block (also the colour half of BC3)
+    inline void encodeColorBlock(const Block block, CompressionQuality quality, unsigned char out[8])
+    {
+        float lo[4], hi[4];
+        fitEndpoints(block, 3, quality, lo, hi);
+        int c0 = packRGB565(hi), c1 = packRGB565(lo);
+        unsigned char indices[16];
+        int error = colorIndices(block, c0, c1, indices);
+
+        if (quality == COMPRESS_HIGH)
+        {
+            static const float PALETTE_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+            for (int iteration = 0; iteration < 2 && error > 0; ++iteration)
+            {
+                float weights[16];
+                for (int i = 0; i < 16; ++i)
+                    weights[i] = PALETTE_WEIGHTS[indices[i]];
+                // weights run from c0 (0) to c1 (1), so c0 is the refined "lo" end
+                float first[4], second[4];
+                if (!refineEndpoints(block, 3, weights, first, second))
+                    break;
+                int r0 = packRGB565(first), r1 = packRGB565(second);
+                unsigned char refined[16];
+                int refinedError = colorIndices(block, r0, r1, refined);
+                if (refinedError >= error)
+                    break;
+                c0 = r0;
+                c1 = r1;
+                error = refinedError;
+                std::memcpy(indices, refined, sizeof(indices));
+            }
+        }
+
+        // c0 > c1 selects the four-colour mode; equal endpoints need every index on entry 0
+        static const unsigned char SWAPPED[4] = { 1, 0, 3, 2 };
+        if (c0 < c1)
+        {
+            int swap = c0;
+            c0 = c1;
+            c1 = swap;
+            for (int i = 0; i < 16; ++i)
+                indices[i] = SWAPPED[indices[i]];
+        }
+        else if (c0 == c1)
+            std::memset(indices, 0, sizeof(indices));
+
+        uint32_t bits = 0;
+        for (int i = 0; i < 16; ++i)
+            bits |= static_cast<uint32_t>(indices[i]) << (i * 2);
+        out[0] = static_cast<unsigned char>(c0);
+        out[1] = static_cast<unsigned char>(c0 >> 8);
+        out[2] = static_cast<unsigned char>(c1);
+        out[3] = static_cast<unsigned char>(c1 >> 8);
+        for (int b = 0; b < 4; ++b)
+            out[4 + b] = static_cast<unsigned char>(bits >> (b * 8));
+    }
+
+    // BC3 alpha block ----------------------------------------------------------------------------
+
+    // builds the 8-entry alpha palette for a0, a1 (8-step mode if a0 > a1, else 6 steps plus 0 and 255)
+    inline void alphaPalette(int a0, int a1, int palette[8])
+    {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1)
+        {
+            for (int i = 1; i < 7; ++i)
+                palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+        }
+        else
+        {
+            for (int i = 1; i < 5; ++i)
+                palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    inline int alphaIndices(const Block block, int a0, int a1, unsigned char indices[16])
+    {
+        int palette[8];
+        alphaPalette(a0, a1, palette);
+        int error = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            int alpha = block[i * 4 + 3];
+            int best = 0, bestError = (alpha - palette[0]) * (alpha - palette[0]);
+            for (int p = 1; p < 8; ++p)
+            {
+                int e = (alpha - palette[p]) * (alpha - palette[p]);
+                if (e < bestError)
+                {
+                    best = p;
+                    bestError = e;
+                }
+            }
+            indices[i] = static_cast<unsigned char>(best);
+            error += bestError;
+        }
+        return error;
+    }
+
+    inline void encodeAlphaBlock(const Block block, CompressionQuality quality, unsigned char out[8])
+    {
+        int low = 255, high = 0, innerLow = 255, innerHigh = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            int alpha = block[i * 4 + 3];
+            low = alpha < low ? alpha : low;
+            high = alpha > high ? alpha : high;
+            if (alpha != 0 && alpha != 255)
+            {
+                innerLow = alpha < innerLow ? alpha : innerLow;
+                innerHigh = alpha > innerHigh ? alpha : innerHigh;
+            }
+        }
+
+        int a0 = high, a1 = low;
+        unsigned char indices[16];
+        int error = alphaIndices(block, a0, a1, indices);
+        if (quality == COMPRESS_HIGH && error > 0)
+        {
+            // 6-step mode spends its steps on the texels between the exact 0 and 255 entries
+            if (innerLow > innerHigh)
+                innerLow = innerHigh = low;
+            unsigned char sixStep[16];
+            int sixStepError = alphaIndices(block, innerLow, innerHigh, sixStep);
+            if (sixStepError < error)
+            {
+                a0 = innerLow;
+                a1 = innerHigh;
+                std::memcpy(indices, sixStep, sizeof(indices));
+            }
+        }
+
+        uint64_t bits = 0;
+        for (int i = 0; i < 16; ++i)
+            bits |= static_cast<uint64_t>(indices[i]) << (i * 3);
+        out[0] = static_cast<unsigned char>(a0);
+        out[1] = static_cast<unsigned char>(a1);
+        for (int b = 0; b < 6; ++b)
+            out[2 + b] = static_cast<unsigned char>(bits >> (b * 8));
+    }
+
+    // BC7 mode 6 -------------------------------------------------------------------------------
+
+    const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // 7-bit endpoint channels for value with the given p-bit (the decoded value is q << 1 | p)
+    inline void quantizeBC7(const float value[4], int pBit, int quantized[4])
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            int q = static_cast<int>(std::floor((value[c] - pBit) / 2.0f + 0.5f));
+            quantized[c] = q < 0 ? 0 : (q > 127 ? 127 : q);
+        }
+    }
+
+    // p-bit whose quantization lands closest to value. Only p = 1 can reproduce alpha 255 (127 << 1 | 1),
+    // so an opaque block must use it even when the colour channels would land closer with p = 0.
+    inline int bestPBit(const float value[4], bool opaque)
+    {
+        if (opaque)
+            return 1;
+        float error[2] = {};
+        for (int p = 0; p < 2; ++p)
+        {
+            int quantized[4];
+            quantizeBC7(value, p, quantized);
+            for (int c = 0; c < 4; ++c)
+            {
+                float d = static_cast<float>((quantized[c] << 1) | p) - value[c];
+                error[p] += d * d;
+            }
+        }
+        return error[1] < error[0] ? 1 : 0;
+    }
+
+    struct BC7Candidate
+    {
+        int e0[4];
+        int e1[4];
+        int p0;
+        int p1;
+        unsigned char indices[16];
+        int error;
+    };
+
+    inline void evaluateBC7(const Block block, const float lo[4], const float hi[4], int p0, int p1, BC7Candidate& candidate)
+    {
+        candidate.p0 = p0;
+        candidate.p1 = p1;
+        quantizeBC7(lo, p0, candidate.e0);
+        quantizeBC7(hi, p1, candidate.e1);
+        int palette[16][4];
+        for (int c = 0; c < 4; ++c)
+        {
+            int v0 = (candidate.e0[c] << 1) | p0, v1 = (candidate.e1[c] << 1) | p1;
+            for (int i = 0; i < 16; ++i)
+                palette[i][c] = ((64 - BC7_WEIGHTS[i]) * v0 + BC7_WEIGHTS[i] * v1 + 32) >> 6;
+        }
+        candidate.error = 0;
+        for (int t = 0; t < 16; ++t)
+        {
+            int best = 0, bestError = distance(block + t * 4, palette[0], 4);
+            for (int i = 1; i < 16 && bestError > 0; ++i)
+            {
+                int e = distance(block + t * 4, palette[i], 4);
+                if (e < bestError)
+                {
+                    best = i;
+                    bestError = e;
+                }
+            }
+            candidate.indices[t] = static_cast<unsigned char>(best);
+            candidate.error += bestError;
+        }
+    }
+
+    // reads bits of a 128-bit block back in the order BitWriter wrote them
+    struct BitReader
+    {
+        const unsigned char* in;
+        int position;
+
+        uint32_t get(int count)
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < count; ++i, ++position)
+                value |= static_cast<uint32_t>((in[position >> 3] >> (position & 7)) & 1) << i;
+            return value;
+        }
+    };
+
+    // appends bits to a 128-bit block, least significant bit first
+    struct BitWriter
+    {
+        unsigned char* out;
+        int position;
+
+        void put(uint32_t value, int count)
+        {
+            for (int i = 0; i < count; ++i, ++position)
+            {
+                if ((value >> i) & 1)
+                    out[position >> 3] |= static_cast<unsigned char>(1 << (position & 7));
+            }
+        }
+    };
+
+    inline void encodeBC7Block(const Block block, CompressionQuality quality, unsigned char out[16])
+    {
+        float lo[4], hi[4];
+        fitEndpoints(block, 4, quality, lo, hi);
+        // a block that is fully opaque must decode to exactly 255, not 254, or blending and alpha
+        // testing see it as translucent: pin both alpha endpoints and use p-bit 1 only
+        bool opaque = true;
+        for (int t = 0; t < 16; ++t)
+            opaque = opaque && block[t * 4 + 3] == 255;
+        if (opaque)
+            lo[3] = hi[3] = 255.0f;
+
+        BC7Candidate best;
+        if (quality == COMPRESS_HIGH)
+        {
+            best.error = -1;
+            for (int iteration = 0; iteration < 3; ++iteration)
+            {
+                BC7Candidate candidate;
+                bool improved = false;
+                for (int p = opaque ? 3 : 0; p < 4; ++p)
+                {
+                    evaluateBC7(block, lo, hi, p & 1, p >> 1, candidate);
+                    if (best.error < 0 || candidate.error < best.error)
+                    {
+                        best = candidate;
+                        improved = true;
+                    }
+                }
+                if (!improved || best.error == 0)
+                    break;
+                float weights[16];
+                for (int i = 0; i < 16; ++i)
+                    weights[i] = BC7_WEIGHTS[best.indices[i]] / 64.0f;
+                if (!refineEndpoints(block, 4, weights, lo, hi))
+                    break;
+                if (opaque)
+                    lo[3] = hi[3] = 255.0f;
+            }
+        }
+        else
+            evaluateBC7(block, lo, hi, bestPBit(lo, opaque), bestPBit(hi, opaque), best);
+
+        // the first texel's index is stored in 3 bits, so it must point into the lower half
+        if (best.indices[0] >= 8)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                int swap = best.e0[c];
+                best.e0[c] = best.e1[c];
+                best.e1[c] = swap;
+            }
+            int swap = best.p0;
+            best.p0 = best.p1;
+            best.p1 = swap;
+            for (int i = 0; i < 16; ++i)
+                best.indices[i] = static_cast<unsigned char>(15 - best.indices[i]);
+        }
+
+        std::memset(out, 0, 16);
+        BitWriter writer = { out, 0 };
+        writer.put(1u << 6, 7); // mode 6
+        for (int c = 0; c < 4; ++c)
+        {
+            writer.put(static_cast<uint32_t>(best.e0[c]), 7);
+            writer.put(static_cast<uint32_t>(best.e1[c]), 7);
+        }
+        writer.put(static_cast<uint32_t>(best.p0), 1);
+        writer.put(static_cast<uint32_t>(best.p1), 1);
+        writer.put(best.indices[0], 3);
+        for (int i = 1; i < 16; ++i)
+            writer.put(best.indices[i], 4);
+    }
+}
+
+// compresses a width x height image with channels (3 or 4) bytes per texel into out, which must
+// hold compressedImageBytes(format, width, height) bytes; blocks are written row by row
+inline void compressImage(BlockFormat format, const unsigned char* pixels, int width, int height, int channels,
+    CompressionQuality quality, unsigned char* out)
+{
+    using namespace block_compress_detail;
+    size_t blockSize = compressedBlockBytes(format);
+    for (int by = 0; by < height; by += 4)
+    {
+        for (int bx = 0; bx < width; bx += 4)
+        {
+            Block block;
+            for (int y = 0; y < 4; ++y)
+            {
+                int sy = by + y < height ? by + y : height - 1;
+                for (int x = 0; x < 4; ++x)
+                {
+                    int sx = bx + x < width ? bx + x : width - 1;
+                    const unsigned char* texel = pixels + (static_cast<size_t>(sy) * width + sx) * channels;
+                    unsigned char* dst = block + (y * 4 + x) * 4;
+                    dst[0] = texel[0];
+                    dst[1] = texel[1];
+                    dst[2] = texel[2];
+                    dst[3] = channels == 4 ? texel[3] : 255;
+                }
+            }
+
+            if (format == BLOCK_BC1)
+                encodeColorBlock(block, quality, out);
+            else if (format == BLOCK_BC3)
+            {
+                encodeAlphaBlock(block, quality, out);
+                encodeColorBlock(block, quality, out + 8);
+            }
+            else
+                encodeBC7Block(block, quality, out);
+            out += blockSize;
+        }
+    }
+}
+
+// decodes one BC7 block written by compressImage into 16 RGBA texels, row by row; false (and
+// nothing decoded) for any mode other than 6, which this encoder never produces
+inline bool decodeBC7Block(const unsigned char in[16], unsigned char out[64])
+{
+    using namespace block_compress_detail;
+    BitReader reader = { in, 0 };
+    if (reader.get(7) != (1u << 6))
+        return false;
+    int e0[4], e1[4];
+    for (int c = 0; c < 4; ++c)
+    {
+        e0[c] = static_cast<int>(reader.get(7));
+        e1[c] = static_cast<int>(reader.get(7));
+    }
+    int p0 = static_cast<int>(reader.get(1)), p1 = static_cast<int>(reader.get(1));
+    for (int t = 0; t < 16; ++t)
+    {
+        int weight = BC7_WEIGHTS[reader.get(t == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; ++c)
+            out[t * 4 + c] = static_cast<unsigned char>(((64 - weight) * ((e0[c] << 1) | p0) + weight * ((e1[c] << 1) | p1) + 32) >> 6);
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,51 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+// x86 SIMD support shared by the hand-vectorized kernels.
+//
+// SIMD_SSE2 is defined when SSE2 can be used unconditionally (every x64 CPU; 32-bit builds with
+// /arch:SSE2 or -msse2). SIMD_AVX2 is defined when AVX2 kernels can be compiled: mark each with
+// SIMD_TARGET_AVX2 and only call it after cpuHasAVX2() returned true, since the rest of the
+// program is built for the baseline instruction set.
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(SIMD_SSE2) && (defined(_MSC_VER) || defined(__GNUC__))
+#define SIMD_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SIMD_TARGET_AVX2
+#else
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// true if the CPU and the OS (which must save the YMM registers) both support AVX2
+inline bool cpuHasAVX2()
+{
+#if defined(SIMD_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+    static const bool supported = [] {
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0, avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }();
+    return supported;
+#elif defined(SIMD_AVX2)
+    static const bool supported = __builtin_cpu_supports("avx2") != 0;
+    return supported;
+#else
+    return false;
+#endif
+}
+#endif
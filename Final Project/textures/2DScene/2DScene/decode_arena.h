@@ -0,0 +1,268 @@
+#ifndef DECODE_ARENA_H
+#define DECODE_ARENA_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// Bump allocator for stb_image's scratch memory. Every thread has its own arena, so decodes
+// running in parallel never meet in the global allocator. While a DecodeArenaScope is open on a
+// thread, stb_image's allocations there (JPEG planes and coefficients, PNG compressed data, ...)
+// are carved from one block reserved when the scope opens, and all of them are dropped at once
+// when it closes; the block stays with the thread for its next image. The buffers stb_image may
+// return are allocated with STBI_MALLOC_RESULT, which always uses the heap, so the pixels outlive
+// the scope and can be freed on any thread. Whatever does not fit the block, and everything
+// allocated with no scope open, goes to the heap as before.
+//
+// The translation unit holding stb_image's implementation routes it here with
+//     #define STBI_MALLOC(size) decodeArenaMalloc(size)
+//     #define STBI_REALLOC_SIZED(pointer, oldSize, newSize) decodeArenaRealloc(pointer, oldSize, newSize)
+//     #define STBI_FREE(pointer) decodeArenaFree(pointer)
+//     #define STBI_MALLOC_RESULT(size) decodeArenaMallocResult(size)
+// before including stb_image.h. Arena memory must be freed on the thread that allocated it, which
+// stb_image does (its parallel JPEG tasks free what they allocate).
+
+// blocks larger than this are returned to the heap when their scope closes instead of being kept
+const size_t DECODE_ARENA_RETAIN_BYTES = 64u << 20;
+
+// allocator calls made through the hooks by one thread
+struct DecodeArenaStats
+{
+    uint64_t arenaAllocations = 0;  // served from the block
+    uint64_t heapAllocations = 0;   // results, overflow, and anything outside a scope
+    uint64_t blocks = 0;            // blocks reserved from the heap
+    double milliseconds = 0.0;      // time spent inside the hooks, while timing is on
+};
+
+class DecodeArena
+{
+public:
+    DecodeArenaStats stats;
+    bool timing = false;    // measure the hooks into stats.milliseconds (costs a clock read per call)
+
+    DecodeArena() = default;
+    ~DecodeArena()
+    {
+        std::free(block);
+    }
+
+    DecodeArena(const DecodeArena&) = delete;
+    DecodeArena& operator=(const DecodeArena&) = delete;
+
+    bool isOpen() const
+    {
+        return open;
+    }
+
+    // starts serving allocations, from a block of at least bytes
+    void begin(size_t bytes)
+    {
+        if (bytes > capacity)
+        {
+            std::free(block);
+            capacity = (bytes + (1u << 20) - 1) & ~static_cast<size_t>((1u << 20) - 1);
+            block = static_cast<unsigned char*>(std::malloc(capacity));
+            if (!block)
+                capacity = 0;
+            ++stats.blocks;
+        }
+        top = 0;
+        last = nullptr;
+        open = true;
+    }
+
+    // drops every allocation made since begin()
+    void end()
+    {
+        open = false;
+        top = 0;
+        last = nullptr;
+        if (capacity > DECODE_ARENA_RETAIN_BYTES)
+        {
+            std::free(block);
+            block = nullptr;
+            capacity = 0;
+        }
+    }
+
+    bool owns(const void* pointer) const
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(pointer);
+        return block && p >= block && p < block + capacity;
+    }
+
+    // size bytes from the block, or null if they do not fit
+    void* allocate(size_t size)
+    {
+        size_t start = (top + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        if (!open || start > capacity || size > capacity - start)
+            return nullptr;
+        last = block + start;
+        top = start + size;
+        return last;
+    }
+
+    // grows an allocation from the block: in place if it is the latest one, else by copying it to
+    // a new one; null if the new size does not fit (pointer is left as it was)
+    void* reallocate(void* pointer, size_t oldSize, size_t newSize)
+    {
+        unsigned char* p = static_cast<unsigned char*>(pointer);
+        if (p == last && newSize <= capacity - static_cast<size_t>(p - block))
+        {
+            top = static_cast<size_t>(p - block) + newSize;
+            return p;
+        }
+        if (newSize <= oldSize)
+            return p;
+        void* moved = allocate(newSize);
+        if (moved)
+            std::memcpy(moved, p, oldSize);
+        return moved;
+    }
+
+    // only the latest allocation gives its bytes back; the rest wait for end()
+    void release(void* pointer)
+    {
+        if (pointer == last)
+        {
+            top = static_cast<size_t>(last - block);
+            last = nullptr;
+        }
+    }
+
+private:
+    static const size_t ALIGNMENT = 32; // enough for the AVX2 kernels' loads
+
+    unsigned char* block = nullptr;
+    size_t capacity = 0;
+    size_t top = 0;                 // bytes in use
+    unsigned char* last = nullptr;  // latest allocation, which can grow or shrink in place
+    bool open = false;
+};
+
+// the calling thread's arena
+inline DecodeArena& threadDecodeArena()
+{
+    static thread_local DecodeArena arena;
+    return arena;
+}
+
+// adds the time until it goes out of scope to the arena's stats if timing is on
+class DecodeArenaTimer
+{
+public:
+    explicit DecodeArenaTimer(DecodeArena& arena) : arena(arena)
+    {
+        if (arena.timing)
+            start = std::chrono::steady_clock::now();
+    }
+    ~DecodeArenaTimer()
+    {
+        if (arena.timing)
+            arena.stats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    DecodeArena& arena;
+    std::chrono::steady_clock::time_point start;
+};
+
+inline void* decodeArenaMalloc(size_t size)
+{
+    DecodeArena& arena = threadDecodeArena();
+    DecodeArenaTimer timer(arena);
+    void* pointer = arena.allocate(size);
+    if (pointer)
+    {
+        ++arena.stats.arenaAllocations;
+        return pointer;
+    }
+    ++arena.stats.heapAllocations;
+    return std::malloc(size);
+}
+
+inline void* decodeArenaMallocResult(size_t size)
+{
+    DecodeArena& arena = threadDecodeArena();
+    DecodeArenaTimer timer(arena);
+    ++arena.stats.heapAllocations;
+    return std::malloc(size);
+}
+
+inline void* decodeArenaRealloc(void* pointer, size_t oldSize, size_t newSize)
+{
+    if (!pointer)
+        return decodeArenaMalloc(newSize);
+    DecodeArena& arena = threadDecodeArena();
+    DecodeArenaTimer timer(arena);
+    if (!arena.owns(pointer))
+    {
+        ++arena.stats.heapAllocations;
+        return std::realloc(pointer, newSize);
+    }
+    void* grown = arena.reallocate(pointer, oldSize, newSize);
+    if (grown)
+    {
+        ++arena.stats.arenaAllocations;
+        return grown;
+    }
+    // out of room: the allocation moves to the heap and its old bytes wait for end()
+    ++arena.stats.heapAllocations;
+    grown = std::malloc(newSize);
+    if (grown)
+        std::memcpy(grown, pointer, oldSize < newSize ? oldSize : newSize);
+    return grown;
+}
+
+inline void decodeArenaFree(void* pointer)
+{
+    if (!pointer)
+        return;
+    DecodeArena& arena = threadDecodeArena();
+    DecodeArenaTimer timer(arena);
+    if (arena.owns(pointer))
+        arena.release(pointer);
+    else
+        std::free(pointer);
+}
+
+// Opens the calling thread's arena for one decode, with room for bytes of scratch memory, and
+// drops everything allocated from it on destruction. A scope opened while another is open on the
+// same thread shares the outer one.
+class DecodeArenaScope
+{
+public:
+    explicit DecodeArenaScope(size_t bytes) : arena(threadDecodeArena()), outer(arena.isOpen())
+    {
+        if (!outer)
+            arena.begin(bytes);
+    }
+    ~DecodeArenaScope()
+    {
+        if (!outer)
+            arena.end();
+    }
+
+    DecodeArenaScope(const DecodeArenaScope&) = delete;
+    DecodeArenaScope& operator=(const DecodeArenaScope&) = delete;
+
+    // pixels (bytes long) as heap memory that outlives the scope: the PNG and JPEG decoders return
+    // heap memory already, the other formats' results are copied out of the arena. Null if that
+    // copy cannot be allocated.
+    unsigned char* keep(unsigned char* pixels, size_t bytes)
+    {
+        if (!arena.owns(pixels))
+            return pixels;
+        unsigned char* copy = static_cast<unsigned char*>(std::malloc(bytes));
+        if (copy)
+            std::memcpy(copy, pixels, bytes);
+        return copy;
+    }
+
+private:
+    DecodeArena& arena;
+    bool outer;
+};
+#endif
@@ -0,0 +1,315 @@
+#ifndef DECODED_IMAGE_CACHE_H
+#define DECODED_IMAGE_CACHE_H
+
+#include <mapped_file.h>
+#include <mipmap.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Persistent cache of decoded images: one file per source image and decode setting holding the
+// pixels and CPU mip chain exactly as TextureCache uploads them, so a warm start maps the file
+// and skips PNG inflate, JPEG IDCT and mip filtering entirely.
+//
+// Entries are named after a key that hashes the source file's bytes together with the decode
+// parameters, so an edited image simply misses. Each entry file is
+//     CachedImageHeader, level 0 pixels, the levels below it (see buildMipChain)
+// and is written to a temporary name and renamed, so a crash never leaves a partial entry.
+// Opening or using an entry refreshes its modification time; when the directory grows past its
+// byte budget the entries used longest ago are deleted. Safe to use from several threads.
+
+const char DECODED_IMAGE_MAGIC[8] = { 'D', 'I', 'M', 'G', 'C', 'A', 'C', 'H' };
+// bump when the decoder or the mip filter changes so older entries miss instead of going stale
+const uint32_t DECODED_IMAGE_VERSION = 1;
+
+struct CachedImageHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t channels;
+    uint32_t width;
+    uint32_t height;
+    uint64_t key;
+    uint64_t pixelBytes;    // level 0
+    uint64_t mipBytes;      // every level below it
+    uint64_t reserved[2];
+};
+
+static_assert(sizeof(CachedImageHeader) == 64, "CachedImageHeader layout is part of the file format");
+
+class DecodedImageCache
+{
+public:
+    // an entry mapped by load(): both pointers stay valid as long as file is open
+    struct View
+    {
+        const unsigned char* pixels = nullptr;
+        const unsigned char* mips = nullptr;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+    };
+
+    // uses directory (created if needed) for entries, keeping it under maxBytes; false, with the
+    // cache left disabled, if the directory cannot be created
+    bool open(const std::string& directory, uint64_t maxBytes)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error || !std::filesystem::is_directory(directory, error))
+        {
+            std::cout << "ERROR::DECODED_IMAGE_CACHE::CANNOT_CREATE: " << directory << std::endl;
+            return false;
+        }
+        root = directory;
+        budget = maxBytes;
+        std::lock_guard<std::mutex> lock(trimMutex);
+        trim();
+        return true;
+    }
+
+    bool isOpen() const
+    {
+        return !root.empty();
+    }
+
+    // key of an image decoded from bytes (the whole source file) with the given channel request
+    // (0 = as stored), vertical flip and size limit (0 = none)
+    static uint64_t keyFor(const unsigned char* bytes, size_t size, int channels, bool flip, int maxSize = 0)
+    {
+        uint64_t parameters[4] = { DECODED_IMAGE_VERSION, static_cast<uint64_t>(channels), flip ? 1u : 0u, static_cast<uint64_t>(maxSize) };
+        uint64_t seed = hashBytes(reinterpret_cast<const unsigned char*>(parameters), sizeof(parameters), 0);
+        return hashBytes(bytes, size, seed);
+    }
+
+    // maps the entry for key into file; false on a miss or an entry that fails validation (which is
+    // then deleted)
+    bool load(uint64_t key, MappedFile& file, View& view)
+    {
+        std::string path = entryPath(key);
+        if (!file.open(path))
+        {
+            ++missCount;
+            return false;
+        }
+        const CachedImageHeader* header = reinterpret_cast<const CachedImageHeader*>(file.data());
+        bool valid = file.size() >= sizeof(CachedImageHeader) && std::memcmp(header->magic, DECODED_IMAGE_MAGIC, 8) == 0
+            && header->version == DECODED_IMAGE_VERSION && header->key == key
+            && (header->channels == 3 || header->channels == 4) && header->width > 0 && header->height > 0;
+        if (valid)
+        {
+            int width = static_cast<int>(header->width), height = static_cast<int>(header->height);
+            int channels = static_cast<int>(header->channels);
+            valid = header->pixelBytes == static_cast<uint64_t>(width) * height * channels
+                && header->mipBytes == mipChainTailBytes(width, height, channels)
+                && file.size() == sizeof(CachedImageHeader) + header->pixelBytes + header->mipBytes;
+        }
+        if (!valid)
+        {
+            std::cout << "ERROR::DECODED_IMAGE_CACHE::INVALID_ENTRY: " << path << std::endl;
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            ++missCount;
+            return false;
+        }
+
+        view.width = static_cast<int>(header->width);
+        view.height = static_cast<int>(header->height);
+        view.channels = static_cast<int>(header->channels);
+        view.pixels = file.data() + sizeof(CachedImageHeader);
+        view.mips = view.pixels + header->pixelBytes;
+        touch(path);
+        ++hitCount;
+        return true;
+    }
+
+    // writes the entry for key, then trims the directory back under budget
+    void store(uint64_t key, const unsigned char* pixels, const unsigned char* mips, int width, int height, int channels)
+    {
+        CachedImageHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, DECODED_IMAGE_MAGIC, sizeof(header.magic));
+        header.version = DECODED_IMAGE_VERSION;
+        header.channels = static_cast<uint32_t>(channels);
+        header.width = static_cast<uint32_t>(width);
+        header.height = static_cast<uint32_t>(height);
+        header.key = key;
+        header.pixelBytes = static_cast<uint64_t>(width) * height * channels;
+        header.mipBytes = mipChainTailBytes(width, height, channels);
+        if (sizeof(header) + header.pixelBytes + header.mipBytes > budget)
+            return;
+
+        // the temporary name is per thread so concurrent stores never share a file
+        std::string path = entryPath(key);
+        std::string tempPath = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(pixels), static_cast<std::streamsize>(header.pixelBytes));
+            out.write(reinterpret_cast<const char*>(mips), static_cast<std::streamsize>(header.mipBytes));
+            if (!out)
+            {
+                out.close();
+                std::remove(tempPath.c_str());
+                std::cout << "ERROR::DECODED_IMAGE_CACHE::CANNOT_WRITE: " << tempPath << std::endl;
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(tempPath, path, error);
+        if (error)
+        {
+            std::remove(tempPath.c_str());
+            std::cout << "ERROR::DECODED_IMAGE_CACHE::CANNOT_WRITE: " << path << std::endl;
+            return;
+        }
+        ++storeCount;
+
+        std::lock_guard<std::mutex> lock(trimMutex);
+        trim();
+    }
+
+    size_t hits() const
+    {
+        return hitCount;
+    }
+
+    size_t misses() const
+    {
+        return missCount;
+    }
+
+    size_t stores() const
+    {
+        return storeCount;
+    }
+
+    // bytes in the directory after the last trim
+    uint64_t bytes() const
+    {
+        return totalBytes;
+    }
+
+    uint64_t maxBytes() const
+    {
+        return budget;
+    }
+
+private:
+    std::string root;
+    uint64_t budget = 0;
+    std::mutex trimMutex;
+    std::atomic<uint64_t> totalBytes{ 0 };
+    std::atomic<size_t> hitCount{ 0 };
+    std::atomic<size_t> missCount{ 0 };
+    std::atomic<size_t> storeCount{ 0 };
+
+    std::string entryPath(uint64_t key) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.img", static_cast<unsigned long long>(key));
+        return (std::filesystem::path(root) / name).string();
+    }
+
+    // marks an entry as just used for the eviction order
+    static void touch(const std::string& path)
+    {
+        std::error_code error;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    }
+
+    // deletes the least recently used entries until the directory fits the budget (trimMutex held)
+    void trim()
+    {
+        struct Item
+        {
+            std::filesystem::path path;
+            std::filesystem::file_time_type used;
+            uint64_t size;
+        };
+        std::vector<Item> items;
+        uint64_t total = 0;
+        std::error_code error;
+        for (std::filesystem::directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+        {
+            if (it->path().extension() != ".img")
+                continue;
+            std::error_code entryError;
+            Item item{ it->path(), it->last_write_time(entryError), static_cast<uint64_t>(it->file_size(entryError)) };
+            if (entryError)
+                continue;
+            total += item.size;
+            items.push_back(item);
+        }
+        std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.used < b.used; });
+        for (size_t i = 0; i < items.size() && total > budget; ++i)
+        {
+            if (std::filesystem::remove(items[i].path, error))
+                total -= items[i].size;
+        }
+        totalBytes = total;
+    }
+
+    // XXH64 of size bytes
+    static uint64_t hashBytes(const unsigned char* bytes, size_t size, uint64_t seed)
+    {
+        const uint64_t P1 = 11400714785074694791ULL, P2 = 14029467366897019727ULL, P3 = 1609587929392839161ULL;
+        const uint64_t P4 = 9650029242287828579ULL, P5 = 2870177450012600261ULL;
+        auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+        auto read64 = [](const unsigned char* p) { uint64_t v; std::memcpy(&v, p, 8); return v; };
+        auto round = [&](uint64_t acc, uint64_t input) { return rotl(acc + input * P2, 31) * P1; };
+        auto merge = [&](uint64_t acc, uint64_t value) { return (acc ^ round(0, value)) * P1 + P4; };
+
+        const unsigned char* p = bytes;
+        const unsigned char* end = bytes + size;
+        uint64_t h;
+        if (size >= 32)
+        {
+            uint64_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+            for (; p + 32 <= end; p += 32)
+            {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+            }
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = merge(merge(merge(merge(h, v1), v2), v3), v4);
+        }
+        else
+            h = seed + P5;
+        h += static_cast<uint64_t>(size);
+        for (; p + 8 <= end; p += 8)
+            h = rotl(h ^ round(0, read64(p)), 27) * P1 + P4;
+        if (p + 4 <= end)
+        {
+            uint32_t v;
+            std::memcpy(&v, p, 4);
+            h = rotl(h ^ (static_cast<uint64_t>(v) * P1), 23) * P2 + P3;
+            p += 4;
+        }
+        for (; p < end; ++p)
+            h = rotl(h ^ (*p * P5), 11) * P1;
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+};
+#endif
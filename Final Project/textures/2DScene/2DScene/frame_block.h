@@ -0,0 +1,121 @@
+#ifndef FRAME_BLOCK_H
+#define FRAME_BLOCK_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// C++ mirrors of the std140 "FrameBlock" uniform block declared in shader.vs/shader.fs (and its
+// view/projection prefix in light_cube.vs). std140 aligns every vec3 to 16 bytes and rounds struct
+// sizes up to 16, so the padding members below are what keep the two sides in step; the
+// static_asserts catch any drift when a member is added.
+
+// Binding point the FrameBlock buffer is attached to for every program
+const GLuint FRAME_BLOCK_BINDING = 0;
+
+// Number of point lights in the block (NR_POINT_LIGHTS in shader.fs)
+const int FRAME_POINT_LIGHTS = 2;
+
+struct DirLightStd140
+{
+    glm::vec3 direction;
+    float pad0;
+    glm::vec3 ambient;
+    float pad1;
+    glm::vec3 diffuse;
+    float pad2;
+    glm::vec3 specular;
+    float pad3;
+};
+
+struct PointLightStd140
+{
+    glm::vec3 position;
+    float pad0;
+    glm::vec3 ambient;
+    float pad1;
+    glm::vec3 diffuse;
+    float pad2;
+    glm::vec3 specular;
+    float constant;     // a scalar may fill the tail of the preceding vec3
+    float linear;
+    float quadratic;
+    float pad3[2];
+    glm::vec3 lightColor;
+    float pad4;
+};
+
+struct FrameBlock
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 viewPos;
+    float pad0;
+    DirLightStd140 dirLight;
+    PointLightStd140 pointLights[FRAME_POINT_LIGHTS];
+};
+
+static_assert(sizeof(DirLightStd140) == 64, "DirLight must match its std140 size");
+static_assert(offsetof(PointLightStd140, constant) == 60, "PointLight.constant must match its std140 offset");
+static_assert(offsetof(PointLightStd140, lightColor) == 80, "PointLight.lightColor must match its std140 offset");
+static_assert(sizeof(PointLightStd140) == 96, "PointLight must match its std140 array stride");
+static_assert(offsetof(FrameBlock, viewPos) == 128, "FrameBlock.viewPos must match its std140 offset");
+static_assert(offsetof(FrameBlock, dirLight) == 144, "FrameBlock.dirLight must match its std140 offset");
+static_assert(offsetof(FrameBlock, pointLights) == 208, "FrameBlock.pointLights must match its std140 offset");
+static_assert(sizeof(FrameBlock) == 400, "FrameBlock must match its std140 size");
+
+// One uniform buffer holding a few FrameBlock slots (e.g. the scene lighting and a variant for one
+// object). All slots are written with a single glBufferSubData per frame; switching between them
+// is a glBindBufferRange, not a re-upload.
+class FrameUniformBuffer
+{
+public:
+    unsigned int ID = 0;
+
+    void create(int slotCount)
+    {
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        slotStride = (sizeof(FrameBlock) + alignment - 1) / alignment * alignment;
+        staging.assign(slotStride * slotCount, 0);
+
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferData(GL_UNIFORM_BUFFER, staging.size(), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // copies a block into slot's CPU staging area; nothing reaches the GPU until upload()
+    void write(int slot, const FrameBlock& block)
+    {
+        std::memcpy(&staging[slot * slotStride], &block, sizeof(FrameBlock));
+    }
+
+    // sends every slot to the GPU in one buffer update
+    void upload() const
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, staging.size(), staging.data());
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // makes slot the FrameBlock every program reads from
+    void bind(int slot) const
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, ID, slot * slotStride, sizeof(FrameBlock));
+    }
+
+    void destroy()
+    {
+        glDeleteBuffers(1, &ID);
+        ID = 0;
+    }
+
+private:
+    size_t slotStride = 0;
+    std::vector<unsigned char> staging;
+};
+#endif
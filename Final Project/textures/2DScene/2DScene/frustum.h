@@ -0,0 +1,68 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// Bounding sphere (xyz = centre, w = radius) around vertexCount positions, each the first three
+// floats of a vertex stride floats long: the sphere through the corners of their bounding box
+inline glm::vec4 boundingSphere(const float* vertices, size_t vertexCount, size_t stride)
+{
+    if (vertexCount == 0)
+        return glm::vec4(0.0f);
+    glm::vec3 low(vertices[0], vertices[1], vertices[2]);
+    glm::vec3 high = low;
+    for (size_t i = 1; i < vertexCount; ++i)
+    {
+        glm::vec3 position(vertices[i * stride], vertices[i * stride + 1], vertices[i * stride + 2]);
+        low = glm::min(low, position);
+        high = glm::max(high, position);
+    }
+    return glm::vec4((low + high) * 0.5f, glm::length(high - low) * 0.5f);
+}
+
+// The six clip planes of a view-projection matrix, for testing whether an object can be on screen
+class Frustum
+{
+public:
+    // planes of projection * view (Gribb/Hartmann), normalized so distances are in world units
+    void extract(const glm::mat4& viewProjection)
+    {
+        glm::mat4 m = glm::transpose(viewProjection); // rows of the original as columns
+        planes[0] = m[3] + m[0]; // left
+        planes[1] = m[3] - m[0]; // right
+        planes[2] = m[3] + m[1]; // bottom
+        planes[3] = m[3] - m[1]; // top
+        planes[4] = m[3] + m[2]; // near
+        planes[5] = m[3] - m[2]; // far
+        for (glm::vec4& plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    // whether a sphere in world space is at least partly inside
+    bool intersects(const glm::vec3& centre, float radius) const
+    {
+        for (const glm::vec4& plane : planes)
+        {
+            if (glm::dot(glm::vec3(plane), centre) + plane.w < -radius)
+                return false;
+        }
+        return true;
+    }
+
+    // whether an object with bounding sphere bounds (see boundingSphere) drawn with model is at least
+    // partly inside; a zero-scale model never is
+    bool intersects(const glm::mat4& model, const glm::vec4& bounds) const
+    {
+        glm::vec3 centre = glm::vec3(model * glm::vec4(glm::vec3(bounds), 1.0f));
+        float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+        return scale > 0.0f && intersects(centre, bounds.w * scale);
+    }
+
+private:
+    glm::vec4 planes[6];
+};
+#endif
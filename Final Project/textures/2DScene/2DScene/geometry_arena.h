@@ -0,0 +1,128 @@
+#ifndef GEOMETRY_ARENA_H
+#define GEOMETRY_ARENA_H
+
+#include <vertex_format.h>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// One vertex buffer and one index buffer that every mesh of a vertex format is suballocated from,
+// with a single vertex array describing them. Meshes are appended on the CPU with add(), which
+// hands back where each one landed, and the whole arena goes to the GPU in one upload(). Drawing a
+// mesh is then a glDrawElementsBaseVertex on the arena's vertex array: indices stay relative to
+// the mesh's own first vertex and baseVertex moves them to where it sits in the shared buffer, so
+// switching meshes binds nothing and the number of meshes is only limited by memory.
+// The arena holds PackedVertex data (see vertex_format.h); a mesh in another layout would get an
+// arena of its own.
+
+// index type of every arena's index buffer. Indices only count from their mesh's first vertex, so
+// 16 bits are enough for any mesh up to ARENA_MAX_MESH_VERTICES, however large the arena grows.
+typedef uint16_t ArenaIndex;
+const GLenum ARENA_INDEX_TYPE = GL_UNSIGNED_SHORT;
+const size_t ARENA_MAX_MESH_VERTICES = 65536;
+
+// where one mesh lives in a GeometryArena
+struct MeshRange
+{
+    GLint baseVertex = 0;       // first vertex of the mesh in the vertex buffer
+    size_t firstIndex = 0;      // first index of the mesh in the index buffer
+    GLsizei indexCount = 0;
+    glm::vec2 scale = glm::vec2(1.0f);  // PackedMesh::scale, for shader.vs's vertexScale
+    glm::vec4 bounds = glm::vec4(0.0f); // bounding sphere, left to the caller (see boundingSphere)
+
+    // byte offset of the first index, as glDrawElementsBaseVertex takes it
+    const void* indexOffset() const
+    {
+        return (const void*)(firstIndex * sizeof(ArenaIndex));
+    }
+};
+
+class GeometryArena
+{
+public:
+    // appends mesh, drawn through indices relative to its first vertex (every vertex in order when
+    // indices is empty; see optimizeMesh for building them); call before upload(). A mesh with more
+    // than ARENA_MAX_MESH_VERTICES vertices is reported and gets an empty range.
+    MeshRange add(const PackedMesh& mesh, const std::vector<ArenaIndex>& indices = std::vector<ArenaIndex>())
+    {
+        MeshRange range;
+        if (mesh.vertices.size() > ARENA_MAX_MESH_VERTICES)
+        {
+            std::cout << "ERROR::GEOMETRY_ARENA::MESH_TOO_LARGE: " << mesh.vertices.size() << " vertices" << std::endl;
+            return range;
+        }
+        range.baseVertex = static_cast<GLint>(vertices.size());
+        range.firstIndex = this->indices.size();
+        range.scale = mesh.scale;
+        vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+        if (indices.empty())
+        {
+            for (size_t i = 0; i < mesh.vertices.size(); ++i)
+                this->indices.push_back(static_cast<ArenaIndex>(i));
+        }
+        else
+            this->indices.insert(this->indices.end(), indices.begin(), indices.end());
+        range.indexCount = static_cast<GLsizei>(this->indices.size() - range.firstIndex);
+        return range;
+    }
+
+    // sends the arena to the GPU once every mesh is added, and releases the CPU copy
+    void upload()
+    {
+        glGenVertexArrays(1, &vertexArray);
+        glGenBuffers(1, &vertexBuffer);
+        glGenBuffers(1, &indexBuffer);
+        glBindVertexArray(vertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(PackedVertex), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(ArenaIndex), indices.data(), GL_STATIC_DRAW);
+        // every attribute, the layer included: meshes without one read layer 0
+        setPackedVertexAttributes();
+        glBindVertexArray(0);
+
+        uploadedVertexBytes = vertices.size() * sizeof(PackedVertex);
+        uploadedIndexBytes = indices.size() * sizeof(ArenaIndex);
+        std::vector<PackedVertex>().swap(vertices);
+        std::vector<ArenaIndex>().swap(this->indices);
+    }
+
+    // makes the arena's vertex array current, for drawing any of its meshes
+    void bind() const
+    {
+        glBindVertexArray(vertexArray);
+    }
+
+    size_t vertexBytes() const
+    {
+        return uploadedVertexBytes;
+    }
+
+    size_t indexBytes() const
+    {
+        return uploadedIndexBytes;
+    }
+
+    void destroy()
+    {
+        glDeleteVertexArrays(1, &vertexArray);
+        glDeleteBuffers(1, &vertexBuffer);
+        glDeleteBuffers(1, &indexBuffer);
+        vertexArray = vertexBuffer = indexBuffer = 0;
+    }
+
+private:
+    GLuint vertexArray = 0;
+    GLuint vertexBuffer = 0;
+    GLuint indexBuffer = 0;
+    std::vector<PackedVertex> vertices;     // staged until upload()
+    std::vector<ArenaIndex> indices;
+    size_t uploadedVertexBytes = 0;
+    size_t uploadedIndexBytes = 0;
+};
+#endif
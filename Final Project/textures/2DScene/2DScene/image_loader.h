@@ -0,0 +1,107 @@
+#ifndef IMAGE_LOADER_H
+#define IMAGE_LOADER_H
+
+#include "stb_image.h"
+
+#include <decode_arena.h>
+#include <mapped_file.h>
+#include <thread_pool.h>
+
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// JPEGs of at least this many pixels are decoded on several threads once useDecodePool() is set
+const int PARALLEL_DECODE_PIXELS = 1024 * 1024;
+
+// power-of-two factor a width x height image has to be reduced by for neither side to exceed
+// maxSize; 1 when it already fits or maxSize is 0
+inline int imageReductionFor(int width, int height, int maxSize)
+{
+    int factor = 1;
+    int largest = width > height ? width : height;
+    while (maxSize > 0 && factor < (1 << 30) && (largest + factor - 1) / factor > maxSize)
+        factor *= 2;
+    return factor;
+}
+
+// the part of imageReductionFor(width, height, maxSize) stb_image can do while decoding an image
+// held in memory (JPEGs only; see stbi_load_from_memory_scaled), for passing as its scale
+inline int decodeScaleFor(const unsigned char* bytes, size_t size, int maxSize)
+{
+    int width, height, channels;
+    if (maxSize <= 0 || size > static_cast<size_t>(INT_MAX)
+        || !stbi_info_from_memory(bytes, static_cast<int>(size), &width, &height, &channels))
+        return 1;
+    int factor = imageReductionFor(width, height, maxSize);
+    return factor < 8 ? factor : 8;
+}
+
+// scratch memory stb_image needs to decode an image held in memory at 1/scale size, going by its
+// header: a JPEG's planes and (if progressive, which the header does not tell) full-size
+// coefficients, or a PNG's compressed data. Anything beyond it comes from the heap.
+inline size_t decodeScratchBytes(const unsigned char* bytes, size_t size, int scale)
+{
+    const size_t slack = 256 * 1024; // decoder state and row buffers
+    int width, height, channels;
+    if (size > static_cast<size_t>(INT_MAX) || !stbi_info_from_memory(bytes, static_cast<int>(size), &width, &height, &channels))
+        return slack;
+    if (size >= 2 && bytes[0] == 0xFF && bytes[1] == 0xD8)
+    {
+        size_t blocks = static_cast<size_t>(width + 16) * (height + 16) * channels;
+        return blocks / (static_cast<size_t>(scale) * scale) + blocks * 2 + static_cast<size_t>(width + 3) * channels * 32 + slack;
+    }
+    if (size >= 8 && std::memcmp(bytes, "\x89PNG", 4) == 0)
+        return size * 2 + slack; // the IDAT chunks, gathered into a buffer that doubles as it grows
+    return slack;
+}
+
+// stbi_load_from_memory_scaled with stb_image's scratch memory taken from the calling thread's
+// decode arena (see decode_arena.h), sized by decodeScratchBytes and dropped when it returns. The
+// pixels are ordinary heap memory to free with stbi_image_free on any thread.
+inline unsigned char* decodeImage(const unsigned char* bytes, size_t size, int* width, int* height, int* channels, int desiredChannels, int scale = 1)
+{
+    if (size > static_cast<size_t>(INT_MAX))
+        return nullptr;
+    DecodeArenaScope scratch(decodeScratchBytes(bytes, size, scale));
+    unsigned char* pixels = stbi_load_from_memory_scaled(bytes, static_cast<int>(size), width, height, channels, desiredChannels, scale);
+    if (!pixels)
+        return nullptr;
+    return scratch.keep(pixels, static_cast<size_t>(*width) * *height * (desiredChannels ? desiredChannels : *channels));
+}
+
+// Decodes an image file with stb_image straight from a memory mapping of it rather than through
+// stbi_load's stdio reads: the decoder walks the page cache with no intermediate FILE buffer or
+// copy, the OS is told to read the file ahead in one sequential pass, and threads decoding
+// several files share the cached pages. Flipping follows stbi_set_flip_vertically_on_load(_thread)
+// as usual. With a maxSize a JPEG larger than it is decoded at 1/2, 1/4 or 1/8 size (see
+// decodeScaleFor), so the result can still be larger than maxSize. Returns pixels to free with
+// stbi_image_free, or null if the file cannot be mapped or decoded.
+inline unsigned char* loadImageMapped(const std::string& path, int* width, int* height, int* channels, int desiredChannels, int maxSize = 0)
+{
+    MappedFile file;
+    if (!file.open(path, MappedFile::ACCESS_SEQUENTIAL) || file.size() > static_cast<size_t>(INT_MAX))
+        return nullptr;
+    return decodeImage(file.data(), file.size(), width, height, channels, desiredChannels, decodeScaleFor(file.data(), file.size(), maxSize));
+}
+
+// lets stb_image spread each large JPEG decode over pool (see stbi_set_jpeg_parallel): restart
+// intervals are entropy decoded concurrently and color conversion runs in bands of rows. Decodes
+// already running on the pool stay safe, since the decoding thread works through the pieces too.
+// Pass null, with no decode in flight, before the pool goes away.
+inline void useDecodePool(ThreadPool* pool)
+{
+    struct Trampoline
+    {
+        static void run(stbi_parallel_task* task, void* data, int count, void* user)
+        {
+            static_cast<ThreadPool*>(user)->parallelFor(count, [task, data](int index) { task(data, index); });
+        }
+    };
+    if (pool)
+        stbi_set_jpeg_parallel(Trampoline::run, pool, PARALLEL_DECODE_PIXELS);
+    else
+        stbi_set_jpeg_parallel(nullptr, nullptr, 0);
+}
+#endif
@@ -1,11 +1,16 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
+layout (location = 0) in vec3 aPos;      // packed position (vertex_format.h), / vertexScale
+
+// leading members of the FrameBlock in shader.fs; std140 gives them the same offsets
+layout (std140) uniform FrameBlock {
+    mat4 view;
+    mat4 projection;
+};
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform float vertexScale;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = projection * view * model * vec4(aPos * vertexScale, 1.0);
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#ifndef MATERIAL_BLOCK_H
+#define MATERIAL_BLOCK_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// C++ mirror of the std140 "MaterialBlock" uniform block in shader.fs: the surface constants of
+// one draw. Object color used to be copied into every vertex; it lives here now, so meshes carry
+// only geometry and one vertex buffer can be drawn in any material.
+
+// Binding point the MaterialBlock buffer is attached to (FrameBlock has 0)
+const GLuint MATERIAL_BLOCK_BINDING = 1;
+
+struct MaterialBlock
+{
+    glm::vec4 color;        // multiplies the texture color
+    glm::vec3 specular;
+    float shininess;        // fills the tail of the vec3
+};
+
+static_assert(offsetof(MaterialBlock, specular) == 16, "MaterialBlock.specular must match its std140 offset");
+static_assert(offsetof(MaterialBlock, shininess) == 28, "MaterialBlock.shininess must match its std140 offset");
+static_assert(sizeof(MaterialBlock) == 32, "MaterialBlock must match its std140 size");
+
+// One uniform buffer holding every material of the scene, one slot each, uploaded once. Choosing
+// a draw's material is a glBindBufferRange, not a uniform upload.
+class MaterialUniformBuffer
+{
+public:
+    unsigned int ID = 0;
+
+    void create(const std::vector<MaterialBlock>& materials)
+    {
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        slotStride = (sizeof(MaterialBlock) + alignment - 1) / alignment * alignment;
+        std::vector<unsigned char> staging(slotStride * materials.size(), 0);
+        for (size_t i = 0; i < materials.size(); ++i)
+            std::memcpy(&staging[i * slotStride], &materials[i], sizeof(MaterialBlock));
+
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_UNIFORM_BUFFER, ID);
+        glBufferData(GL_UNIFORM_BUFFER, staging.size(), staging.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // makes slot the material the following draws use
+    void bind(int slot) const
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, MATERIAL_BLOCK_BINDING, ID, slot * slotStride, sizeof(MaterialBlock));
+    }
+
+    void destroy()
+    {
+        glDeleteBuffers(1, &ID);
+        ID = 0;
+    }
+
+private:
+    size_t slotStride = 0;
+};
+#endif
@@ -0,0 +1,222 @@
+#ifndef MESH_GENERATOR_BENCHMARK_H
+#define MESH_GENERATOR_BENCHMARK_H
+
+#include <mesh_generators.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Microbenchmark for the generators in mesh_generators.h (run the scene with --benchmark-meshes).
+// Each generator is timed against the version it replaced, which grew its vector one push_back at
+// a time and called cos/sin for every vertex, at tessellations from 20 to a million segments. For
+// the sphere and the plane a segment is one cell of their grid, so both sides of the grid are
+// about the square root of the count. Both versions must give the same vertices to within float
+// rounding of the angles.
+
+namespace mesh_generator_benchmark_detail
+{
+    const float PI = 3.14159265f;
+
+    // the generators as they were before mesh_generators.h
+    inline std::vector<float> referenceCylSideVerts(int sides, float height, float radius)
+    {
+        std::vector<float> vertices;
+        float angleStep = 2.0f * PI / sides;
+        float halfHeight = height / 2.0f;
+        for (int i = 0; i <= sides; ++i)
+        {
+            float angle = i * angleStep;
+            float x = radius * cos(angle);
+            float z = radius * sin(angle);
+            float u = static_cast<float>(i) / static_cast<float>(sides);
+            for (float y : { -halfHeight, halfHeight })
+            {
+                vertices.push_back(x);
+                vertices.push_back(y);
+                vertices.push_back(z);
+                vertices.push_back(x);
+                vertices.push_back(0.0f);
+                vertices.push_back(z);
+                vertices.push_back(u);
+                vertices.push_back(y > 0.0f ? 1.0f : 0.0f);
+            }
+        }
+        return vertices;
+    }
+
+    inline std::vector<float> referenceCylTopVerts(int sides, float height, float radius)
+    {
+        std::vector<float> vertices;
+        float angleStep = 2.0f * PI / sides;
+        float halfHeight = height / 2.0f;
+        for (int i = 0; i < sides; ++i)
+        {
+            float angle = i * angleStep;
+            float x = radius * cos(angle);
+            float z = radius * sin(angle);
+            vertices.push_back(x);
+            vertices.push_back(halfHeight);
+            vertices.push_back(z);
+            vertices.push_back(0.0f);
+            vertices.push_back(1.0f);
+            vertices.push_back(0.0f);
+            vertices.push_back(0.5f + 0.5f * cos(angle));
+            vertices.push_back(0.5f + 0.5f * sin(angle));
+        }
+        vertices.insert(vertices.end(), { 0.0f, halfHeight, 0.0f, 0.0f, 1.0f, 0.0f, 0.5f, 0.5f });
+        return vertices;
+    }
+
+    inline std::vector<float> referenceSphereVerts(float radius, int rings, int segments)
+    {
+        std::vector<float> vertices;
+        for (int i = 0; i <= rings; ++i)
+        {
+            float phi = static_cast<float>((-PI / 2.0f) + PI * i / rings);
+            for (int j = 0; j <= segments; ++j)
+            {
+                float theta = static_cast<float>(2 * PI) * j / segments;
+                float x = radius * std::cos(phi) * std::cos(theta);
+                float y = radius * std::sin(phi);
+                float z = radius * std::cos(phi) * std::sin(theta);
+                vertices.push_back(x);
+                vertices.push_back(y);
+                vertices.push_back(z);
+                vertices.push_back(x / radius);
+                vertices.push_back(y / radius);
+                vertices.push_back(z / radius);
+                vertices.push_back(static_cast<float>(j) / segments);
+                vertices.push_back(static_cast<float>(i) / rings);
+            }
+        }
+        return vertices;
+    }
+
+    // walks the grid with a float accumulator, so its size drifts from sections x sections
+    inline std::vector<float> referencePlaneVerts(int sections)
+    {
+        std::vector<float> vertices;
+        float step = 2.0f / sections;
+        for (float x = 1.0f; x > -1.0f; x -= step)
+        {
+            for (float z = 1.0f; z >= -1.0f; z -= step)
+            {
+                vertices.insert(vertices.end(), {
+                    x, 0.0f, z, 0.0f, 1.0f, 0.0f, 2.0f, 0.0f,
+                    x - step, 0.0f, z, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+                    x, 0.0f, z - step, 0.0f, 1.0f, 0.0f, 2.0f, 2.0f,
+                    x - step, 0.0f, z - step, 0.0f, 1.0f, 0.0f, 0.0f, 2.0f,
+                    x - step, 0.0f, z, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+                    x, 0.0f, z - step, 0.0f, 1.0f, 0.0f, 2.0f, 2.0f });
+            }
+        }
+        return vertices;
+    }
+
+    // seconds per call of generate, the fastest of 5 runs, each repeating it until about two million
+    // vertices were written so small tessellations are not lost in timer resolution
+    inline double timeGenerator(const std::function<std::vector<float>()>& generate, std::vector<float>& result)
+    {
+        result = generate();
+        size_t repeats = std::max<size_t>(1, 2000000 / std::max<size_t>(1, result.size() / VERTEX_FLOATS));
+        double best = 1e30;
+        for (int run = 0; run < 5; ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < repeats; ++r)
+                result = generate();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeats);
+        }
+        return best;
+    }
+
+    // largest difference between two vertex arrays of the same size
+    inline float maxDifference(const std::vector<float>& a, const std::vector<float>& b)
+    {
+        float largest = 0.0f;
+        for (size_t i = 0; i < a.size(); ++i)
+            largest = std::max(largest, std::fabs(a[i] - b[i]));
+        return largest;
+    }
+}
+
+// prints the before/after table to out; false if a generator disagrees with the one it replaced
+inline bool benchmarkMeshGenerators(std::ostream& out)
+{
+    using namespace mesh_generator_benchmark_detail;
+    const int SEGMENT_COUNTS[] = { 20, 100, 1000, 10000, 100000, 1000000 };
+    const float TOLERANCE = 1e-5f;
+
+    struct Generator
+    {
+        const char* name;
+        std::function<std::vector<float>(int)> before;
+        std::function<std::vector<float>(int)> after;
+        bool grid;  // segments are the cells of a square grid
+        bool comparable;
+    };
+    const Generator generators[] = {
+        { "cylinder side", [](int n) { return referenceCylSideVerts(n, 1.0f, 1.0f); },
+            [](int n) { return genCylSideVerts(n, 1.0f, 1.0f); }, false, true },
+        { "cylinder top", [](int n) { return referenceCylTopVerts(n, 1.0f, 1.0f); },
+            [](int n) { return genCylTopVerts(n, 1.0f, 1.0f); }, false, true },
+        { "sphere", [](int n) { return referenceSphereVerts(1.0f, n, n); },
+            [](int n) { return genSphereVerts(1.0f, n, n); }, true, true },
+        // the old plane's size drifts with the accumulator, so only its speed is compared
+        { "plane", [](int n) { return referencePlaneVerts(n); },
+            [](int n) { return genPlaneVerts(n); }, true, false },
+    };
+
+    bool matched = true;
+    out << "Mesh generator time per mesh in microseconds, fastest of 5 runs" << std::endl;
+    out << "  " << std::left << std::setw(16) << "mesh" << std::right << std::setw(10) << "segments" << std::setw(12) << "grid"
+        << std::setw(12) << "vertices" << std::setw(14) << "before" << std::setw(14) << "after" << std::setw(10) << "speedup"
+        << std::setw(12) << "max diff" << std::endl;
+    for (const Generator& generator : generators)
+    {
+        for (int segments : SEGMENT_COUNTS)
+        {
+            int n = generator.grid ? std::max(1, static_cast<int>(std::lround(std::sqrt(static_cast<double>(segments))))) : segments;
+            std::vector<float> before, after;
+            double beforeSeconds = timeGenerator([&] { return generator.before(n); }, before);
+            double afterSeconds = timeGenerator([&] { return generator.after(n); }, after);
+
+            std::string difference = "-";
+            if (generator.comparable)
+            {
+                if (before.size() != after.size())
+                {
+                    out << "ERROR::MESH_GENERATORS::SIZE_MISMATCH: " << generator.name << " " << n << std::endl;
+                    matched = false;
+                }
+                else
+                {
+                    float largest = maxDifference(before, after);
+                    if (largest > TOLERANCE)
+                    {
+                        out << "ERROR::MESH_GENERATORS::MISMATCH: " << generator.name << " " << n << " differs by " << largest << std::endl;
+                        matched = false;
+                    }
+                    std::ostringstream text;
+                    text << std::scientific << std::setprecision(1) << largest;
+                    difference = text.str();
+                }
+            }
+            std::string grid = generator.grid ? std::to_string(n) + "x" + std::to_string(n) : "";
+            out << "  " << std::left << std::setw(16) << generator.name << std::right << std::setw(10) << segments << std::setw(12) << grid
+                << std::setw(12) << after.size() / VERTEX_FLOATS << std::fixed << std::setprecision(2)
+                << std::setw(14) << beforeSeconds * 1e6 << std::setw(14) << afterSeconds * 1e6
+                << std::setw(9) << beforeSeconds / afterSeconds << "x" << std::setw(12) << difference << std::endl;
+        }
+    }
+    return matched;
+}
+#endif
@@ -0,0 +1,475 @@
+#ifndef MESH_GENERATORS_H
+#define MESH_GENERATORS_H
+
+#include <cpu_features.h>
+#include <vertex_format.h>
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Parametric meshes, as VERTEX_FLOATS-float vertices (position, normal, texture coordinates).
+//
+// Every generator has a write...Verts form that fills a caller-provided buffer of
+// ...VertexCount(...) vertices and a gen...Verts form that returns a vector sized once, so nothing
+// grows while vertices are written. Angles advance by rotating (cos, sin) one step at a time
+// instead of calling std::cos/std::sin per vertex, and the SSE2 path builds four vertices at once
+// (one per lane) and transposes them into place. Tessellations of a million segments or more are
+// expected: the scenes that generate these at runtime are timed with --benchmark-meshes.
+
+namespace mesh_generators_detail
+{
+    const double TWO_PI = 6.283185307179586;
+
+    // cos and sin of start + i * step for i = 0, 1, 2, ...: a rotation by step per value, in double
+    // precision and re-anchored on std::cos/std::sin every RESYNC values, so even a million steps
+    // stay within float rounding of the exact angles
+    class AngleStepper
+    {
+    public:
+        AngleStepper(double start, double step) : start(start), step(step), cosStep(std::cos(step)), sinStep(std::sin(step))
+        {
+            seek(0);
+        }
+
+        // the next count values
+        void next(float* cosines, float* sines, int count)
+        {
+            for (int k = 0; k < count; ++k)
+            {
+                cosines[k] = static_cast<float>(cosValue);
+                sines[k] = static_cast<float>(sinValue);
+                if (++index % RESYNC == 0)
+                    seek(index);
+                else
+                {
+                    double rotated = cosValue * cosStep - sinValue * sinStep;
+                    sinValue = sinValue * cosStep + cosValue * sinStep;
+                    cosValue = rotated;
+                }
+            }
+        }
+
+    private:
+        static const size_t RESYNC = 4096;
+
+        double start, step, cosStep, sinStep;
+        double cosValue = 1.0, sinValue = 0.0;
+        size_t index = 0;
+
+        void seek(size_t i)
+        {
+            double angle = start + static_cast<double>(i) * step;
+            cosValue = std::cos(angle);
+            sinValue = std::sin(angle);
+            index = i;
+        }
+    };
+
+    inline void writeVertex(float* out, float px, float py, float pz, float nx, float ny, float nz, float u, float v)
+    {
+        out[0] = px;
+        out[1] = py;
+        out[2] = pz;
+        out[3] = nx;
+        out[4] = ny;
+        out[5] = nz;
+        out[6] = u;
+        out[7] = v;
+    }
+
+#if defined(SIMD_SSE2)
+    // writes four vertices, stride floats apart, from their components in lanes: a0..a3 are
+    // position x, y, z and normal x, b0..b3 normal y, z and texture u, v
+    inline void storeVertices4(float* out, size_t stride, __m128 a0, __m128 a1, __m128 a2, __m128 a3, __m128 b0, __m128 b1, __m128 b2, __m128 b3)
+    {
+        _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+        _MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+        _mm_storeu_ps(out, a0);
+        _mm_storeu_ps(out + 4, b0);
+        _mm_storeu_ps(out + stride, a1);
+        _mm_storeu_ps(out + stride + 4, b1);
+        _mm_storeu_ps(out + 2 * stride, a2);
+        _mm_storeu_ps(out + 2 * stride + 4, b2);
+        _mm_storeu_ps(out + 3 * stride, a3);
+        _mm_storeu_ps(out + 3 * stride + 4, b3);
+    }
+
+    // i / count in four lanes, rounded the way the scalar division is
+    inline __m128 fractions4(int i, int count)
+    {
+        return _mm_div_ps(_mm_cvtepi32_ps(_mm_setr_epi32(i, i + 1, i + 2, i + 3)), _mm_set1_ps(static_cast<float>(count)));
+    }
+#endif
+
+    // ring of sides vertices at height y facing (0, normalY, 0), then its center, for a triangle fan
+    inline void writeCapVerts(float* out, int sides, float radius, float y, float normalY)
+    {
+        AngleStepper angle(0.0, TWO_PI / sides);
+        int i = 0;
+#if defined(SIMD_SSE2)
+        const __m128 radius4 = _mm_set1_ps(radius), half = _mm_set1_ps(0.5f), zero = _mm_setzero_ps();
+        const __m128 y4 = _mm_set1_ps(y), normalY4 = _mm_set1_ps(normalY);
+        for (; i + 4 <= sides; i += 4)
+        {
+            float c[4], s[4];
+            angle.next(c, s, 4);
+            __m128 cosines = _mm_loadu_ps(c), sines = _mm_loadu_ps(s);
+            storeVertices4(out + static_cast<size_t>(i) * VERTEX_FLOATS, VERTEX_FLOATS,
+                _mm_mul_ps(radius4, cosines), y4, _mm_mul_ps(radius4, sines), zero,
+                normalY4, zero, _mm_add_ps(half, _mm_mul_ps(half, cosines)), _mm_add_ps(half, _mm_mul_ps(half, sines)));
+        }
+#endif
+        for (; i < sides; ++i)
+        {
+            float c, s;
+            angle.next(&c, &s, 1);
+            writeVertex(out + static_cast<size_t>(i) * VERTEX_FLOATS, radius * c, y, radius * s, 0.0f, normalY, 0.0f, 0.5f + 0.5f * c, 0.5f + 0.5f * s);
+        }
+        writeVertex(out + static_cast<size_t>(sides) * VERTEX_FLOATS, 0.0f, y, 0.0f, 0.0f, normalY, 0.0f, 0.5f, 0.5f);
+    }
+}
+
+inline size_t cylSideVertexCount(int sides)
+{
+    return sides > 0 ? 2 * static_cast<size_t>(sides + 1) : 0;
+}
+
+// Side of a cylinder centered on the origin, as a triangle strip: for each of the sides + 1 angles
+// (the last repeats the first with u = 1) a bottom and then a top vertex. Normals are the radial
+// vector (x, 0, z), unnormalized.
+inline void writeCylSideVerts(float* out, int sides, float height, float radius)
+{
+    using namespace mesh_generators_detail;
+    if (sides <= 0)
+        return;
+    float halfHeight = height / 2.0f;
+    AngleStepper angle(0.0, TWO_PI / sides);
+    const size_t pairStride = 2 * VERTEX_FLOATS;
+    int i = 0;
+#if defined(SIMD_SSE2)
+    const __m128 radius4 = _mm_set1_ps(radius), zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    const __m128 bottom = _mm_set1_ps(-halfHeight), top = _mm_set1_ps(halfHeight);
+    for (; i + 4 <= sides + 1; i += 4)
+    {
+        float c[4], s[4];
+        angle.next(c, s, 4);
+        __m128 x = _mm_mul_ps(radius4, _mm_loadu_ps(c)), z = _mm_mul_ps(radius4, _mm_loadu_ps(s));
+        __m128 u = fractions4(i, sides);
+        float* pair = out + static_cast<size_t>(i) * pairStride;
+        storeVertices4(pair, pairStride, x, bottom, z, x, zero, z, u, zero);
+        storeVertices4(pair + VERTEX_FLOATS, pairStride, x, top, z, x, zero, z, u, one);
+    }
+#endif
+    for (; i <= sides; ++i)
+    {
+        float c, s;
+        angle.next(&c, &s, 1);
+        float x = radius * c, z = radius * s;
+        float u = static_cast<float>(i) / static_cast<float>(sides);
+        float* pair = out + static_cast<size_t>(i) * pairStride;
+        writeVertex(pair, x, -halfHeight, z, x, 0.0f, z, u, 0.0f);
+        writeVertex(pair + VERTEX_FLOATS, x, halfHeight, z, x, 0.0f, z, u, 1.0f);
+    }
+}
+
+// Function to generate the side vertices of a cylinder
+inline std::vector<float> genCylSideVerts(int sides, float height, float radius)
+{
+    std::vector<float> vertices(cylSideVertexCount(sides) * VERTEX_FLOATS);
+    writeCylSideVerts(vertices.data(), sides, height, radius);
+    return vertices;
+}
+
+inline size_t cylCapVertexCount(int sides)
+{
+    return sides > 0 ? static_cast<size_t>(sides) + 1 : 0;
+}
+
+// Top of a cylinder: sides vertices around the rim, then the center (see genCylTopIndices)
+inline void writeCylTopVerts(float* out, int sides, float height, float radius)
+{
+    if (sides > 0)
+        mesh_generators_detail::writeCapVerts(out, sides, radius, height / 2.0f, 1.0f);
+}
+
+// Function to generate the top vertices of a cylinder
+inline std::vector<float> genCylTopVerts(int sides, float height, float radius)
+{
+    std::vector<float> vertices(cylCapVertexCount(sides) * VERTEX_FLOATS);
+    writeCylTopVerts(vertices.data(), sides, height, radius);
+    return vertices;
+}
+
+// Bottom of a cylinder, laid out like the top
+inline void writeCylBottomVerts(float* out, int sides, float height, float radius)
+{
+    if (sides > 0)
+        mesh_generators_detail::writeCapVerts(out, sides, radius, -height / 2.0f, -1.0f);
+}
+
+// Function to generate the bottom vertices of a cylinder
+inline std::vector<float> genCylBottomVerts(int sides, float height, float radius)
+{
+    std::vector<float> vertices(cylCapVertexCount(sides) * VERTEX_FLOATS);
+    writeCylBottomVerts(vertices.data(), sides, height, radius);
+    return vertices;
+}
+
+// Function to generate a cylinder's bottom indices
+inline std::vector<unsigned int> genCylBottomIndices(int sides)
+{
+    std::vector<unsigned int> indices(sides > 0 ? static_cast<size_t>(sides) * 3 : 0);
+    for (int i = 0; i < sides; ++i)
+    {
+        // Triangle fan indices
+        indices[i * 3] = i;
+        indices[i * 3 + 1] = (i + 1) % sides;
+        indices[i * 3 + 2] = sides; // Center point
+    }
+    return indices;
+}
+
+// Function to generate a cylinder's top indices
+inline std::vector<unsigned int> genCylTopIndices(int sides)
+{
+    return genCylBottomIndices(sides);
+}
+
+inline size_t sphereVertexCount(int rings, int segments)
+{
+    return rings > 0 && segments > 0 ? static_cast<size_t>(rings + 1) * (segments + 1) : 0;
+}
+
+// Sphere centered on the origin: rings + 1 rows from the south pole up, each of segments + 1
+// vertices (the last repeats the first with u = 1). The angles around the axis are the same for
+// every row, so their cos/sin are worked out once.
+inline void writeSphereVerts(float* out, float radius, int rings, int segments)
+{
+    using namespace mesh_generators_detail;
+    if (rings <= 0 || segments <= 0)
+        return;
+    std::vector<float> thetaCos(segments + 1), thetaSin(segments + 1);
+    AngleStepper theta(0.0, TWO_PI / segments);
+    theta.next(thetaCos.data(), thetaSin.data(), segments + 1);
+    AngleStepper phi(-TWO_PI / 4.0, TWO_PI / 2.0 / rings);
+
+    const size_t rowFloats = static_cast<size_t>(segments + 1) * VERTEX_FLOATS;
+    for (int i = 0; i <= rings; ++i)
+    {
+        float cosPhi, sinPhi;
+        phi.next(&cosPhi, &sinPhi, 1);
+        float y = radius * sinPhi;
+        float v = static_cast<float>(i) / static_cast<float>(rings);
+        float* row = out + static_cast<size_t>(i) * rowFloats;
+        int j = 0;
+#if defined(SIMD_SSE2)
+        const __m128 cosPhi4 = _mm_set1_ps(cosPhi), radius4 = _mm_set1_ps(radius);
+        const __m128 y4 = _mm_set1_ps(y), normalY = _mm_set1_ps(sinPhi), v4 = _mm_set1_ps(v);
+        for (; j + 4 <= segments + 1; j += 4)
+        {
+            __m128 normalX = _mm_mul_ps(cosPhi4, _mm_loadu_ps(&thetaCos[j]));
+            __m128 normalZ = _mm_mul_ps(cosPhi4, _mm_loadu_ps(&thetaSin[j]));
+            storeVertices4(row + static_cast<size_t>(j) * VERTEX_FLOATS, VERTEX_FLOATS,
+                _mm_mul_ps(radius4, normalX), y4, _mm_mul_ps(radius4, normalZ), normalX,
+                normalY, normalZ, fractions4(j, segments), v4);
+        }
+#endif
+        for (; j <= segments; ++j)
+        {
+            float normalX = cosPhi * thetaCos[j], normalZ = cosPhi * thetaSin[j];
+            float u = static_cast<float>(j) / static_cast<float>(segments);
+            writeVertex(row + static_cast<size_t>(j) * VERTEX_FLOATS, radius * normalX, y, radius * normalZ, normalX, sinPhi, normalZ, u, v);
+        }
+    }
+}
+
+// Function for generating a sphere's vertices
+inline std::vector<float> genSphereVerts(float radius, int rings, int segments)
+{
+    std::vector<float> vertices(sphereVertexCount(rings, segments) * VERTEX_FLOATS);
+    writeSphereVerts(vertices.data(), radius, rings, segments);
+    return vertices;
+}
+
+// Function for generating a sphere's indices
+inline std::vector<unsigned int> genSphereIndices(int rings, int segments)
+{
+    std::vector<unsigned int> indices;
+    indices.reserve(rings > 0 && segments > 0 ? static_cast<size_t>(rings) * segments * 6 : 0);
+
+    // Generate indices for rendering triangles
+    for (int i = 0; i < rings; ++i) {
+        for (int j = 0; j < segments; ++j) {
+            int current = i * (segments + 1) + j;
+            int next = current + segments + 1;
+
+            // Define two triangles using indices
+            indices.push_back(current);
+            indices.push_back(current + 1);
+            indices.push_back(next);
+
+            indices.push_back(current + 1);
+            indices.push_back(next + 1);
+            indices.push_back(next);
+        }
+    }
+
+    return indices;
+}
+
+// Function to generate a pyramid's vertices
+inline std::vector<float> genPyramidVerts(int sides, float height, float radius)
+{
+    std::vector<float> vertices;
+    vertices.reserve(sides > 0 ? static_cast<size_t>(sides) * 9 * VERTEX_FLOATS : 0); // three triangles per side
+
+    float angleIncrement = static_cast<float>(mesh_generators_detail::TWO_PI) / static_cast<float>(sides);
+
+    for (int i = 0; i < sides; ++i) {
+        // Calculate the coordinates for the base of the pyramid/cone
+        float x1 = radius * cos(i * angleIncrement);
+        float z1 = radius * sin(i * angleIncrement);
+        float x2 = radius * cos((i + 1) * angleIncrement);
+        float z2 = radius * sin((i + 1) * angleIncrement);
+
+        // Calculate normals for the side vertices using the parametric approach
+        float tangent1[3] = { x2 - x1, -height, z2 - z1 };
+        float tangent2[3] = { x1, height, z1 };
+        float normal[3] = {
+            tangent1[1] * tangent2[2] - tangent1[2] * tangent2[1],
+            tangent1[2] * tangent2[0] - tangent1[0] * tangent2[2],
+            tangent1[0] * tangent2[1] - tangent1[1] * tangent2[0]
+        };
+
+        // Normalize the normal vector
+        float normalLength = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        normal[0] /= normalLength;
+        normal[1] /= normalLength;
+        normal[2] /= normalLength;
+
+        // Calculate the texture coordinates for the sides
+        float u1 = static_cast<float>(i) / static_cast<float>(sides - 1); // Range [0, 1]
+        float u2 = static_cast<float>(i + 1) / static_cast<float>(sides - 1);
+
+        // Add vertices for the base triangle with texture coordinates
+        vertices.insert(vertices.end(), {
+            x1, -height / 2.0f, z1,
+            normal[0], normal[1], normal[2],
+            u1, 0.0f,
+
+            x2, -height / 2.0f, z2,
+            normal[0], normal[1], normal[2],
+            u2, 0.0f,
+
+            0.0f, -height / 2.0f, 0.0f,
+            0.0f, 0.0f, 0.0f,
+            0.5f, 0.5f
+            });
+
+        // Add vertices for the side triangle with texture coordinates
+        vertices.insert(vertices.end(), {
+            x1, -height / 2.0f, z1,
+            normal[0], normal[1], normal[2],
+            u1, 0.0f,
+
+            x2, -height / 2.0f, z2,
+            normal[0], normal[1], normal[2],
+            u2, 0.0f,
+
+            0.0f, height / 2.0f, 0.0f,
+            0.0f, 0.0f, 0.0f,
+            0.5f, 1.0f
+            });
+    }
+
+    // Add vertices for the base
+    for (int i = 0; i < sides; ++i) {
+        float x1 = radius * cos(i * angleIncrement);
+        float z1 = radius * sin(i * angleIncrement);
+        float x2 = radius * cos((i + 1) * angleIncrement);
+        float z2 = radius * sin((i + 1) * angleIncrement);
+
+        // Calculate normals for the base vertices
+        float baseNormal[] = { 0.0f, -1.0f, 0.0f };
+
+
+        // Calculate the texture coordinates for the base
+        float u1 = 0.5f + 0.5f * cos(i * angleIncrement);
+        float u2 = 0.5f + 0.5f * cos((i + 1) * angleIncrement);
+
+        // Add vertices for the base triangle with texture coordinates
+        vertices.insert(vertices.end(), {
+            x1, -height / 2.0f, z1,
+            baseNormal[0], baseNormal[1], baseNormal[2],
+            u1, 0.0f,
+
+            x2, -height / 2.0f, z2,
+            baseNormal[0], baseNormal[1], baseNormal[2],
+            u2, 0.0f,
+
+            0.0f, -height / 2.0f, 0.0f,
+            baseNormal[0], baseNormal[1], baseNormal[2],
+            0.5f, 0.5f
+            });
+    }
+
+    return vertices;
+}
+
+inline size_t planeVertexCount(int sections)
+{
+    return sections > 0 ? static_cast<size_t>(sections) * sections * 6 : 0;
+}
+
+// Flat square from -1 to 1 in x and z at y = 0, facing up, cut into sections x sections quads of
+// two triangles each. Every quad carries the whole texture twice over (u and v from 0 to 2).
+inline void writePlaneVerts(float* out, int sections)
+{
+    using namespace mesh_generators_detail;
+    if (sections <= 0)
+        return;
+    // quad edges, shared exactly by neighbouring quads
+    std::vector<float> edges(sections + 1);
+    for (int k = 0; k <= sections; ++k)
+        edges[k] = 1.0f - 2.0f * static_cast<float>(k) / static_cast<float>(sections);
+
+    // corners of a quad as offsets (0 = this edge, 1 = the next) and their texture coordinates
+    const int cornerX[6] = { 0, 1, 0, 1, 1, 0 };
+    const int cornerZ[6] = { 0, 0, 1, 1, 0, 1 };
+    const float cornerU[6] = { 2.0f, 0.0f, 2.0f, 0.0f, 0.0f, 2.0f };
+    const float cornerV[6] = { 0.0f, 0.0f, 2.0f, 2.0f, 0.0f, 2.0f };
+#if defined(SIMD_SSE2)
+    // everything after the position is the same for every quad
+    __m128 tails[6];
+    for (int c = 0; c < 6; ++c)
+        tails[c] = _mm_setr_ps(1.0f, 0.0f, cornerU[c], cornerV[c]);
+#endif
+
+    float* vertex = out;
+    for (int i = 0; i < sections; ++i)
+    {
+        for (int j = 0; j < sections; ++j)
+        {
+            for (int c = 0; c < 6; ++c, vertex += VERTEX_FLOATS)
+            {
+                float x = edges[i + cornerX[c]], z = edges[j + cornerZ[c]];
+#if defined(SIMD_SSE2)
+                _mm_storeu_ps(vertex, _mm_setr_ps(x, 0.0f, z, 0.0f));
+                _mm_storeu_ps(vertex + 4, tails[c]);
+#else
+                writeVertex(vertex, x, 0.0f, z, 0.0f, 1.0f, 0.0f, cornerU[c], cornerV[c]);
+#endif
+            }
+        }
+    }
+}
+
+// Function to generate a plane's vertices
+inline std::vector<float> genPlaneVerts(int sections)
+{
+    std::vector<float> vertices(planeVertexCount(sections) * VERTEX_FLOATS);
+    writePlaneVerts(vertices.data(), sections);
+    return vertices;
+}
+#endif
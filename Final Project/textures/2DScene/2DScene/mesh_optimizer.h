@@ -0,0 +1,291 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <geometry_arena.h>
+#include <vertex_format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <ostream>
+#include <vector>
+
+// Turns a triangle list of packed vertices into an indexed mesh ready for a GeometryArena:
+//   1. weld:     vertices that pack to the same bytes are stored once (a cube face's two triangles
+//                share two corners, so 6 vertices become 4)
+//   2. reorder:  triangles are sorted for the GPU's post-transform vertex cache with Tom Forsyth's
+//                "Linear-Speed Vertex Cache Optimisation", so a vertex shaded for one triangle is
+//                still cached when its neighbours use it
+//   3. fetch:    vertices are renumbered in the order the new triangles first use them, so the
+//                vertex fetch walks the buffer forwards
+// The cost is measured as ACMR (average cache miss ratio): vertices transformed per triangle, 3.0
+// for an unindexed list and around 0.5 to 0.7 for a well ordered regular grid. It is simulated on a
+// FIFO cache of VERTEX_CACHE_SIZE entries, which is close to what current GPUs behave like.
+
+// entries of the simulated cache ACMR is reported for
+const size_t VERTEX_CACHE_SIZE = 16;
+
+struct MeshOptimizerStats
+{
+    size_t verticesBefore = 0;
+    size_t verticesAfter = 0;
+    size_t triangles = 0;
+    double acmrBefore = 0.0;    // as drawn before, one vertex per corner
+    double acmrWelded = 0.0;    // welded, triangles still in their original order
+    double acmrAfter = 0.0;
+
+    // one line of the mesh report
+    void writeReport(std::ostream& out, const char* name) const
+    {
+        out << "  " << std::left << std::setw(12) << name << std::right
+            << std::setw(6) << verticesBefore << " -> " << std::setw(6) << verticesAfter << " vertices"
+            << std::setw(8) << triangles << " triangles"
+            << "  ACMR " << std::fixed << std::setprecision(3) << acmrBefore << " -> " << acmrAfter
+            << " (welded only " << acmrWelded << ")" << std::endl;
+    }
+};
+
+// vertices transformed per triangle when indices is drawn through a FIFO cache of cacheSize entries
+template <typename Index>
+inline double vertexCacheAcmr(const std::vector<Index>& indices, size_t vertexCount, size_t cacheSize = VERTEX_CACHE_SIZE)
+{
+    if (indices.size() < 3)
+        return 0.0;
+    // a vertex is cached while fewer than cacheSize misses came after its own
+    std::vector<size_t> missedAt(vertexCount, 0);
+    size_t misses = 0, time = cacheSize + 1;
+    for (Index index : indices)
+    {
+        if (time - missedAt[index] > cacheSize)
+        {
+            missedAt[index] = time++;
+            ++misses;
+        }
+    }
+    return static_cast<double>(misses) / (indices.size() / 3);
+}
+
+// stores each distinct vertex of mesh once and returns the triangle list indexing them
+inline std::vector<uint32_t> weldVertices(PackedMesh& mesh)
+{
+    std::vector<uint32_t> indices(mesh.vertices.size());
+    std::vector<PackedVertex> unique;
+    unique.reserve(mesh.vertices.size());
+
+    // open addressing on the vertex bytes; slots hold an index into unique, or EMPTY
+    const uint32_t EMPTY = 0xFFFFFFFFu;
+    size_t tableSize = 16;
+    while (tableSize < mesh.vertices.size() * 2)
+        tableSize *= 2;
+    std::vector<uint32_t> table(tableSize, EMPTY);
+    for (size_t i = 0; i < mesh.vertices.size(); ++i)
+    {
+        const PackedVertex& vertex = mesh.vertices[i];
+        // FNV-1a over the 16 bytes
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t b = 0; b < sizeof(PackedVertex); ++b)
+            hash = (hash ^ bytes[b]) * 1099511628211ULL;
+
+        size_t slot = static_cast<size_t>(hash) & (tableSize - 1);
+        while (table[slot] != EMPTY && std::memcmp(&unique[table[slot]], &vertex, sizeof(PackedVertex)) != 0)
+            slot = (slot + 1) & (tableSize - 1);
+        if (table[slot] == EMPTY)
+        {
+            table[slot] = static_cast<uint32_t>(unique.size());
+            unique.push_back(vertex);
+        }
+        indices[i] = table[slot];
+    }
+    mesh.vertices.swap(unique);
+    return indices;
+}
+
+// reorders the triangles of indices (over vertexCount vertices) for the post-transform cache with
+// Forsyth's algorithm: every step emits the unemitted triangle whose vertices score highest, where a
+// vertex scores for sitting near the front of a simulated LRU cache and for having few triangles
+// left (so stragglers are finished before they are evicted)
+inline std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount)
+{
+    const int CACHE_SIZE = 32;              // LRU size the scores are tuned for
+    const float CACHE_DECAY_POWER = 1.5f;
+    const float LAST_TRIANGLE_SCORE = 0.75f;
+    const float VALENCE_BOOST_SCALE = 2.0f;
+    const float VALENCE_BOOST_POWER = 0.5f;
+
+    size_t triangleCount = indices.size() / 3;
+    std::vector<uint32_t> result;
+    result.reserve(triangleCount * 3);
+    if (triangleCount == 0)
+        return result;
+
+    // the triangles of every vertex, as offsets into one array
+    std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+    for (uint32_t index : indices)
+        ++firstTriangle[index + 1];
+    for (size_t v = 0; v < vertexCount; ++v)
+        firstTriangle[v + 1] += firstTriangle[v];
+    std::vector<uint32_t> vertexTriangles(indices.size());
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);   // not yet emitted, first in each list
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            uint32_t v = indices[t * 3 + c];
+            vertexTriangles[firstTriangle[v] + liveTriangles[v]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    auto vertexScore = [&](size_t v)
+    {
+        if (liveTriangles[v] == 0)
+            return -1.0f;
+        float score = 0.0f;
+        int position = cachePosition[v];
+        if (position >= 0)
+        {
+            if (position < 3)
+                score = LAST_TRIANGLE_SCORE; // part of the triangle just emitted
+            else
+                score = std::pow(1.0f - (position - 3) / static_cast<float>(CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+        return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(liveTriangles[v]), -VALENCE_BOOST_POWER);
+    };
+
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        vertexScores[v] = vertexScore(v);
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; ++t)
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+
+    std::vector<uint32_t> cache, nextCache;
+    cache.reserve(CACHE_SIZE + 3);
+    nextCache.reserve(CACHE_SIZE + 3);
+    size_t scanFrom = 0;    // no triangle before this is left, for the fallback scan
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        // best triangle touching the cache; when the cache has none left, the best of all
+        size_t best = triangleCount;
+        float bestScore = -1.0f;
+        for (uint32_t v : cache)
+        {
+            for (uint32_t i = firstTriangle[v]; i < firstTriangle[v] + liveTriangles[v]; ++i)
+            {
+                uint32_t t = vertexTriangles[i];
+                if (triangleScores[t] > bestScore)
+                {
+                    bestScore = triangleScores[t];
+                    best = t;
+                }
+            }
+        }
+        if (best == triangleCount)
+        {
+            while (emitted[scanFrom])
+                ++scanFrom;
+            for (size_t t = scanFrom; t < triangleCount; ++t)
+            {
+                if (!emitted[t] && triangleScores[t] > bestScore)
+                {
+                    bestScore = triangleScores[t];
+                    best = t;
+                }
+            }
+        }
+
+        // emit it and take it out of its vertices' lists
+        emitted[best] = true;
+        nextCache.clear();
+        for (int c = 0; c < 3; ++c)
+        {
+            uint32_t v = indices[best * 3 + c];
+            result.push_back(v);
+            nextCache.push_back(v);
+            uint32_t* list = &vertexTriangles[firstTriangle[v]];
+            uint32_t* end = list + liveTriangles[v];
+            uint32_t* found = std::find(list, end, static_cast<uint32_t>(best));
+            *found = *(end - 1);
+            --liveTriangles[v];
+        }
+
+        // its vertices move to the front of the cache, everything else shifts back
+        for (uint32_t v : cache)
+        {
+            if (v != nextCache[0] && v != nextCache[1] && v != nextCache[2])
+                nextCache.push_back(v);
+        }
+        for (size_t i = 0; i < nextCache.size(); ++i)
+            cachePosition[nextCache[i]] = i < static_cast<size_t>(CACHE_SIZE) ? static_cast<int>(i) : -1;
+
+        // rescore what moved, and the triangles around it
+        for (uint32_t v : nextCache)
+        {
+            float score = vertexScore(v);
+            float delta = score - vertexScores[v];
+            vertexScores[v] = score;
+            if (delta == 0.0f)
+                continue;
+            for (uint32_t i = firstTriangle[v]; i < firstTriangle[v] + liveTriangles[v]; ++i)
+                triangleScores[vertexTriangles[i]] += delta;
+        }
+        if (nextCache.size() > static_cast<size_t>(CACHE_SIZE))
+            nextCache.resize(CACHE_SIZE);
+        cache.swap(nextCache);
+    }
+    return result;
+}
+
+// renumbers the vertices of mesh in the order indices first uses them, rewriting indices to match
+inline void optimizeVertexFetch(PackedMesh& mesh, std::vector<uint32_t>& indices)
+{
+    const uint32_t UNUSED = 0xFFFFFFFFu;
+    std::vector<uint32_t> remap(mesh.vertices.size(), UNUSED);
+    std::vector<PackedVertex> ordered;
+    ordered.reserve(mesh.vertices.size());
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == UNUSED)
+        {
+            remap[index] = static_cast<uint32_t>(ordered.size());
+            ordered.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices.swap(ordered);
+}
+
+// welds mesh (a triangle list, three vertices per triangle) and returns its cache-ordered indices;
+// stats, if given, receives the vertex counts and the ACMR before and after. A mesh left with more
+// vertices than an ArenaIndex can address is reported and comes back empty.
+inline std::vector<ArenaIndex> optimizeMesh(PackedMesh& mesh, MeshOptimizerStats* stats = nullptr)
+{
+    size_t verticesBefore = mesh.vertices.size();
+    std::vector<uint32_t> welded = weldVertices(mesh);
+    if (mesh.vertices.size() > ARENA_MAX_MESH_VERTICES)
+    {
+        std::cout << "ERROR::MESH_OPTIMIZER::TOO_MANY_VERTICES: " << mesh.vertices.size() << std::endl;
+        mesh.vertices.clear();
+        return std::vector<ArenaIndex>();
+    }
+    std::vector<uint32_t> ordered = optimizeVertexCache(welded, mesh.vertices.size());
+    optimizeVertexFetch(mesh, ordered);
+    if (stats)
+    {
+        stats->verticesBefore = verticesBefore;
+        stats->verticesAfter = mesh.vertices.size();
+        stats->triangles = ordered.size() / 3;
+        // unindexed, every corner is its own vertex and always misses
+        stats->acmrBefore = stats->triangles > 0 ? 3.0 : 0.0;
+        stats->acmrWelded = vertexCacheAcmr(welded, mesh.vertices.size());
+        stats->acmrAfter = vertexCacheAcmr(ordered, mesh.vertices.size());
+    }
+    return std::vector<ArenaIndex>(ordered.begin(), ordered.end());
+}
+#endif
@@ -0,0 +1,335 @@
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#include <cpu_features.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// CPU mip chain builder for 8-bit RGB/RGBA images with tightly packed rows.
+//
+// Colour channels are treated as sRGB: each 2x2 footprint is averaged in linear light and
+// re-encoded, so mips keep the brightness of the full-size image instead of darkening the way a
+// box filter on the stored bytes does. Alpha is averaged as is. Levels below the first are built
+// from the linear values of the level above rather than its rounded bytes. The kernels have
+// scalar, SSE2 and AVX2 versions chosen at runtime, and all produce the same bytes.
+
+// number of levels in a full chain down to 1x1
+inline int mipLevelCount(int width, int height)
+{
+    int levels = 1;
+    while (width > 1 || height > 1)
+    {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+        ++levels;
+    }
+    return levels;
+}
+
+// size of the level below width x height; a trailing odd row or column is dropped, as a 1-texel
+// edge of a 2x2 box would be
+inline void mipLevelSize(int width, int height, int& nextWidth, int& nextHeight)
+{
+    nextWidth = width > 1 ? width / 2 : 1;
+    nextHeight = height > 1 ? height / 2 : 1;
+}
+
+// bytes of every level below a width x height base, down to 1x1
+inline size_t mipChainTailBytes(int width, int height, int channels)
+{
+    size_t bytes = 0;
+    while (width > 1 || height > 1)
+    {
+        mipLevelSize(width, height, width, height);
+        bytes += static_cast<size_t>(width) * height * channels;
+    }
+    return bytes;
+}
+
+namespace mipmap_detail
+{
+    // linear values are quantized to this many steps before the table lookup back to 8 bits
+    const int ENCODE_STEPS = 16384;
+    // padding after each encode table so a 4-byte gather at the last entry stays in bounds
+    const int ENCODE_PAD = 4;
+
+    struct Tables
+    {
+        float toLinear[2][256];                                 // [0] sRGB, [1] alpha
+        unsigned char fromLinear[2][ENCODE_STEPS + ENCODE_PAD]; // [0] sRGB, [1] alpha
+
+        Tables()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                double value = i / 255.0;
+                toLinear[0][i] = static_cast<float>(value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4));
+                toLinear[1][i] = static_cast<float>(value);
+            }
+            for (int i = 0; i < ENCODE_STEPS + ENCODE_PAD; ++i)
+            {
+                double value = (i < ENCODE_STEPS ? i : ENCODE_STEPS - 1) / static_cast<double>(ENCODE_STEPS - 1);
+                double srgb = value <= 0.0031308 ? value * 12.92 : 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+                fromLinear[0][i] = static_cast<unsigned char>(srgb * 255.0 + 0.5);
+                fromLinear[1][i] = static_cast<unsigned char>(value * 255.0 + 0.5);
+            }
+        }
+    };
+
+    inline const Tables& tables()
+    {
+        static const Tables instance;
+        return instance;
+    }
+
+    // table (0 = sRGB, 1 = alpha) for byte i of a row
+    inline int tableFor(size_t i, int channels)
+    {
+        return channels == 4 && (i & 3) == 3 ? 1 : 0;
+    }
+
+    inline int encodeIndex(float value)
+    {
+        float scaled = value * (ENCODE_STEPS - 1) + 0.5f;
+        scaled = scaled < 0.0f ? 0.0f : (scaled > ENCODE_STEPS - 1 ? static_cast<float>(ENCODE_STEPS - 1) : scaled);
+        return static_cast<int>(scaled);
+    }
+
+    // scalar kernels ---------------------------------------------------------------------------
+
+    // bytes to linear floats
+    inline void decodeRowScalar(const unsigned char* src, float* dst, size_t count, int channels)
+    {
+        const Tables& t = tables();
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = t.toLinear[tableFor(i, channels)][src[i]];
+    }
+
+    // dst texel x = mean of texels 2x and 2x + 1 of rows a and b (step is 0 for a 1-texel-wide row);
+    // every version adds the rows first so they round identically
+    inline void reduceRowScalar(const float* a, const float* b, float* dst, int texels, int channels, int step)
+    {
+        for (int x = 0; x < texels; ++x)
+        {
+            const float* a0 = a + static_cast<size_t>(x) * 2 * step;
+            const float* b0 = b + static_cast<size_t>(x) * 2 * step;
+            for (int c = 0; c < channels; ++c)
+                dst[x * channels + c] = ((a0[c] + b0[c]) + (a0[c + step] + b0[c + step])) * 0.25f;
+        }
+    }
+
+    // linear floats to bytes
+    inline void encodeRowScalar(const float* src, unsigned char* dst, size_t count, int channels)
+    {
+        const Tables& t = tables();
+        for (size_t i = 0; i < count; ++i)
+            dst[i] = t.fromLinear[tableFor(i, channels)][encodeIndex(src[i])];
+    }
+
+#if defined(SIMD_SSE2)
+    // SSE2 kernels: the filter is fully vectorized; table lookups stay scalar without a gather
+
+    inline void reduceRowSSE2(const float* a, const float* b, float* dst, int texels, int channels, int step)
+    {
+        const __m128 quarter = _mm_set1_ps(0.25f);
+        int x = 0;
+        if (channels == 4 && step == 4)
+        {
+            for (; x < texels; ++x)
+            {
+                __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a + x * 8), _mm_loadu_ps(b + x * 8)),
+                    _mm_add_ps(_mm_loadu_ps(a + x * 8 + 4), _mm_loadu_ps(b + x * 8 + 4)));
+                _mm_storeu_ps(dst + x * 4, _mm_mul_ps(sum, quarter));
+            }
+        }
+        else if (channels == 3 && step == 3)
+        {
+            // 4-wide loads and stores of 3-channel texels: the 4th lane lands on the next texel and
+            // is overwritten by the next iteration, so the last texel is left to the scalar loop
+            for (; x + 1 < texels; ++x)
+            {
+                __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a + x * 6), _mm_loadu_ps(b + x * 6)),
+                    _mm_add_ps(_mm_loadu_ps(a + x * 6 + 3), _mm_loadu_ps(b + x * 6 + 3)));
+                _mm_storeu_ps(dst + x * 3, _mm_mul_ps(sum, quarter));
+            }
+        }
+        reduceRowScalar(a + static_cast<size_t>(x) * 2 * step, b + static_cast<size_t>(x) * 2 * step,
+            dst + static_cast<size_t>(x) * channels, texels - x, channels, step);
+    }
+
+    inline void encodeRowSSE2(const float* src, unsigned char* dst, size_t count, int channels)
+    {
+        const Tables& t = tables();
+        const __m128 scale = _mm_set1_ps(static_cast<float>(ENCODE_STEPS - 1));
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 top = _mm_set1_ps(static_cast<float>(ENCODE_STEPS - 1));
+        size_t i = 0;
+        alignas(16) int32_t index[4];
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 scaled = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), half);
+            scaled = _mm_min_ps(_mm_max_ps(scaled, zero), top);
+            _mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_cvttps_epi32(scaled));
+            for (int lane = 0; lane < 4; ++lane)
+                dst[i + lane] = t.fromLinear[tableFor(i + lane, channels)][index[lane]];
+        }
+        encodeRowScalar(src + i, dst + i, count - i, channels);
+    }
+#endif
+
+#if defined(SIMD_AVX2)
+    // AVX2 kernels: the table lookups become gathers
+
+    SIMD_TARGET_AVX2 inline void decodeRowAVX2(const unsigned char* src, float* dst, size_t count, int channels)
+    {
+        const Tables& t = tables();
+        // alpha bytes index the second table, 256 floats further on
+        const __m256i offsets = channels == 4 ? _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256) : _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256i bytes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)));
+            _mm256_storeu_ps(dst + i, _mm256_i32gather_ps(&t.toLinear[0][0], _mm256_add_epi32(bytes, offsets), 4));
+        }
+        decodeRowScalar(src + i, dst + i, count - i, channels);
+    }
+
+    SIMD_TARGET_AVX2 inline void reduceRowAVX2(const float* a, const float* b, float* dst, int texels, int channels, int step)
+    {
+        if (channels != 4 || step != 4)
+        {
+            reduceRowSSE2(a, b, dst, texels, channels, step);
+            return;
+        }
+        // two output texels per iteration: [t0 t1] and [t2 t3] become [t0+t1 t2+t3]
+        const __m256 quarter = _mm256_set1_ps(0.25f);
+        int x = 0;
+        for (; x + 2 <= texels; x += 2)
+        {
+            __m256 rows01 = _mm256_add_ps(_mm256_loadu_ps(a + x * 8), _mm256_loadu_ps(b + x * 8));
+            __m256 rows23 = _mm256_add_ps(_mm256_loadu_ps(a + x * 8 + 8), _mm256_loadu_ps(b + x * 8 + 8));
+            __m256 sum = _mm256_add_ps(_mm256_permute2f128_ps(rows01, rows23, 0x20), _mm256_permute2f128_ps(rows01, rows23, 0x31));
+            _mm256_storeu_ps(dst + x * 4, _mm256_mul_ps(sum, quarter));
+        }
+        reduceRowSSE2(a + static_cast<size_t>(x) * 8, b + static_cast<size_t>(x) * 8, dst + static_cast<size_t>(x) * 4, texels - x, 4, 4);
+    }
+
+    SIMD_TARGET_AVX2 inline void encodeRowAVX2(const float* src, unsigned char* dst, size_t count, int channels)
+    {
+        const Tables& t = tables();
+        const int alphaOffset = ENCODE_STEPS + ENCODE_PAD;
+        const __m256i offsets = channels == 4 ? _mm256_setr_epi32(0, 0, 0, alphaOffset, 0, 0, 0, alphaOffset) : _mm256_setzero_si256();
+        const __m256 scale = _mm256_set1_ps(static_cast<float>(ENCODE_STEPS - 1));
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 top = _mm256_set1_ps(static_cast<float>(ENCODE_STEPS - 1));
+        const __m256i low = _mm256_set1_epi32(0xFF);
+        // gathered dwords hold each entry in their low byte; pack them down to 8 bytes
+        const __m256i pack = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 scaled = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), scale), half);
+            scaled = _mm256_min_ps(_mm256_max_ps(scaled, zero), top);
+            __m256i index = _mm256_add_epi32(_mm256_cvttps_epi32(scaled), offsets);
+            __m256i entries = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(&t.fromLinear[0][0]), index, 1), low);
+            __m256i packed = _mm256_shuffle_epi8(entries, pack);
+            uint32_t lo = static_cast<uint32_t>(_mm256_extract_epi32(packed, 0));
+            uint32_t hi = static_cast<uint32_t>(_mm256_extract_epi32(packed, 4));
+            for (int b = 0; b < 4; ++b)
+            {
+                dst[i + b] = static_cast<unsigned char>(lo >> (b * 8));
+                dst[i + 4 + b] = static_cast<unsigned char>(hi >> (b * 8));
+            }
+        }
+        encodeRowScalar(src + i, dst + i, count - i, channels);
+    }
+#endif
+
+    // the kernels for this CPU
+    struct Kernels
+    {
+        void (*decodeRow)(const unsigned char*, float*, size_t, int);
+        void (*reduceRow)(const float*, const float*, float*, int, int, int);
+        void (*encodeRow)(const float*, unsigned char*, size_t, int);
+    };
+
+    inline Kernels selectKernels()
+    {
+        Kernels kernels = { decodeRowScalar, reduceRowScalar, encodeRowScalar };
+#if defined(SIMD_SSE2)
+        kernels.reduceRow = reduceRowSSE2;
+        kernels.encodeRow = encodeRowSSE2;
+#endif
+#if defined(SIMD_AVX2)
+        if (cpuHasAVX2())
+        {
+            kernels.decodeRow = decodeRowAVX2;
+            kernels.reduceRow = reduceRowAVX2;
+            kernels.encodeRow = encodeRowAVX2;
+        }
+#endif
+        return kernels;
+    }
+
+    inline const Kernels& kernels()
+    {
+        static const Kernels selected = selectKernels();
+        return selected;
+    }
+}
+
+// writes every level below base (width x height, channels 3 or 4) into out, which must hold
+// mipChainTailBytes(width, height, channels) bytes: level 1 first, down to 1x1, each tightly packed
+inline void buildMipChain(const unsigned char* base, int width, int height, int channels, unsigned char* out)
+{
+    using namespace mipmap_detail;
+    const Kernels& k = kernels();
+    std::vector<float> above, below, rows;
+    bool haveLinear = false;    // above holds the linear values of the current level
+    while (width > 1 || height > 1)
+    {
+        int nextWidth, nextHeight;
+        mipLevelSize(width, height, nextWidth, nextHeight);
+        size_t rowFloats = static_cast<size_t>(width) * channels;
+        size_t nextRowFloats = static_cast<size_t>(nextWidth) * channels;
+        int step = width > 1 ? channels : 0;
+        below.resize(nextRowFloats * nextHeight);
+        if (!haveLinear)
+            rows.resize(rowFloats * 2);
+
+        for (int y = 0; y < nextHeight; ++y)
+        {
+            int y0 = height > 1 ? y * 2 : 0, y1 = height > 1 ? y * 2 + 1 : 0;
+            const float* a;
+            const float* b;
+            if (haveLinear)
+            {
+                a = above.data() + y0 * rowFloats;
+                b = above.data() + y1 * rowFloats;
+            }
+            else
+            {
+                k.decodeRow(base + y0 * rowFloats, rows.data(), rowFloats, channels);
+                k.decodeRow(base + y1 * rowFloats, rows.data() + rowFloats, rowFloats, channels);
+                a = rows.data();
+                b = rows.data() + rowFloats;
+            }
+            float* dst = below.data() + y * nextRowFloats;
+            k.reduceRow(a, b, dst, nextWidth, channels, step);
+            k.encodeRow(dst, out + y * nextRowFloats, nextRowFloats, channels);
+        }
+
+        out += nextRowFloats * nextHeight;
+        above.swap(below);
+        haveLinear = true;
+        width = nextWidth;
+        height = nextHeight;
+    }
+}
+#endif
@@ -0,0 +1,116 @@
+#ifndef PIXEL_BUFFER_RING_H
+#define PIXEL_BUFFER_RING_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <vector>
+
+// A small ring of pixel unpack buffers for asynchronous texture uploads. Pixels are copied into
+// the next free buffer and the glTexSubImage2D that follows reads from it instead of client
+// memory, so the driver can return immediately and DMA the data later. Each buffer is fenced
+// after use and only rewritten once the GPU has consumed it.
+class PixelBufferRing
+{
+public:
+    // what stage() did with the bytes
+    enum StageResult
+    {
+        STAGE_READY,    // copied; the buffer is bound for the transfer
+        STAGE_BUSY,     // the buffer is still in use and wait was false; try again later
+        STAGE_FAILED    // waiting on or mapping the buffer failed; retrying will not help
+    };
+
+    void create(int count, size_t bytesEach)
+    {
+        slots.resize(count);
+        for (Slot& slot : slots)
+        {
+            glGenBuffers(1, &slot.ID);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.ID);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, bytesEach, NULL, GL_STREAM_DRAW);
+            slot.capacity = bytesEach;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        capacity = bytesEach;
+    }
+
+    // largest transfer one buffer holds
+    size_t chunkBytes() const
+    {
+        return capacity;
+    }
+
+    // copies bytes into the next buffer and leaves it bound to GL_PIXEL_UNPACK_BUFFER, so the
+    // caller's next glTexSubImage2D reads from offset 0 of it. Nothing is staged unless the result
+    // is STAGE_READY.
+    StageResult stage(const void* data, size_t bytes, bool wait)
+    {
+        Slot& slot = slots[next];
+        if (slot.fence)
+        {
+            // a blocking wait must flush first: a fence still sitting in the command queue may
+            // never signal, and a single flush() can wrap the whole ring
+            GLenum status = wait ? glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED)
+                : glClientWaitSync(slot.fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED)
+                return STAGE_BUSY;
+            if (status == GL_WAIT_FAILED)
+                return STAGE_FAILED;   // the buffer may still be read, so keep the fence
+            glDeleteSync(slot.fence);
+            slot.fence = 0;
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.ID);
+        if (bytes > slot.capacity)
+        {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+            slot.capacity = bytes;
+        }
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (!mapped)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return STAGE_FAILED;
+        }
+        std::memcpy(mapped, data, bytes);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        return STAGE_READY;
+    }
+
+    // call after issuing the transfer from the staged buffer: fences it, unbinds it and moves on
+    void submit()
+    {
+        Slot& slot = slots[next];
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        next = (next + 1) % slots.size();
+    }
+
+    void destroy()
+    {
+        for (Slot& slot : slots)
+        {
+            if (slot.fence)
+                glDeleteSync(slot.fence);
+            glDeleteBuffers(1, &slot.ID);
+        }
+        slots.clear();
+        next = 0;
+        capacity = 0;
+    }
+
+private:
+    struct Slot
+    {
+        unsigned int ID = 0;
+        size_t capacity = 0;
+        GLsync fence = 0;
+    };
+
+    std::vector<Slot> slots;
+    size_t next = 0;
+    size_t capacity = 0;
+};
+#endif
@@ -4,8 +4,7 @@ out vec4 FragColor;
 struct Material {
     sampler2D diffuse1; // First texture
     sampler2D diffuse2; // Second texture
-    vec3 specular;    
-    float shininess;
+    sampler2DArray diffuseArray; // Texture array, sampled at the vertex's layer
 }; 
 
 struct DirLight {
@@ -35,16 +34,31 @@ struct PointLight {
 
 in vec3 FragPos;  
 in vec3 Normal; 
-in vec4 ourColor;
 in vec2 TexCoord;
+flat in float Layer;
 
 // Speficies number of textures
 uniform int numTextures; 
+// Samples material.diffuseArray instead of the 2D textures
+uniform bool useTextureArray;
 
-uniform vec3 viewPos;
 uniform Material material;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform DirLight dirLight;
+
+// Surface constants of the current draw (MaterialBlock in material_block.h mirrors this layout)
+layout (std140) uniform MaterialBlock {
+    vec4 materialColor;
+    vec3 materialSpecular;
+    float materialShininess;
+};
+
+// Per-frame constants shared by every program (FrameBlock in frame_block.h mirrors this layout)
+layout (std140) uniform FrameBlock {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+};
 
 // Functions
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
@@ -67,7 +81,11 @@ void main()
     // Combine texture samples with object color based on numTextures
     vec4 texColor = vec4(1.0); // Default to white if textures are not used
 
-    if (numTextures == 1)
+    if (useTextureArray)
+    {
+        texColor = texture(material.diffuseArray, vec3(TexCoord, Layer));
+    }
+    else if (numTextures == 1)
     {
         texColor = texture(material.diffuse1, TexCoord);
     }
@@ -76,7 +94,7 @@ void main()
         texColor = texture(material.diffuse1, TexCoord) * texture(material.diffuse2, TexCoord);
     }
 
-    vec4 objectColor = ourColor;
+    vec4 objectColor = materialColor;
 
     // Result
     FragColor = objectColor * texColor * vec4(result, 1.0);
@@ -90,11 +108,11 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
     float diff = max(dot(normal, lightDir), 0.0);
     // specular shading
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), materialShininess);
     // combine results
     vec3 ambient = light.ambient;
     vec3 diffuse = light.diffuse * diff;
-    vec3 specular = light.specular * spec * material.specular;
+    vec3 specular = light.specular * spec * materialSpecular;
     return (ambient + diffuse + specular);
 }
 
@@ -105,14 +123,14 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     float diff = max(dot(normal, lightDir), 0.0);
     // specular shading
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), materialShininess);
     // attenuation
     float distance    = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
     // combine results
     vec3 ambient  = light.ambient;
     vec3 diffuse  = light.diffuse  * diff;
-    vec3 specular = light.specular * (spec * material.specular);
+    vec3 specular = light.specular * (spec * materialSpecular);
     ambient *= attenuation;
     diffuse *= attenuation;
     specular *= attenuation;
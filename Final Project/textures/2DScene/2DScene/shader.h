@@ -4,9 +4,20 @@
 #include <glad/glad.h>
 
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <algorithm>
+
+// A uniform location resolved once after linking. T is the C++ type the uniform is set with,
+// so Shader::set picks the matching glUniform* call without any name lookup per frame.
+template <typename T>
+struct Uniform
+{
+    GLint location = -1;
+};
 
 class Shader
 {
@@ -67,6 +78,8 @@ public:
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+        // 3. list every active uniform once so later lookups never go to the driver
+        cacheUniformLocations();
     }
     // activate the shader
     // ------------------------------------------------------------------------
@@ -74,66 +87,182 @@ public:
     {
         glUseProgram(ID);
     }
-    // utility uniform functions
+    // uniform lookup
+    // ------------------------------------------------------------------------
+    // returns the cached location of an active uniform, or -1 (ignored by glUniform*) if the
+    // program has no active uniform with that name. Takes a string_view so passing a literal
+    // never builds a temporary std::string (names like "pointLights[0].quadratic" exceed SSO).
+    GLint location(std::string_view name) const
+    {
+        std::vector<CachedUniform>::const_iterator it = std::lower_bound(uniforms.begin(), uniforms.end(), name,
+            [](const CachedUniform& entry, std::string_view key) { return std::string_view(entry.name) < key; });
+        if (it != uniforms.end() && std::string_view(it->name) == name)
+            return it->location;
+        return -1;
+    }
+    // resolves a typed handle once; keep it and pass it to set() in the render loop
+    template <typename T>
+    Uniform<T> uniform(std::string_view name) const
+    {
+        Uniform<T> handle;
+        handle.location = location(name);
+        return handle;
+    }
+    // attaches a uniform block of this program to a buffer binding point (see glBindBufferRange)
+    void bindUniformBlock(std::string_view blockName, GLuint binding) const
+    {
+        GLuint index = glGetUniformBlockIndex(ID, std::string(blockName).c_str());
+        if (index == GL_INVALID_INDEX)
+        {
+            std::cout << "ERROR::SHADER::UNIFORM_BLOCK_NOT_FOUND: " << blockName << std::endl;
+            return;
+        }
+        glUniformBlockBinding(ID, index, binding);
+    }
+    // utility uniform functions for pre-resolved handles (the program must be in use)
+    // ------------------------------------------------------------------------
+    void set(Uniform<bool> uniform, bool value) const
+    {
+        glUniform1i(uniform.location, (int)value);
+    }
+    void set(Uniform<int> uniform, int value) const
+    {
+        glUniform1i(uniform.location, value);
+    }
+    void set(Uniform<float> uniform, float value) const
+    {
+        glUniform1f(uniform.location, value);
+    }
+    void set(Uniform<glm::vec2> uniform, const glm::vec2& value) const
+    {
+        glUniform2fv(uniform.location, 1, &value[0]);
+    }
+    void set(Uniform<glm::vec3> uniform, const glm::vec3& value) const
+    {
+        glUniform3fv(uniform.location, 1, &value[0]);
+    }
+    void set(Uniform<glm::vec4> uniform, const glm::vec4& value) const
+    {
+        glUniform4fv(uniform.location, 1, &value[0]);
+    }
+    void set(Uniform<glm::mat2> uniform, const glm::mat2& mat) const
+    {
+        glUniformMatrix2fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void set(Uniform<glm::mat3> uniform, const glm::mat3& mat) const
+    {
+        glUniformMatrix3fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
+    }
+    void set(Uniform<glm::mat4> uniform, const glm::mat4& mat) const
+    {
+        glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &mat[0][0]);
+    }
+    // utility uniform functions by name (looked up in the cached table)
     // ------------------------------------------------------------------------
-    void setBool(const std::string& name, bool value) const
+    void setBool(std::string_view name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glUniform1i(location(name), (int)value);
     }
     // ------------------------------------------------------------------------
-    void setInt(const std::string& name, int value) const
+    void setInt(std::string_view name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1i(location(name), value);
     }
     // ------------------------------------------------------------------------
-    void setFloat(const std::string& name, float value) const
+    void setFloat(std::string_view name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1f(location(name), value);
     }
     // ------------------------------------------------------------------------
-    void setVec2(const std::string& name, const glm::vec2& value) const
+    void setVec2(std::string_view name, const glm::vec2& value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform2fv(location(name), 1, &value[0]);
     }
-    void setVec2(const std::string& name, float x, float y) const
+    void setVec2(std::string_view name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        glUniform2f(location(name), x, y);
     }
     // ------------------------------------------------------------------------
-    void setVec3(const std::string& name, const glm::vec3& value) const
+    void setVec3(std::string_view name, const glm::vec3& value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform3fv(location(name), 1, &value[0]);
     }
-    void setVec3(const std::string& name, float x, float y, float z) const
+    void setVec3(std::string_view name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        glUniform3f(location(name), x, y, z);
     }
     // ------------------------------------------------------------------------
-    void setVec4(const std::string& name, const glm::vec4& value) const
+    void setVec4(std::string_view name, const glm::vec4& value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform4fv(location(name), 1, &value[0]);
     }
-    void setVec4(const std::string& name, float x, float y, float z, float w) const
+    void setVec4(std::string_view name, float x, float y, float z, float w) const
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        glUniform4f(location(name), x, y, z, w);
     }
     // ------------------------------------------------------------------------
-    void setMat2(const std::string& name, const glm::mat2& mat) const
+    void setMat2(std::string_view name, const glm::mat2& mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix2fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
-    void setMat3(const std::string& name, const glm::mat3& mat) const
+    void setMat3(std::string_view name, const glm::mat3& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
-    void setMat4(const std::string& name, const glm::mat4& mat) const
+    void setMat4(std::string_view name, const glm::mat4& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix4fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
+    // one active uniform; the table is kept sorted by name for binary search
+    struct CachedUniform
+    {
+        std::string name;
+        GLint location;
+    };
+    std::vector<CachedUniform> uniforms;
+
+    // fills the uniform table from the linked program. Arrays of plain types are reported once as
+    // "name[0]" with a size, so every element (and the bare array name) gets its own entry.
+    // ------------------------------------------------------------------------
+    void cacheUniformLocations()
+    {
+        GLint count = 0;
+        GLint maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> buffer(maxLength > 0 ? maxLength : 1);
+        for (GLint i = 0; i < count; ++i)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, (GLuint)i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), length);
+            GLint loc = glGetUniformLocation(ID, name.c_str());
+            if (loc < 0)
+                continue; // members of uniform blocks have no location
+            uniforms.push_back({ name, loc });
+
+            std::string::size_type bracket = name.size() > 3 ? name.rfind("[0]") : std::string::npos;
+            if (bracket != std::string::npos && bracket == name.size() - 3)
+            {
+                std::string base = name.substr(0, bracket);
+                uniforms.push_back({ base, loc });
+                for (GLint element = 1; element < size; ++element)
+                {
+                    std::string elementName = base + "[" + std::to_string(element) + "]";
+                    uniforms.push_back({ elementName, glGetUniformLocation(ID, elementName.c_str()) });
+                }
+            }
+        }
+        std::sort(uniforms.begin(), uniforms.end(),
+            [](const CachedUniform& a, const CachedUniform& b) { return a.name < b.name; });
+    }
+
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(unsigned int shader, std::string type)
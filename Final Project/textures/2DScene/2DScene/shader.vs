@@ -1,24 +1,62 @@
 #version 420 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec4 aColor;
-layout (location = 3) in vec2 aTexCoord;
+// packed vertices (vertex_format.h), normalized to [-1, 1] / [0, 1] by glVertexAttribPointer
+layout (location = 0) in vec3 aPos;         // position / vertexScale.x
+layout (location = 1) in vec2 aNormal;      // octahedral-encoded unit normal
+layout (location = 3) in vec2 aTexCoord;    // texture coordinates / vertexScale.y
+layout (location = 4) in float aLayer;      // texture array layer (only read with useTextureArray)
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
-out vec4 ourColor;
+flat out float Layer;
+
+// must match the declaration in shader.fs, since both stages link into one program
+struct DirLight {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct PointLight {
+    vec3 position;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    float constant;
+    float linear;
+    float quadratic;
+    vec3 lightColor;
+};
+
+layout (std140) uniform FrameBlock {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    DirLight dirLight;
+    PointLight pointLights[2];
+};
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// the drawn mesh's quantization scales: x positions, y texture coordinates
+uniform vec2 vertexScale;
+
+// inverse of octahedralEncode in vertex_format.h
+vec3 octahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;   
-    TexCoord = aTexCoord;
-    ourColor = aColor;
+    FragPos = vec3(model * vec4(aPos * vertexScale.x, 1.0));
+    Normal = mat3(transpose(inverse(model))) * octahedralDecode(aNormal);   
+    TexCoord = aTexCoord * vertexScale.y;
+    Layer = aLayer;
     
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
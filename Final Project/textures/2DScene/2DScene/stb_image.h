@@ -15,6 +15,10 @@
 
    You can #define STBI_ASSERT(x) before the #include to avoid using assert.h.
    And #define STBI_MALLOC, STBI_REALLOC, and STBI_FREE to avoid using malloc,realloc,free
+   STBI_MALLOC_RESULT(sz) (default STBI_MALLOC) allocates the buffers the PNG, JPEG and zlib
+   decoders and the format conversions may return to the caller, so an allocator for scratch
+   memory can hand those out from elsewhere. Results are still released through STBI_FREE and
+   may be grown through STBI_REALLOC(_SIZED).
 
 
    QUICK NOTES:
@@ -432,6 +436,15 @@ extern "C" {
     STBIDEF stbi_uc* stbi_load_gif_from_memory(stbi_uc const* buffer, int len, int** delays, int* x, int* y, int* z, int* comp, int req_comp);
 #endif
 
+    // as above, but a JPEG is decoded straight to 1/scale_denom of its width and height (rounded
+    // up) by a reduced-size IDCT, each pixel the mean of the block it covers, so the entropy decode
+    // is the only full-size work. scale_denom is 1, 2, 4 or 8; other formats load at full size, so
+    // always check *x and *y
+    STBIDEF stbi_uc* stbi_load_from_memory_scaled(stbi_uc const* buffer, int len, int* x, int* y, int* channels_in_file, int desired_channels, int scale_denom);
+#ifndef STBI_NO_STDIO
+    STBIDEF stbi_uc* stbi_load_scaled(char const* filename, int* x, int* y, int* channels_in_file, int desired_channels, int scale_denom);
+#endif
+
 #ifdef STBI_WINDOWS_UTF8
     STBIDEF int stbi_convert_wchar_to_utf8(char* buffer, size_t bufferlen, const wchar_t* input);
 #endif
@@ -523,6 +536,14 @@ extern "C" {
     STBIDEF void stbi_convert_iphone_png_to_rgb_thread(int flag_true_if_should_convert);
     STBIDEF void stbi_set_flip_vertically_on_load_thread(int flag_true_if_should_flip);
 
+    // decode large JPEGs on several threads. run(task, data, count, user) must call task(data, i)
+    // once for every i in [0, count), on any threads and in any order, and return once all calls
+    // have finished. Images with fewer than min_pixels pixels stay on the calling thread. Pass
+    // run = NULL for single-threaded decoding (the default). Global, not per thread.
+    typedef void stbi_parallel_task(void* data, int index);
+    typedef void stbi_parallel_for(stbi_parallel_task* task, void* data, int count, void* user);
+    STBIDEF void stbi_set_jpeg_parallel(stbi_parallel_for* run, void* user, int min_pixels);
+
     // ZLIB client - used by PNG, available for other purposes
 
     STBIDEF char* stbi_zlib_decode_malloc_guesssize(const char* buffer, int len, int initial_size, int* outlen);
@@ -642,12 +663,14 @@ typedef unsigned short stbi__uint16;
 typedef   signed short stbi__int16;
 typedef unsigned int   stbi__uint32;
 typedef   signed int   stbi__int32;
+typedef unsigned long long stbi__uint64;
 #else
 #include <stdint.h>
 typedef uint16_t stbi__uint16;
 typedef int16_t  stbi__int16;
 typedef uint32_t stbi__uint32;
 typedef int32_t  stbi__int32;
+typedef uint64_t stbi__uint64;
 #endif
 
 // should produce compiler error if size is wrong
@@ -687,6 +710,10 @@ typedef unsigned char validate_uint32[sizeof(stbi__uint32) == 4 ? 1 : -1];
 #define STBI_REALLOC_SIZED(p,oldsz,newsz) STBI_REALLOC(p,newsz)
 #endif
 
+#ifndef STBI_MALLOC_RESULT
+#define STBI_MALLOC_RESULT(sz)    STBI_MALLOC(sz)
+#endif
+
 // x86/x64 detection
 #if defined(__x86_64__) || defined(_M_X64)
 #define STBI__X64_TARGET
@@ -749,7 +776,7 @@ static int stbi__cpuid3(void)
 
 #define STBI_SIMD_ALIGN(type, name) __declspec(align(16)) type name
 
-#if !defined(STBI_NO_JPEG) && defined(STBI_SSE2)
+#if (!defined(STBI_NO_JPEG) || !defined(STBI_NO_PNG)) && defined(STBI_SSE2)
 static int stbi__sse2_available(void)
 {
     int info3 = stbi__cpuid3();
@@ -760,7 +787,7 @@ static int stbi__sse2_available(void)
 #else // assume GCC-style if not VC++
 #define STBI_SIMD_ALIGN(type, name) type name __attribute__((aligned(16)))
 
-#if !defined(STBI_NO_JPEG) && defined(STBI_SSE2)
+#if (!defined(STBI_NO_JPEG) || !defined(STBI_NO_PNG)) && defined(STBI_SSE2)
 static int stbi__sse2_available(void)
 {
     // If we're even attempting to compile this on GCC/Clang, that means
@@ -773,6 +800,36 @@ static int stbi__sse2_available(void)
 #endif
 #endif
 
+// AVX2 versions of the JPEG kernels are built next to the SSE2 ones (with a per-function target,
+// so the rest of the file keeps the baseline instruction set) and picked at run time when the CPU
+// and OS support them. #define STBI_NO_AVX2 to leave them out.
+#if defined(STBI_SSE2) && !defined(STBI_NO_AVX2) && !defined(STBI_NO_JPEG) && ((defined(_MSC_VER) && _MSC_VER >= 1700) || defined(__GNUC__))
+#define STBI_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define STBI__AVX2_TARGET
+static int stbi__avx2_available(void)
+{
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return 0;
+    __cpuid(info, 1);
+    // OSXSAVE and AVX, and the OS saves the YMM registers
+    if (!((info[2] >> 27) & 1) || !((info[2] >> 28) & 1) || (_xgetbv(0) & 6) != 6)
+        return 0;
+    __cpuidex(info, 7, 0);
+    return ((info[1] >> 5) & 1) != 0;
+}
+#else
+#define STBI__AVX2_TARGET __attribute__((target("avx2")))
+static int stbi__avx2_available(void)
+{
+    return __builtin_cpu_supports("avx2") != 0;
+}
+#endif
+#endif
+
 // ARM NEON
 #if defined(STBI_NO_SIMD) && defined(STBI_NEON)
 #undef STBI_NEON
@@ -816,6 +873,8 @@ typedef struct
 
     stbi_uc* img_buffer, * img_buffer_end;
     stbi_uc* img_buffer_original, * img_buffer_original_end;
+
+    int jpeg_scale_shift; // JPEGs decode at 1/(1 << jpeg_scale_shift) size (see stbi_load_scaled)
 } stbi__context;
 
 
@@ -829,6 +888,7 @@ static void stbi__start_mem(stbi__context* s, stbi_uc const* buffer, int len)
     s->callback_already_read = 0;
     s->img_buffer = s->img_buffer_original = (stbi_uc*)buffer;
     s->img_buffer_end = s->img_buffer_original_end = (stbi_uc*)buffer + len;
+    s->jpeg_scale_shift = 0;
 }
 
 // initialize a callback-based context
@@ -839,6 +899,7 @@ static void stbi__start_callbacks(stbi__context* s, stbi_io_callbacks* c, void*
     s->buflen = sizeof(s->buffer_start);
     s->read_from_callbacks = 1;
     s->callback_already_read = 0;
+    s->jpeg_scale_shift = 0;
     s->img_buffer = s->img_buffer_original = s->buffer_start;
     stbi__refill_buffer(s);
     s->img_buffer_original_end = s->img_buffer_end;
@@ -986,6 +1047,12 @@ static void* stbi__malloc(size_t size)
     return STBI_MALLOC(size);
 }
 
+// for a buffer that may become the pixels returned by stbi_load and friends
+static void* stbi__malloc_result(size_t size)
+{
+    return STBI_MALLOC_RESULT(size);
+}
+
 // stb_image uses ints pervasively, including for offset calculations.
 // therefore the largest decoded image size we can support with the
 // current code, even on 64-bit targets, is INT_MAX. this is not a
@@ -1057,6 +1124,12 @@ static void* stbi__malloc_mad3(int a, int b, int c, int add)
     return stbi__malloc(a * b * c + add);
 }
 
+static void* stbi__malloc_result_mad3(int a, int b, int c, int add)
+{
+    if (!stbi__mad3sizes_valid(a, b, c, add)) return NULL;
+    return stbi__malloc_result(a * b * c + add);
+}
+
 #if !defined(STBI_NO_LINEAR) || !defined(STBI_NO_HDR) || !defined(STBI_NO_PNM)
 static void* stbi__malloc_mad4(int a, int b, int c, int d, int add)
 {
@@ -1133,6 +1206,17 @@ STBIDEF void stbi_set_flip_vertically_on_load_thread(int flag_true_if_should_fli
                                          : stbi__vertically_flip_on_load_global)
 #endif // STBI_THREAD_LOCAL
 
+static stbi_parallel_for* stbi__jpeg_parallel_run = NULL;
+static void* stbi__jpeg_parallel_user = NULL;
+static int stbi__jpeg_parallel_min_pixels = 0;
+
+STBIDEF void stbi_set_jpeg_parallel(stbi_parallel_for* run, void* user, int min_pixels)
+{
+    stbi__jpeg_parallel_run = run;
+    stbi__jpeg_parallel_user = user;
+    stbi__jpeg_parallel_min_pixels = min_pixels;
+}
+
 static void* stbi__load_main(stbi__context* s, int* x, int* y, int* comp, int req_comp, stbi__result_info* ri, int bpc)
 {
     memset(ri, 0, sizeof(*ri)); // make sure it's initialized if we add new fields
@@ -1192,7 +1276,7 @@ static stbi_uc* stbi__convert_16_to_8(stbi__uint16* orig, int w, int h, int chan
     int img_len = w * h * channels;
     stbi_uc* reduced;
 
-    reduced = (stbi_uc*)stbi__malloc(img_len);
+    reduced = (stbi_uc*)stbi__malloc_result(img_len);
     if (reduced == NULL) return stbi__errpuc("outofmem", "Out of memory");
 
     for (i = 0; i < img_len; ++i)
@@ -1208,7 +1292,7 @@ static stbi__uint16* stbi__convert_8_to_16(stbi_uc* orig, int w, int h, int chan
     int img_len = w * h * channels;
     stbi__uint16* enlarged;
 
-    enlarged = (stbi__uint16*)stbi__malloc(img_len * 2);
+    enlarged = (stbi__uint16*)stbi__malloc_result(img_len * 2);
     if (enlarged == NULL) return (stbi__uint16*)stbi__errpuc("outofmem", "Out of memory");
 
     for (i = 0; i < img_len; ++i)
@@ -1439,6 +1523,46 @@ STBIDEF stbi_uc* stbi_load_from_callbacks(stbi_io_callbacks const* clbk, void* u
     return stbi__load_and_postprocess_8bit(&s, x, y, comp, req_comp);
 }
 
+// log2 of a scale denominator, or -1 if it is not 1, 2, 4 or 8
+static int stbi__scale_shift(int scale_denom)
+{
+    switch (scale_denom) {
+    case 1: return 0;
+    case 2: return 1;
+    case 4: return 2;
+    case 8: return 3;
+    default: return -1;
+    }
+}
+
+STBIDEF stbi_uc* stbi_load_from_memory_scaled(stbi_uc const* buffer, int len, int* x, int* y, int* comp, int req_comp, int scale_denom)
+{
+    stbi__context s;
+    int shift = stbi__scale_shift(scale_denom);
+    if (shift < 0) return stbi__errpuc("bad scale", "Scale must be 1, 2, 4 or 8");
+    stbi__start_mem(&s, buffer, len);
+    s.jpeg_scale_shift = shift;
+    return stbi__load_and_postprocess_8bit(&s, x, y, comp, req_comp);
+}
+
+#ifndef STBI_NO_STDIO
+STBIDEF stbi_uc* stbi_load_scaled(char const* filename, int* x, int* y, int* comp, int req_comp, int scale_denom)
+{
+    stbi__context s;
+    unsigned char* result;
+    FILE* f;
+    int shift = stbi__scale_shift(scale_denom);
+    if (shift < 0) return stbi__errpuc("bad scale", "Scale must be 1, 2, 4 or 8");
+    f = stbi__fopen(filename, "rb");
+    if (!f) return stbi__errpuc("can't fopen", "Unable to open file");
+    stbi__start_file(&s, f);
+    s.jpeg_scale_shift = shift;
+    result = stbi__load_and_postprocess_8bit(&s, x, y, comp, req_comp);
+    fclose(f);
+    return result;
+}
+#endif
+
 #ifndef STBI_NO_GIF
 STBIDEF stbi_uc* stbi_load_gif_from_memory(stbi_uc const* buffer, int len, int** delays, int* x, int* y, int* z, int* comp, int req_comp)
 {
@@ -1761,7 +1885,7 @@ static unsigned char* stbi__convert_format(unsigned char* data, int img_n, int r
     if (req_comp == img_n) return data;
     STBI_ASSERT(req_comp >= 1 && req_comp <= 4);
 
-    good = (unsigned char*)stbi__malloc_mad3(req_comp, x, y, 0);
+    good = (unsigned char*)stbi__malloc_result_mad3(req_comp, x, y, 0);
     if (good == NULL) {
         STBI_FREE(data);
         return stbi__errpuc("outofmem", "Out of memory");
@@ -1818,7 +1942,7 @@ static stbi__uint16* stbi__convert_format16(stbi__uint16* data, int img_n, int r
     if (req_comp == img_n) return data;
     STBI_ASSERT(req_comp >= 1 && req_comp <= 4);
 
-    good = (stbi__uint16*)stbi__malloc(req_comp * x * y * 2);
+    good = (stbi__uint16*)stbi__malloc_result(req_comp * x * y * 2);
     if (good == NULL) {
         STBI_FREE(data);
         return (stbi__uint16*)stbi__errpuc("outofmem", "Out of memory");
@@ -1970,6 +2094,7 @@ typedef struct
         int dc_pred;
 
         int x, y, w2, h2;
+        int scale_shift; // this plane's IDCT blocks are 8 >> scale_shift pixels square
         stbi_uc* data;
         void* raw_data, * raw_coeff;
         stbi_uc* linebuf;
@@ -1994,6 +2119,7 @@ typedef struct
 
     int scan_n, order[4];
     int restart_interval, todo;
+    int scale_shift;    // decode at 1/(1 << scale_shift) size (see stbi_load_scaled)
 
     // kernels
     void (*idct_block_kernel)(stbi_uc* out, int out_stride, short data[64]);
@@ -2535,6 +2661,91 @@ static void stbi__idct_block(stbi_uc* out, int out_stride, short data[64])
     }
 }
 
+// reduced-size IDCTs for stbi_load_scaled. Each output pixel is the mean of the s x s pixels of
+// the full 8x8 IDCT it covers, computed straight from the coefficients: every constant is the
+// mean of an 8-point IDCT basis function (with its C(u)/2 normalization) over s pixels. Those
+// means keep the basis symmetry, so each 1D pass splits into even and odd halves; coefficient 4
+// averages to 0 over pairs of pixels, and 2, 4 and 6 over groups of four. The constants of one
+// output sum to under 1.7 in magnitude, so neither pass can overflow even for corrupt data.
+#define STBI__IDCT_HALF_1D(s0,s1,s2,s3,s5,s6,s7) \
+   int e0, e1, o0, o1; \
+   e0 = stbi__f2f(0.3535534f) * s0; \
+   e1 = e0 - stbi__f2f(0.3266407f) * s2 + stbi__f2f(0.1352990f) * s6; \
+   e0 = e0 + stbi__f2f(0.3266407f) * s2 - stbi__f2f(0.1352990f) * s6; \
+   o0 = stbi__f2f(0.4530637f) * s1 + stbi__f2f(0.1590948f) * s3 - stbi__f2f(0.1063038f) * s5 - stbi__f2f(0.0901200f) * s7; \
+   o1 = stbi__f2f(0.1876651f) * s1 - stbi__f2f(0.3840889f) * s3 + stbi__f2f(0.2566400f) * s5 - stbi__f2f(0.0373289f) * s7;
+
+#define STBI__IDCT_QUARTER_1D(s0,s1,s3,s5,s7) \
+   int e, o; \
+   e = stbi__f2f(0.3535534f) * s0; \
+   o = stbi__f2f(0.3203644f) * s1 - stbi__f2f(0.1124970f) * s3 + stbi__f2f(0.0751681f) * s5 - stbi__f2f(0.0637244f) * s7;
+
+static void stbi__idct_block_half(stbi_uc* out, int out_stride, short data[64])
+{
+    int i, val[32], * v = val;
+    short* d = data;
+
+    // columns, keeping 2 extra bits of precision like stbi__idct_block
+    for (i = 0; i < 8; ++i, ++d, ++v) {
+        if (d[8] == 0 && d[16] == 0 && d[24] == 0 && d[40] == 0 && d[48] == 0 && d[56] == 0) {
+            v[0] = v[8] = v[16] = v[24] = (stbi__f2f(0.3535534f) * d[0] + 512) >> 10;
+        }
+        else {
+            STBI__IDCT_HALF_1D(d[0], d[8], d[16], d[24], d[40], d[48], d[56])
+            v[0] = (e0 + o0 + 512) >> 10;
+            v[8] = (e1 + o1 + 512) >> 10;
+            v[16] = (e1 - o1 + 512) >> 10;
+            v[24] = (e0 - o0 + 512) >> 10;
+        }
+    }
+
+    // rows: 1<<12 from each pass less the 10 bits already removed leaves 1<<14 to round off,
+    // with the +128 level shift added first
+    for (i = 0, v = val; i < 4; ++i, v += 8, out += out_stride) {
+        STBI__IDCT_HALF_1D(v[0], v[1], v[2], v[3], v[5], v[6], v[7])
+        e0 += (1 << 13) + (128 << 14);
+        e1 += (1 << 13) + (128 << 14);
+        out[0] = stbi__clamp((e0 + o0) >> 14);
+        out[1] = stbi__clamp((e1 + o1) >> 14);
+        out[2] = stbi__clamp((e1 - o1) >> 14);
+        out[3] = stbi__clamp((e0 - o0) >> 14);
+    }
+}
+
+static void stbi__idct_block_quarter(stbi_uc* out, int out_stride, short data[64])
+{
+    int i, val[16], * v = val;
+    short* d = data;
+
+    for (i = 0; i < 8; ++i, ++d, ++v) {
+        if (d[8] == 0 && d[24] == 0 && d[40] == 0 && d[56] == 0) {
+            v[0] = v[8] = (stbi__f2f(0.3535534f) * d[0] + 512) >> 10;
+        }
+        else {
+            STBI__IDCT_QUARTER_1D(d[0], d[8], d[24], d[40], d[56])
+            v[0] = (e + o + 512) >> 10;
+            v[8] = (e - o + 512) >> 10;
+        }
+    }
+
+    for (i = 0, v = val; i < 2; ++i, v += 8, out += out_stride) {
+        STBI__IDCT_QUARTER_1D(v[0], v[1], v[3], v[5], v[7])
+        e += (1 << 13) + (128 << 14);
+        out[0] = stbi__clamp((e + o) >> 14);
+        out[1] = stbi__clamp((e - o) >> 14);
+    }
+}
+
+static void stbi__idct_block_eighth(stbi_uc* out, int out_stride, short data[64])
+{
+    // the DC coefficient is 8 times the mean of the block
+    STBI_NOTUSED(out_stride);
+    out[0] = stbi__clamp((data[0] + 4 + (128 << 3)) >> 3);
+}
+
+typedef void (*stbi__idct_func)(stbi_uc* out, int out_stride, short data[64]);
+static const stbi__idct_func stbi__idct_reduced[4] = { NULL, stbi__idct_block_half, stbi__idct_block_quarter, stbi__idct_block_eighth };
+
 #ifdef STBI_SSE2
 // sse2 integer IDCT. not the fastest possible implementation but it
 // produces bit-identical results to the generic C version so it's
@@ -2716,6 +2927,179 @@ static void stbi__idct_simd(stbi_uc* out, int out_stride, short data[64])
 
 #endif // STBI_SSE2
 
+#ifdef STBI_AVX2
+// avx2 integer IDCT. the same arithmetic as stbi__idct_simd, so also bit-identical to the generic
+// C version, but the 32-bit half of each pass works on all 8 columns of a row at once. rows are
+// kept "split": columns 0-3 in the low 64 bits of the lower 128-bit lane and columns 4-7 in the
+// low 64 bits of the upper one, a layout the in-lane unpack, madd and pack instructions keep.
+STBI__AVX2_TARGET static void stbi__idct_avx2(stbi_uc* out, int out_stride, short data[64])
+{
+    __m128i row0, row1, row2, row3, row4, row5, row6, row7;
+    __m256i srow0, srow1, srow2, srow3, srow4, srow5, srow6, srow7;
+    __m128i tmp;
+
+    // dot product constant: even elems=x, odd elems=y
+#define dct_const(x,y)  _mm256_setr_epi16((x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y),(x),(y))
+
+// out = c0[even]*x + c0[odd]*y, out1 likewise with c1   (c0, x, y 16-bit, out 32-bit)
+#define dct_rot(out0,out1, x,y,c0,c1) \
+      __m256i c0##xy = _mm256_unpacklo_epi16((x),(y)); \
+      __m256i out0 = _mm256_madd_epi16(c0##xy, c0); \
+      __m256i out1 = _mm256_madd_epi16(c0##xy, c1)
+
+   // out = in << 12  (in 16-bit, out 32-bit)
+#define dct_widen(out, in) \
+      __m256i out = _mm256_srai_epi32(_mm256_unpacklo_epi16(_mm256_setzero_si256(), (in)), 4)
+
+   // butterfly a/b, add bias, then shift by "s" and pack back into the split layout
+#define dct_bfly32o(out0, out1, a,b,bias,s) \
+      { \
+         __m256i abiased = _mm256_add_epi32(a, bias); \
+         __m256i sum = _mm256_srai_epi32(_mm256_add_epi32(abiased, b), s); \
+         __m256i dif = _mm256_srai_epi32(_mm256_sub_epi32(abiased, b), s); \
+         out0 = _mm256_packs_epi32(sum, sum); \
+         out1 = _mm256_packs_epi32(dif, dif); \
+      }
+
+   // 8-bit interleave step (for transposes)
+#define dct_interleave8(a, b) \
+      tmp = a; \
+      a = _mm_unpacklo_epi8(a, b); \
+      b = _mm_unpackhi_epi8(tmp, b)
+
+   // 16-bit interleave step (for transposes)
+#define dct_interleave16(a, b) \
+      tmp = a; \
+      a = _mm_unpacklo_epi16(a, b); \
+      b = _mm_unpackhi_epi16(tmp, b)
+
+   // row to split layout and back
+#define dct_split(r)  _mm256_permute4x64_epi64(_mm256_castsi128_si256(r), 0x50)
+#define dct_join(s)   _mm256_castsi256_si128(_mm256_permute4x64_epi64((s), 0x08))
+
+#define dct_pass(bias,shift) \
+      { \
+         srow0 = dct_split(row0); srow1 = dct_split(row1); srow2 = dct_split(row2); srow3 = dct_split(row3); \
+         srow4 = dct_split(row4); srow5 = dct_split(row5); srow6 = dct_split(row6); srow7 = dct_split(row7); \
+         /* even part */ \
+         dct_rot(t2e,t3e, srow2,srow6, rot0_0,rot0_1); \
+         __m256i sum04 = _mm256_add_epi16(srow0, srow4); \
+         __m256i dif04 = _mm256_sub_epi16(srow0, srow4); \
+         dct_widen(t0e, sum04); \
+         dct_widen(t1e, dif04); \
+         __m256i x0 = _mm256_add_epi32(t0e, t3e); \
+         __m256i x3 = _mm256_sub_epi32(t0e, t3e); \
+         __m256i x1 = _mm256_add_epi32(t1e, t2e); \
+         __m256i x2 = _mm256_sub_epi32(t1e, t2e); \
+         /* odd part */ \
+         dct_rot(y0o,y2o, srow7,srow3, rot2_0,rot2_1); \
+         dct_rot(y1o,y3o, srow5,srow1, rot3_0,rot3_1); \
+         __m256i sum17 = _mm256_add_epi16(srow1, srow7); \
+         __m256i sum35 = _mm256_add_epi16(srow3, srow5); \
+         dct_rot(y4o,y5o, sum17,sum35, rot1_0,rot1_1); \
+         __m256i x4 = _mm256_add_epi32(y0o, y4o); \
+         __m256i x5 = _mm256_add_epi32(y1o, y5o); \
+         __m256i x6 = _mm256_add_epi32(y2o, y5o); \
+         __m256i x7 = _mm256_add_epi32(y3o, y4o); \
+         dct_bfly32o(srow0,srow7, x0,x7,bias,shift); \
+         dct_bfly32o(srow1,srow6, x1,x6,bias,shift); \
+         dct_bfly32o(srow2,srow5, x2,x5,bias,shift); \
+         dct_bfly32o(srow3,srow4, x3,x4,bias,shift); \
+         row0 = dct_join(srow0); row1 = dct_join(srow1); row2 = dct_join(srow2); row3 = dct_join(srow3); \
+         row4 = dct_join(srow4); row5 = dct_join(srow5); row6 = dct_join(srow6); row7 = dct_join(srow7); \
+      }
+
+    __m256i rot0_0 = dct_const(stbi__f2f(0.5411961f), stbi__f2f(0.5411961f) + stbi__f2f(-1.847759065f));
+    __m256i rot0_1 = dct_const(stbi__f2f(0.5411961f) + stbi__f2f(0.765366865f), stbi__f2f(0.5411961f));
+    __m256i rot1_0 = dct_const(stbi__f2f(1.175875602f) + stbi__f2f(-0.899976223f), stbi__f2f(1.175875602f));
+    __m256i rot1_1 = dct_const(stbi__f2f(1.175875602f), stbi__f2f(1.175875602f) + stbi__f2f(-2.562915447f));
+    __m256i rot2_0 = dct_const(stbi__f2f(-1.961570560f) + stbi__f2f(0.298631336f), stbi__f2f(-1.961570560f));
+    __m256i rot2_1 = dct_const(stbi__f2f(-1.961570560f), stbi__f2f(-1.961570560f) + stbi__f2f(3.072711026f));
+    __m256i rot3_0 = dct_const(stbi__f2f(-0.390180644f) + stbi__f2f(2.053119869f), stbi__f2f(-0.390180644f));
+    __m256i rot3_1 = dct_const(stbi__f2f(-0.390180644f), stbi__f2f(-0.390180644f) + stbi__f2f(1.501321110f));
+
+    // rounding biases in column/row passes, see stbi__idct_block for explanation.
+    __m256i bias_0 = _mm256_set1_epi32(512);
+    __m256i bias_1 = _mm256_set1_epi32(65536 + (128 << 17));
+
+    // load
+    row0 = _mm_load_si128((const __m128i*) (data + 0 * 8));
+    row1 = _mm_load_si128((const __m128i*) (data + 1 * 8));
+    row2 = _mm_load_si128((const __m128i*) (data + 2 * 8));
+    row3 = _mm_load_si128((const __m128i*) (data + 3 * 8));
+    row4 = _mm_load_si128((const __m128i*) (data + 4 * 8));
+    row5 = _mm_load_si128((const __m128i*) (data + 5 * 8));
+    row6 = _mm_load_si128((const __m128i*) (data + 6 * 8));
+    row7 = _mm_load_si128((const __m128i*) (data + 7 * 8));
+
+    // column pass
+    dct_pass(bias_0, 10);
+
+    {
+        // 16bit 8x8 transpose pass 1
+        dct_interleave16(row0, row4);
+        dct_interleave16(row1, row5);
+        dct_interleave16(row2, row6);
+        dct_interleave16(row3, row7);
+
+        // transpose pass 2
+        dct_interleave16(row0, row2);
+        dct_interleave16(row1, row3);
+        dct_interleave16(row4, row6);
+        dct_interleave16(row5, row7);
+
+        // transpose pass 3
+        dct_interleave16(row0, row1);
+        dct_interleave16(row2, row3);
+        dct_interleave16(row4, row5);
+        dct_interleave16(row6, row7);
+    }
+
+    // row pass
+    dct_pass(bias_1, 17);
+
+    {
+        // pack
+        __m128i p0 = _mm_packus_epi16(row0, row1); // a0a1a2a3...a7b0b1b2b3...b7
+        __m128i p1 = _mm_packus_epi16(row2, row3);
+        __m128i p2 = _mm_packus_epi16(row4, row5);
+        __m128i p3 = _mm_packus_epi16(row6, row7);
+
+        // 8bit 8x8 transpose pass 1
+        dct_interleave8(p0, p2); // a0e0a1e1...
+        dct_interleave8(p1, p3); // c0g0c1g1...
+
+        // transpose pass 2
+        dct_interleave8(p0, p1); // a0c0e0g0...
+        dct_interleave8(p2, p3); // b0d0f0h0...
+
+        // transpose pass 3
+        dct_interleave8(p0, p2); // a0b0c0d0...
+        dct_interleave8(p1, p3); // a4b4c4d4...
+
+        // store
+        _mm_storel_epi64((__m128i*) out, p0); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, _mm_shuffle_epi32(p0, 0x4e)); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, p2); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, _mm_shuffle_epi32(p2, 0x4e)); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, p1); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, _mm_shuffle_epi32(p1, 0x4e)); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, p3); out += out_stride;
+        _mm_storel_epi64((__m128i*) out, _mm_shuffle_epi32(p3, 0x4e));
+    }
+
+#undef dct_const
+#undef dct_rot
+#undef dct_widen
+#undef dct_bfly32o
+#undef dct_interleave8
+#undef dct_interleave16
+#undef dct_split
+#undef dct_join
+#undef dct_pass
+}
+#endif // STBI_AVX2
+
 #ifdef STBI_NEON
 
 // NEON integer IDCT. should produce bit-identical
@@ -2958,6 +3342,17 @@ static void stbi__jpeg_reset(stbi__jpeg* j)
     // since we don't even allow 1<<30 pixels
 }
 
+// IDCTs block (bx, by) of component n into its place in the component's plane
+static void stbi__jpeg_idct(stbi__jpeg* z, int n, int bx, int by, short data[64])
+{
+    int shift = z->img_comp[n].scale_shift, size = 8 >> shift;
+    stbi_uc* out = z->img_comp[n].data + z->img_comp[n].w2 * by * size + bx * size;
+    if (shift)
+        stbi__idct_reduced[shift](out, z->img_comp[n].w2, data);
+    else
+        z->idct_block_kernel(out, z->img_comp[n].w2, data);
+}
+
 static int stbi__parse_entropy_coded_data(stbi__jpeg* z)
 {
     stbi__jpeg_reset(z);
@@ -2976,7 +3371,7 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg* z)
                 for (i = 0; i < w; ++i) {
                     int ha = z->img_comp[n].ha;
                     if (!stbi__jpeg_decode_block(z, data, z->huff_dc + z->img_comp[n].hd, z->huff_ac + ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-                    z->idct_block_kernel(z->img_comp[n].data + z->img_comp[n].w2 * j * 8 + i * 8, z->img_comp[n].w2, data);
+                    stbi__jpeg_idct(z, n, i, j, data);
                     // every data block is an MCU, so countdown the restart interval
                     if (--z->todo <= 0) {
                         if (z->code_bits < 24) stbi__grow_buffer_unsafe(z);
@@ -3001,11 +3396,11 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg* z)
                         // by the basic H and V specified for the component
                         for (y = 0; y < z->img_comp[n].v; ++y) {
                             for (x = 0; x < z->img_comp[n].h; ++x) {
-                                int x2 = (i * z->img_comp[n].h + x) * 8;
-                                int y2 = (j * z->img_comp[n].v + y) * 8;
+                                int x2 = i * z->img_comp[n].h + x;
+                                int y2 = j * z->img_comp[n].v + y;
                                 int ha = z->img_comp[n].ha;
                                 if (!stbi__jpeg_decode_block(z, data, z->huff_dc + z->img_comp[n].hd, z->huff_ac + ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
-                                z->idct_block_kernel(z->img_comp[n].data + z->img_comp[n].w2 * y2 + x2, z->img_comp[n].w2, data);
+                                stbi__jpeg_idct(z, n, x2, y2, data);
                             }
                         }
                     }
@@ -3086,6 +3481,137 @@ static int stbi__parse_entropy_coded_data(stbi__jpeg* z)
     }
 }
 
+// Multithreaded decoding (see stbi_set_jpeg_parallel). Every restart interval of a baseline scan
+// starts byte-aligned with fresh DC predictions, so once the RSTn markers have been located in an
+// in-memory stream, groups of intervals are entropy decoded and IDCT'd as independent tasks, each
+// on its own copy of the decoder state. Resampling and color conversion then run in bands of
+// output rows (see load_jpeg_image). Output is identical to single-threaded decoding.
+
+#define STBI__JPEG_MAX_TASKS  64
+
+static int stbi__jpeg_parallel(stbi__jpeg* z)
+{
+    return stbi__jpeg_parallel_run != NULL
+        && (double)z->s->img_x * (double)z->s->img_y >= (double)stbi__jpeg_parallel_min_pixels;
+}
+
+// decodes and IDCTs count MCUs of a baseline scan starting at MCU first
+static int stbi__jpeg_decode_mcus(stbi__jpeg* z, int first, int count)
+{
+    int m;
+    STBI_SIMD_ALIGN(short, data[64]);
+    if (z->scan_n == 1) {
+        int n = z->order[0];
+        int w = (z->img_comp[n].x + 7) >> 3;
+        int ha = z->img_comp[n].ha;
+        for (m = first; m < first + count; ++m) {
+            int i = m % w, j = m / w;
+            if (!stbi__jpeg_decode_block(z, data, z->huff_dc + z->img_comp[n].hd, z->huff_ac + ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
+            stbi__jpeg_idct(z, n, i, j, data);
+        }
+    }
+    else {
+        int k, x, y;
+        for (m = first; m < first + count; ++m) {
+            int i = m % z->img_mcu_x, j = m / z->img_mcu_x;
+            for (k = 0; k < z->scan_n; ++k) {
+                int n = z->order[k];
+                for (y = 0; y < z->img_comp[n].v; ++y) {
+                    for (x = 0; x < z->img_comp[n].h; ++x) {
+                        int x2 = i * z->img_comp[n].h + x;
+                        int y2 = j * z->img_comp[n].v + y;
+                        int ha = z->img_comp[n].ha;
+                        if (!stbi__jpeg_decode_block(z, data, z->huff_dc + z->img_comp[n].hd, z->huff_ac + ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
+                        stbi__jpeg_idct(z, n, x2, y2, data);
+                    }
+                }
+            }
+        }
+    }
+    return 1;
+}
+
+typedef struct
+{
+    stbi__jpeg* z;
+    stbi_uc** start;      // entropy-coded bytes of restart interval i are start[i] .. end[i]
+    stbi_uc** end;
+    int intervals, per_task, mcus;
+    volatile int failed;  // only ever set to 1
+} stbi__jpeg_interval_job;
+
+static void stbi__jpeg_interval_task(void* data, int index)
+{
+    stbi__jpeg_interval_job* job = (stbi__jpeg_interval_job*)data;
+    stbi__context s;
+    int i, first = index * job->per_task, last = first + job->per_task < job->intervals ? first + job->per_task : job->intervals;
+    stbi__jpeg* z = (stbi__jpeg*)stbi__malloc(sizeof(stbi__jpeg));
+    if (!z) { job->failed = 1; return; }
+    memcpy(z, job->z, sizeof(stbi__jpeg));
+    z->s = &s;
+    for (i = first; i < last && !job->failed; ++i) {
+        int mcu = i * z->restart_interval;
+        int count = job->mcus - mcu < z->restart_interval ? job->mcus - mcu : z->restart_interval;
+        stbi__start_mem(&s, job->start[i], (int)(job->end[i] - job->start[i]));
+        stbi__jpeg_reset(z);
+        if (!stbi__jpeg_decode_mcus(z, mcu, count))
+            job->failed = 1;
+    }
+    STBI_FREE(z);
+}
+
+// decodes a baseline scan one group of restart intervals per task. Returns 1 or 0 like
+// stbi__parse_entropy_coded_data, or -1 without consuming anything if the scan cannot be split.
+static int stbi__parse_entropy_coded_data_parallel(stbi__jpeg* z)
+{
+    stbi__jpeg_interval_job job;
+    stbi_uc* p, * limit = z->s->img_buffer_end;
+    int count = 0, tasks;
+    if (z->progressive || z->restart_interval <= 0 || z->s->read_from_callbacks || !stbi__jpeg_parallel(z))
+        return -1;
+    if (z->scan_n == 1) {
+        int n = z->order[0];
+        job.mcus = ((z->img_comp[n].x + 7) >> 3) * ((z->img_comp[n].y + 7) >> 3);
+    }
+    else
+        job.mcus = z->img_mcu_x * z->img_mcu_y;
+    job.intervals = (job.mcus + z->restart_interval - 1) / z->restart_interval;
+    if (job.intervals < 2)
+        return -1;
+
+    // find every interval: RSTn separates them, any other marker ends the scan
+    job.start = (stbi_uc**)stbi__malloc_mad2(job.intervals, (int)(2 * sizeof(stbi_uc*)), 0);
+    if (!job.start) return stbi__err("outofmem", "Out of memory");
+    job.end = job.start + job.intervals;
+    job.start[count] = p = z->s->img_buffer;
+    while (p < limit) {
+        stbi_uc* q;
+        if (*p != 0xff) { ++p; continue; }
+        q = p + 1;
+        while (q < limit && *q == 0xff) ++q; // fill bytes
+        if (q == limit) break;
+        if (*q == 0x00) { p = q + 1; continue; } // stuffed zero
+        job.end[count++] = p;
+        if (!STBI__RESTART(*q) || count == job.intervals) break;
+        job.start[count] = p = q + 1;
+    }
+    if (count != job.intervals) { STBI_FREE(job.start); return -1; } // truncated or corrupt: decode serially
+
+    job.z = z;
+    job.failed = 0;
+    tasks = job.intervals < STBI__JPEG_MAX_TASKS ? job.intervals : STBI__JPEG_MAX_TASKS;
+    job.per_task = (job.intervals + tasks - 1) / tasks;
+    tasks = (job.intervals + job.per_task - 1) / job.per_task;
+    stbi__jpeg_parallel_run(stbi__jpeg_interval_task, &job, tasks, stbi__jpeg_parallel_user);
+
+    // leave the stream at the marker that ended the scan, as the serial decoder does
+    z->s->img_buffer = job.end[job.intervals - 1];
+    stbi__jpeg_reset(z);
+    STBI_FREE(job.start);
+    if (job.failed) return stbi__err("bad huffman code", "Corrupt JPEG");
+    return 1;
+}
+
 static void stbi__jpeg_dequantize(short* data, stbi__uint16* dequant)
 {
     int i;
@@ -3105,7 +3631,7 @@ static void stbi__jpeg_finish(stbi__jpeg* z)
                 for (i = 0; i < w; ++i) {
                     short* data = z->img_comp[n].coeff + 64 * (i + j * z->img_comp[n].coeff_w);
                     stbi__jpeg_dequantize(data, z->dequant[z->img_comp[n].tq]);
-                    z->idct_block_kernel(z->img_comp[n].data + z->img_comp[n].w2 * j * 8 + i * 8, z->img_comp[n].w2, data);
+                    stbi__jpeg_idct(z, n, i, j, data);
                 }
             }
         }
@@ -3338,6 +3864,14 @@ static int stbi__process_frame_header(stbi__jpeg* z, int scan)
     z->img_mcu_y = (s->img_y + z->img_mcu_h - 1) / z->img_mcu_h;
 
     for (i = 0; i < s->img_n; ++i) {
+        // a reduced-size decode shrinks every block, and so the plane, by the same factor, except
+        // that a plane subsampled by 2^k both ways is reduced k steps less so it needs no upsampling
+        int relief = 0;
+        while (relief < z->scale_shift && h_max % (z->img_comp[i].h << (relief + 1)) == 0
+            && v_max % (z->img_comp[i].v << (relief + 1)) == 0)
+            ++relief;
+        z->img_comp[i].scale_shift = z->scale_shift - relief;
+
         // number of effective pixels (e.g. for non-interleaved MCU)
         z->img_comp[i].x = (s->img_x * z->img_comp[i].h + h_max - 1) / h_max;
         z->img_comp[i].y = (s->img_y * z->img_comp[i].v + v_max - 1) / v_max;
@@ -3348,8 +3882,10 @@ static int stbi__process_frame_header(stbi__jpeg* z, int scan)
         //
         // img_mcu_x, img_mcu_y: <=17 bits; comp[i].h and .v are <=4 (checked earlier)
         // so these muls can't overflow with 32-bit ints (which we require)
-        z->img_comp[i].w2 = z->img_mcu_x * z->img_comp[i].h * 8;
-        z->img_comp[i].h2 = z->img_mcu_y * z->img_comp[i].v * 8;
+        z->img_comp[i].coeff_w = z->img_mcu_x * z->img_comp[i].h;
+        z->img_comp[i].coeff_h = z->img_mcu_y * z->img_comp[i].v;
+        z->img_comp[i].w2 = z->img_comp[i].coeff_w * (8 >> z->img_comp[i].scale_shift);
+        z->img_comp[i].h2 = z->img_comp[i].coeff_h * (8 >> z->img_comp[i].scale_shift);
         z->img_comp[i].coeff = 0;
         z->img_comp[i].raw_coeff = 0;
         z->img_comp[i].linebuf = NULL;
@@ -3359,10 +3895,8 @@ static int stbi__process_frame_header(stbi__jpeg* z, int scan)
         // align blocks for idct using mmx/sse
         z->img_comp[i].data = (stbi_uc*)(((size_t)z->img_comp[i].raw_data + 15) & ~15);
         if (z->progressive) {
-            // w2, h2 are multiples of 8 (see above)
-            z->img_comp[i].coeff_w = z->img_comp[i].w2 / 8;
-            z->img_comp[i].coeff_h = z->img_comp[i].h2 / 8;
-            z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].w2, z->img_comp[i].h2, sizeof(short), 15);
+            // 64 coefficients per block, whatever the output size
+            z->img_comp[i].raw_coeff = stbi__malloc_mad3(z->img_comp[i].coeff_w * 8, z->img_comp[i].coeff_h * 8, sizeof(short), 15);
             if (z->img_comp[i].raw_coeff == NULL)
                 return stbi__free_jpeg_components(z, i + 1, stbi__err("outofmem", "Out of memory"));
             z->img_comp[i].coeff = (short*)(((size_t)z->img_comp[i].raw_coeff + 15) & ~15);
@@ -3427,6 +3961,28 @@ static int stbi__skip_jpeg_junk_at_end(stbi__jpeg* j)
     return STBI__MARKER_none;
 }
 
+// whether a progressive scan only carries coefficients no plane reads: a plane decoded at 1/8
+// size takes nothing but the DC coefficient of each block
+static int stbi__jpeg_scan_unused(stbi__jpeg* z)
+{
+    int k;
+    if (!z->progressive || z->spec_start == 0)
+        return 0;
+    for (k = 0; k < z->scan_n; ++k)
+        if (z->img_comp[z->order[k]].scale_shift != 3)
+            return 0;
+    return 1;
+}
+
+// steps over the entropy-coded data of a scan, restart markers included, to the marker ending it
+static int stbi__jpeg_skip_scan(stbi__jpeg* z)
+{
+    do
+        z->marker = stbi__skip_jpeg_junk_at_end(z);
+    while (STBI__RESTART(z->marker));
+    return 1;
+}
+
 // decode image to YCbCr format
 static int stbi__decode_jpeg_image(stbi__jpeg* j)
 {
@@ -3440,8 +3996,15 @@ static int stbi__decode_jpeg_image(stbi__jpeg* j)
     m = stbi__get_marker(j);
     while (!stbi__EOI(m)) {
         if (stbi__SOS(m)) {
+            int parsed;
             if (!stbi__process_scan_header(j)) return 0;
-            if (!stbi__parse_entropy_coded_data(j)) return 0;
+            if (stbi__jpeg_scan_unused(j))
+                parsed = stbi__jpeg_skip_scan(j);
+            else
+                parsed = stbi__parse_entropy_coded_data_parallel(j);
+            if (parsed < 0)
+                parsed = stbi__parse_entropy_coded_data(j);
+            if (!parsed) return 0;
             if (j->marker == STBI__MARKER_none) {
                 j->marker = stbi__skip_jpeg_junk_at_end(j);
                 // if we reach eof without hitting a marker, stbi__get_marker() below will fail and we'll eventually return 0
@@ -3664,6 +4227,86 @@ static stbi_uc* stbi__resample_row_hv_2_simd(stbi_uc* out, stbi_uc* in_near, stb
 }
 #endif
 
+#ifdef STBI_AVX2
+// avx2 version of stbi__resample_row_hv_2_simd: same filter, 16 pixels per step
+STBI__AVX2_TARGET static stbi_uc* stbi__resample_row_hv_2_avx2(stbi_uc* out, stbi_uc* in_near, stbi_uc* in_far, int w, int hs)
+{
+    // need to generate 2x2 samples for every one in input
+    int i = 0, t0, t1;
+
+    if (w == 1) {
+        out[0] = out[1] = stbi__div4(3 * in_near[0] + in_far[0] + 2);
+        return out;
+    }
+
+    t1 = 3 * in_near[0] + in_far[0];
+    // process groups of 16 pixels for as long as we can; as in the sse2 version the last pixel
+    // of a row is left to the scalar code for the filter boundary conditions.
+    for (; i < ((w - 1) & ~15); i += 16) {
+        // vertical filtering pass, 3*x + y = 4*x + (y - x); pixels 0-7 end up in the lower
+        // 128-bit lane and 8-15 in the upper one
+        __m256i farw = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*) (in_far + i)));
+        __m256i nearw = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*) (in_near + i)));
+        __m256i diff = _mm256_sub_epi16(farw, nearw);
+        __m256i nears = _mm256_slli_epi16(nearw, 2);
+        __m256i curr = _mm256_add_epi16(nears, diff); // current row
+
+        // "prev" is the current row shifted right by 1 pixel with the previous pixel (t1) put
+        // in front, "next" the current row shifted left by 1 pixel with the first pixel of the
+        // next group at the end. the byte shifts only work within a lane, so the neighbouring
+        // lane is brought in with alignr.
+        __m256i lo_in_hi = _mm256_permute2x128_si256(curr, curr, 0x08); // zero, pixels 0-7
+        __m256i hi_in_lo = _mm256_permute2x128_si256(curr, curr, 0x81); // pixels 8-15, zero
+        __m256i prv0 = _mm256_alignr_epi8(curr, lo_in_hi, 14);
+        __m256i nxt0 = _mm256_alignr_epi8(hi_in_lo, curr, 2);
+        __m256i prev = _mm256_insert_epi16(prv0, t1, 0);
+        __m256i next = _mm256_insert_epi16(nxt0, 3 * in_near[i + 16] + in_far[i + 16], 15);
+
+        // horizontal filter, polyphase implementation since it's convenient:
+        // even pixels = 3*cur + prev = cur*4 + (prev - cur)
+        // odd  pixels = 3*cur + next = cur*4 + (next - cur)
+        // note the shared term.
+        __m256i bias = _mm256_set1_epi16(8);
+        __m256i curs = _mm256_slli_epi16(curr, 2);
+        __m256i prvd = _mm256_sub_epi16(prev, curr);
+        __m256i nxtd = _mm256_sub_epi16(next, curr);
+        __m256i curb = _mm256_add_epi16(curs, bias);
+        __m256i even = _mm256_add_epi16(prvd, curb);
+        __m256i odd = _mm256_add_epi16(nxtd, curb);
+
+        // interleave even and odd pixels, then undo scaling. within each lane this gives output
+        // pixels in order, so lane 0 holds bytes 0-15 and lane 1 bytes 16-31 after packing.
+        __m256i int0 = _mm256_unpacklo_epi16(even, odd);
+        __m256i int1 = _mm256_unpackhi_epi16(even, odd);
+        __m256i de0 = _mm256_srli_epi16(int0, 4);
+        __m256i de1 = _mm256_srli_epi16(int1, 4);
+
+        // pack and write output
+        __m256i outv = _mm256_packus_epi16(de0, de1);
+        _mm256_storeu_si256((__m256i*) (out + i * 2), outv);
+
+        // "previous" value for next iter
+        t1 = 3 * in_near[i + 15] + in_far[i + 15];
+    }
+
+    t0 = t1;
+    t1 = 3 * in_near[i] + in_far[i];
+    out[i * 2] = stbi__div16(3 * t1 + t0 + 8);
+
+    for (++i; i < w; ++i) {
+        t0 = t1;
+        t1 = 3 * in_near[i] + in_far[i];
+        out[i * 2 - 1] = stbi__div16(3 * t0 + t1 + 8);
+        out[i * 2] = stbi__div16(3 * t1 + t0 + 8);
+    }
+    out[w * 2 - 1] = stbi__div4(t1 + 2);
+
+    STBI_NOTUSED(hs);
+
+    return out;
+}
+#endif
+
 static stbi_uc* stbi__resample_row_generic(stbi_uc* out, stbi_uc* in_near, stbi_uc* in_far, int w, int hs)
 {
     // resample with nearest-neighbor
@@ -3838,6 +4481,123 @@ static void stbi__YCbCr_to_RGB_simd(stbi_uc* out, stbi_uc const* y, stbi_uc cons
 }
 #endif
 
+#ifdef STBI_AVX2
+// the fixed-point color transform of stbi__YCbCr_to_RGB_simd (which matches the scalar one) on 16
+// pixels: r, g and b as 16-bit values, pixels 0-7 in the lower 128-bit lane and 8-15 in the upper
+STBI__AVX2_TARGET static void stbi__YCbCr_to_RGB_avx2_16(__m256i* rw, __m256i* gw, __m256i* bw, stbi_uc const* y, stbi_uc const* pcb, stbi_uc const* pcr)
+{
+    __m128i signflip = _mm_set1_epi8(-0x80);
+    __m256i cr_const0 = _mm256_set1_epi16((short)(1.40200f * 4096.0f + 0.5f));
+    __m256i cr_const1 = _mm256_set1_epi16(-(short)(0.71414f * 4096.0f + 0.5f));
+    __m256i cb_const0 = _mm256_set1_epi16(-(short)(0.34414f * 4096.0f + 0.5f));
+    __m256i cb_const1 = _mm256_set1_epi16((short)(1.77200f * 4096.0f + 0.5f));
+    __m256i y_bias = _mm256_set1_epi16(128);
+
+    // load
+    __m128i y_bytes = _mm_loadu_si128((__m128i*) y);
+    __m128i cr_bytes = _mm_loadu_si128((__m128i*) pcr);
+    __m128i cb_bytes = _mm_loadu_si128((__m128i*) pcb);
+    __m128i cr_biased = _mm_xor_si128(cr_bytes, signflip); // -128
+    __m128i cb_biased = _mm_xor_si128(cb_bytes, signflip); // -128
+
+    // widen to short with the byte in the high half, as the sse2 unpack does
+    __m256i yw = _mm256_or_si256(_mm256_slli_epi16(_mm256_cvtepu8_epi16(y_bytes), 8), y_bias);
+    __m256i crw = _mm256_slli_epi16(_mm256_cvtepu8_epi16(cr_biased), 8);
+    __m256i cbw = _mm256_slli_epi16(_mm256_cvtepu8_epi16(cb_biased), 8);
+
+    // color transform
+    __m256i yws = _mm256_srli_epi16(yw, 4);
+    __m256i cr0 = _mm256_mulhi_epi16(cr_const0, crw);
+    __m256i cb0 = _mm256_mulhi_epi16(cb_const0, cbw);
+    __m256i cb1 = _mm256_mulhi_epi16(cbw, cb_const1);
+    __m256i cr1 = _mm256_mulhi_epi16(crw, cr_const1);
+    __m256i rws = _mm256_add_epi16(cr0, yws);
+    __m256i gwt = _mm256_add_epi16(cb0, yws);
+    __m256i bws = _mm256_add_epi16(yws, cb1);
+    __m256i gws = _mm256_add_epi16(gwt, cr1);
+
+    // descale
+    *rw = _mm256_srai_epi16(rws, 4);
+    *bw = _mm256_srai_epi16(bws, 4);
+    *gw = _mm256_srai_epi16(gws, 4);
+}
+
+// avx2 color conversion: 16 pixels per step for RGBA output, like the sse2 version, and also
+// 32 pixels per step for RGB output, which the sse2 version leaves to the scalar code
+STBI__AVX2_TARGET static void stbi__YCbCr_to_RGB_avx2(stbi_uc* out, stbi_uc const* y, stbi_uc const* pcb, stbi_uc const* pcr, int count, int step)
+{
+    int i = 0;
+
+    if (step == 4) {
+        __m256i xw = _mm256_set1_epi16(255); // alpha channel
+
+        for (; i + 15 < count; i += 16) {
+            __m256i rw, gw, bw;
+            stbi__YCbCr_to_RGB_avx2_16(&rw, &gw, &bw, y + i, pcb + i, pcr + i);
+
+            // back to byte, set up for transpose
+            __m256i brb = _mm256_packus_epi16(rw, bw);
+            __m256i gxb = _mm256_packus_epi16(gw, xw);
+
+            // transpose to interleave channels; each lane ends up with its 8 pixels
+            __m256i t0 = _mm256_unpacklo_epi8(brb, gxb);
+            __m256i t1 = _mm256_unpackhi_epi8(brb, gxb);
+            __m256i o0 = _mm256_unpacklo_epi16(t0, t1); // pixels 0-3, 8-11
+            __m256i o1 = _mm256_unpackhi_epi16(t0, t1); // pixels 4-7, 12-15
+
+            // store
+            _mm256_storeu_si256((__m256i*) (out + 0), _mm256_permute2x128_si256(o0, o1, 0x20));
+            _mm256_storeu_si256((__m256i*) (out + 32), _mm256_permute2x128_si256(o0, o1, 0x31));
+            out += 64;
+        }
+    }
+    else if (step == 3) {
+        // byte k of each 48 bytes of output is channel k % 3 of pixel k / 3: every 16 bytes
+        // gather from all three channels
+#define stbi__rgb_mask(c, k) ((k) % 3 == (c) ? (char)((k) / 3) : (char)-128)
+#define stbi__rgb_masks(c, p) _mm256_setr_epi8( \
+      stbi__rgb_mask(c, p * 16 + 0), stbi__rgb_mask(c, p * 16 + 1), stbi__rgb_mask(c, p * 16 + 2), stbi__rgb_mask(c, p * 16 + 3), \
+      stbi__rgb_mask(c, p * 16 + 4), stbi__rgb_mask(c, p * 16 + 5), stbi__rgb_mask(c, p * 16 + 6), stbi__rgb_mask(c, p * 16 + 7), \
+      stbi__rgb_mask(c, p * 16 + 8), stbi__rgb_mask(c, p * 16 + 9), stbi__rgb_mask(c, p * 16 + 10), stbi__rgb_mask(c, p * 16 + 11), \
+      stbi__rgb_mask(c, p * 16 + 12), stbi__rgb_mask(c, p * 16 + 13), stbi__rgb_mask(c, p * 16 + 14), stbi__rgb_mask(c, p * 16 + 15), \
+      stbi__rgb_mask(c, p * 16 + 0), stbi__rgb_mask(c, p * 16 + 1), stbi__rgb_mask(c, p * 16 + 2), stbi__rgb_mask(c, p * 16 + 3), \
+      stbi__rgb_mask(c, p * 16 + 4), stbi__rgb_mask(c, p * 16 + 5), stbi__rgb_mask(c, p * 16 + 6), stbi__rgb_mask(c, p * 16 + 7), \
+      stbi__rgb_mask(c, p * 16 + 8), stbi__rgb_mask(c, p * 16 + 9), stbi__rgb_mask(c, p * 16 + 10), stbi__rgb_mask(c, p * 16 + 11), \
+      stbi__rgb_mask(c, p * 16 + 12), stbi__rgb_mask(c, p * 16 + 13), stbi__rgb_mask(c, p * 16 + 14), stbi__rgb_mask(c, p * 16 + 15))
+        __m256i r0 = stbi__rgb_masks(0, 0), g0 = stbi__rgb_masks(1, 0), b0 = stbi__rgb_masks(2, 0);
+        __m256i r1 = stbi__rgb_masks(0, 1), g1 = stbi__rgb_masks(1, 1), b1 = stbi__rgb_masks(2, 1);
+        __m256i r2 = stbi__rgb_masks(0, 2), g2 = stbi__rgb_masks(1, 2), b2 = stbi__rgb_masks(2, 2);
+#undef stbi__rgb_masks
+#undef stbi__rgb_mask
+
+        for (; i + 31 < count; i += 32) {
+            __m256i rw0, gw0, bw0, rw1, gw1, bw1;
+            stbi__YCbCr_to_RGB_avx2_16(&rw0, &gw0, &bw0, y + i, pcb + i, pcr + i);
+            stbi__YCbCr_to_RGB_avx2_16(&rw1, &gw1, &bw1, y + i + 16, pcb + i + 16, pcr + i + 16);
+
+            // back to byte: pixels 0-15 in the lower lane and 16-31 in the upper one
+            __m256i rb = _mm256_permute4x64_epi64(_mm256_packus_epi16(rw0, rw1), 0xd8);
+            __m256i gb = _mm256_permute4x64_epi64(_mm256_packus_epi16(gw0, gw1), 0xd8);
+            __m256i bb = _mm256_permute4x64_epi64(_mm256_packus_epi16(bw0, bw1), 0xd8);
+
+            // interleave: oN holds output bytes 16N.. of each lane's 48
+            __m256i o0 = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(rb, r0), _mm256_shuffle_epi8(gb, g0)), _mm256_shuffle_epi8(bb, b0));
+            __m256i o1 = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(rb, r1), _mm256_shuffle_epi8(gb, g1)), _mm256_shuffle_epi8(bb, b1));
+            __m256i o2 = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(rb, r2), _mm256_shuffle_epi8(gb, g2)), _mm256_shuffle_epi8(bb, b2));
+
+            // store
+            _mm256_storeu_si256((__m256i*) (out + 0), _mm256_permute2x128_si256(o0, o1, 0x20));
+            _mm256_storeu_si256((__m256i*) (out + 32), _mm256_permute2x128_si256(o2, o0, 0x30));
+            _mm256_storeu_si256((__m256i*) (out + 64), _mm256_permute2x128_si256(o1, o2, 0x31));
+            out += 96;
+        }
+    }
+
+    // remaining pixels
+    stbi__YCbCr_to_RGB_row(out, y + i, pcb + i, pcr + i, count - i, step);
+}
+#endif
+
 // set up the kernels
 static void stbi__setup_jpeg(stbi__jpeg* j)
 {
@@ -3853,6 +4613,14 @@ static void stbi__setup_jpeg(stbi__jpeg* j)
     }
 #endif
 
+#ifdef STBI_AVX2
+    if (stbi__avx2_available()) {
+        j->idct_block_kernel = stbi__idct_avx2;
+        j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_avx2;
+        j->resample_row_hv_2_kernel = stbi__resample_row_hv_2_avx2;
+    }
+#endif
+
 #ifdef STBI_NEON
     j->idct_block_kernel = stbi__idct_simd;
     j->YCbCr_to_RGB_kernel = stbi__YCbCr_to_RGB_simd;
@@ -3883,6 +4651,161 @@ static stbi_uc stbi__blinn_8x8(stbi_uc x, stbi_uc y)
     return (stbi_uc)((t + (t >> 8)) >> 8);
 }
 
+// resamples and color converts output rows j0 .. j1-1 into output; start holds the resampler
+// state at row 0 and linebuf one buffer of img_x + 3 bytes per component. The converters write
+// a padding byte past the end of each row, so when last_row is given row j1-1 goes through it
+// instead, leaving row j1 (another band's) untouched
+static void stbi__jpeg_convert_rows(stbi__jpeg* z, const stbi__resample* start, stbi_uc** linebuf, stbi_uc* last_row, stbi_uc* output, int n, int decode_n, int is_rgb, unsigned int j0, unsigned int j1)
+{
+    int k;
+    unsigned int i, j;
+    stbi_uc* coutput[4] = { NULL, NULL, NULL, NULL };
+    stbi__resample res_comp[4];
+
+    // step the resamplers down to row j0
+    for (k = 0; k < decode_n; ++k) {
+        stbi__resample* r = &res_comp[k];
+        *r = start[k];
+        for (j = 0; j < j0; ++j) {
+            if (++r->ystep >= r->vs) {
+                r->ystep = 0;
+                r->line0 = r->line1;
+                if (++r->ypos < z->img_comp[k].y)
+                    r->line1 += z->img_comp[k].w2;
+            }
+        }
+    }
+
+    for (j = j0; j < j1; ++j) {
+        stbi_uc* out = (last_row && j + 1 == j1) ? last_row : output + n * z->s->img_x * j;
+        for (k = 0; k < decode_n; ++k) {
+            stbi__resample* r = &res_comp[k];
+            int y_bot = r->ystep >= (r->vs >> 1);
+            coutput[k] = r->resample(linebuf[k],
+                y_bot ? r->line1 : r->line0,
+                y_bot ? r->line0 : r->line1,
+                r->w_lores, r->hs);
+            if (++r->ystep >= r->vs) {
+                r->ystep = 0;
+                r->line0 = r->line1;
+                if (++r->ypos < z->img_comp[k].y)
+                    r->line1 += z->img_comp[k].w2;
+            }
+        }
+        if (n >= 3) {
+            stbi_uc* y = coutput[0];
+            if (z->s->img_n == 3) {
+                if (is_rgb) {
+                    for (i = 0; i < z->s->img_x; ++i) {
+                        out[0] = y[i];
+                        out[1] = coutput[1][i];
+                        out[2] = coutput[2][i];
+                        out[3] = 255;
+                        out += n;
+                    }
+                }
+                else {
+                    z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+                }
+            }
+            else if (z->s->img_n == 4) {
+                if (z->app14_color_transform == 0) { // CMYK
+                    for (i = 0; i < z->s->img_x; ++i) {
+                        stbi_uc m = coutput[3][i];
+                        out[0] = stbi__blinn_8x8(coutput[0][i], m);
+                        out[1] = stbi__blinn_8x8(coutput[1][i], m);
+                        out[2] = stbi__blinn_8x8(coutput[2][i], m);
+                        out[3] = 255;
+                        out += n;
+                    }
+                }
+                else if (z->app14_color_transform == 2) { // YCCK
+                    z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+                    for (i = 0; i < z->s->img_x; ++i) {
+                        stbi_uc m = coutput[3][i];
+                        out[0] = stbi__blinn_8x8(255 - out[0], m);
+                        out[1] = stbi__blinn_8x8(255 - out[1], m);
+                        out[2] = stbi__blinn_8x8(255 - out[2], m);
+                        out += n;
+                    }
+                }
+                else { // YCbCr + alpha?  Ignore the fourth channel for now
+                    z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
+                }
+            }
+            else
+                for (i = 0; i < z->s->img_x; ++i) {
+                    out[0] = out[1] = out[2] = y[i];
+                    out[3] = 255; // not used if n==3
+                    out += n;
+                }
+        }
+        else {
+            if (is_rgb) {
+                if (n == 1)
+                    for (i = 0; i < z->s->img_x; ++i)
+                        *out++ = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
+                else {
+                    for (i = 0; i < z->s->img_x; ++i, out += 2) {
+                        out[0] = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
+                        out[1] = 255;
+                    }
+                }
+            }
+            else if (z->s->img_n == 4 && z->app14_color_transform == 0) {
+                for (i = 0; i < z->s->img_x; ++i) {
+                    stbi_uc m = coutput[3][i];
+                    stbi_uc r = stbi__blinn_8x8(coutput[0][i], m);
+                    stbi_uc g = stbi__blinn_8x8(coutput[1][i], m);
+                    stbi_uc b = stbi__blinn_8x8(coutput[2][i], m);
+                    out[0] = stbi__compute_y(r, g, b);
+                    out[1] = 255;
+                    out += n;
+                }
+            }
+            else if (z->s->img_n == 4 && z->app14_color_transform == 2) {
+                for (i = 0; i < z->s->img_x; ++i) {
+                    out[0] = stbi__blinn_8x8(255 - coutput[0][i], coutput[3][i]);
+                    out[1] = 255;
+                    out += n;
+                }
+            }
+            else {
+                stbi_uc* y = coutput[0];
+                if (n == 1)
+                    for (i = 0; i < z->s->img_x; ++i) out[i] = y[i];
+                else
+                    for (i = 0; i < z->s->img_x; ++i) { *out++ = y[i]; *out++ = 255; }
+            }
+        }
+    }
+    if (last_row && j1 > j0)
+        memcpy(output + n * z->s->img_x * (j1 - 1), last_row, n * z->s->img_x);
+}
+
+typedef struct
+{
+    stbi__jpeg* z;
+    const stbi__resample* start;
+    stbi_uc* output;
+    stbi_uc* linebuf;     // decode_n line buffers and a spare output row per task
+    int n, decode_n, is_rgb;
+    unsigned int rows_per_task;
+} stbi__jpeg_convert_job;
+
+static void stbi__jpeg_convert_task(void* data, int index)
+{
+    stbi__jpeg_convert_job* job = (stbi__jpeg_convert_job*)data;
+    stbi_uc* linebuf[4];
+    stbi_uc* base = job->linebuf + (size_t)index * (job->decode_n + 4) * (job->z->s->img_x + 3);
+    unsigned int j0 = index * job->rows_per_task, j1 = j0 + job->rows_per_task;
+    int k;
+    for (k = 0; k < job->decode_n; ++k)
+        linebuf[k] = base + k * (job->z->s->img_x + 3);
+    if (j1 > job->z->s->img_y) j1 = job->z->s->img_y;
+    stbi__jpeg_convert_rows(job->z, job->start, linebuf, base + job->decode_n * (job->z->s->img_x + 3), job->output, job->n, job->decode_n, job->is_rgb, j0, j1);
+}
+
 static stbi_uc* load_jpeg_image(stbi__jpeg* z, int* out_x, int* out_y, int* comp, int req_comp)
 {
     int n, decode_n, is_rgb;
@@ -3894,6 +4817,21 @@ static stbi_uc* load_jpeg_image(stbi__jpeg* z, int* out_x, int* out_y, int* comp
     // load a jpeg image from whichever source, but leave in YCbCr format
     if (!stbi__decode_jpeg_image(z)) { stbi__cleanup_jpeg(z); return NULL; }
 
+    // after a reduced-size decode everything below works on the reduced image, where a plane
+    // that was reduced less than the others counts as that much less subsampled
+    if (z->scale_shift) {
+        int k;
+        stbi__uint32 round = (1u << z->scale_shift) - 1;
+        z->s->img_x = (z->s->img_x + round) >> z->scale_shift;
+        z->s->img_y = (z->s->img_y + round) >> z->scale_shift;
+        for (k = 0; k < z->s->img_n; ++k) {
+            z->img_comp[k].h <<= z->scale_shift - z->img_comp[k].scale_shift;
+            z->img_comp[k].v <<= z->scale_shift - z->img_comp[k].scale_shift;
+            z->img_comp[k].x = (z->s->img_x * z->img_comp[k].h + z->img_h_max - 1) / z->img_h_max;
+            z->img_comp[k].y = (z->s->img_y * z->img_comp[k].v + z->img_v_max - 1) / z->img_v_max;
+        }
+    }
+
     // determine actual number of components to generate
     n = req_comp ? req_comp : z->s->img_n >= 3 ? 3 : 1;
 
@@ -3911,9 +4849,7 @@ static stbi_uc* load_jpeg_image(stbi__jpeg* z, int* out_x, int* out_y, int* comp
     // resample and color-convert
     {
         int k;
-        unsigned int i, j;
         stbi_uc* output;
-        stbi_uc* coutput[4] = { NULL, NULL, NULL, NULL };
 
         stbi__resample res_comp[4];
 
@@ -3940,111 +4876,33 @@ static stbi_uc* load_jpeg_image(stbi__jpeg* z, int* out_x, int* out_y, int* comp
         }
 
         // can't error after this so, this is safe
-        output = (stbi_uc*)stbi__malloc_mad3(n, z->s->img_x, z->s->img_y, 1);
+        output = (stbi_uc*)stbi__malloc_result_mad3(n, z->s->img_x, z->s->img_y, 1);
         if (!output) { stbi__cleanup_jpeg(z); return stbi__errpuc("outofmem", "Out of memory"); }
 
-        // now go ahead and resample
-        for (j = 0; j < z->s->img_y; ++j) {
-            stbi_uc* out = output + n * z->s->img_x * j;
-            for (k = 0; k < decode_n; ++k) {
-                stbi__resample* r = &res_comp[k];
-                int y_bot = r->ystep >= (r->vs >> 1);
-                coutput[k] = r->resample(z->img_comp[k].linebuf,
-                    y_bot ? r->line1 : r->line0,
-                    y_bot ? r->line0 : r->line1,
-                    r->w_lores, r->hs);
-                if (++r->ystep >= r->vs) {
-                    r->ystep = 0;
-                    r->line0 = r->line1;
-                    if (++r->ypos < z->img_comp[k].y)
-                        r->line1 += z->img_comp[k].w2;
-                }
-            }
-            if (n >= 3) {
-                stbi_uc* y = coutput[0];
-                if (z->s->img_n == 3) {
-                    if (is_rgb) {
-                        for (i = 0; i < z->s->img_x; ++i) {
-                            out[0] = y[i];
-                            out[1] = coutput[1][i];
-                            out[2] = coutput[2][i];
-                            out[3] = 255;
-                            out += n;
-                        }
-                    }
-                    else {
-                        z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-                    }
-                }
-                else if (z->s->img_n == 4) {
-                    if (z->app14_color_transform == 0) { // CMYK
-                        for (i = 0; i < z->s->img_x; ++i) {
-                            stbi_uc m = coutput[3][i];
-                            out[0] = stbi__blinn_8x8(coutput[0][i], m);
-                            out[1] = stbi__blinn_8x8(coutput[1][i], m);
-                            out[2] = stbi__blinn_8x8(coutput[2][i], m);
-                            out[3] = 255;
-                            out += n;
-                        }
-                    }
-                    else if (z->app14_color_transform == 2) { // YCCK
-                        z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-                        for (i = 0; i < z->s->img_x; ++i) {
-                            stbi_uc m = coutput[3][i];
-                            out[0] = stbi__blinn_8x8(255 - out[0], m);
-                            out[1] = stbi__blinn_8x8(255 - out[1], m);
-                            out[2] = stbi__blinn_8x8(255 - out[2], m);
-                            out += n;
-                        }
-                    }
-                    else { // YCbCr + alpha?  Ignore the fourth channel for now
-                        z->YCbCr_to_RGB_kernel(out, y, coutput[1], coutput[2], z->s->img_x, n);
-                    }
-                }
-                else
-                    for (i = 0; i < z->s->img_x; ++i) {
-                        out[0] = out[1] = out[2] = y[i];
-                        out[3] = 255; // not used if n==3
-                        out += n;
-                    }
+        // now go ahead and resample, in bands of rows on several threads if enabled
+        {
+            stbi__jpeg_convert_job job;
+            int tasks = 0;
+            job.rows_per_task = (z->s->img_y + STBI__JPEG_MAX_TASKS - 1) / STBI__JPEG_MAX_TASKS;
+            if (job.rows_per_task < 16) job.rows_per_task = 16;
+            if (stbi__jpeg_parallel(z) && z->s->img_y > job.rows_per_task)
+                tasks = (int)((z->s->img_y + job.rows_per_task - 1) / job.rows_per_task);
+            job.linebuf = tasks ? (stbi_uc*)stbi__malloc_mad2(tasks * (decode_n + 4), z->s->img_x + 3, 0) : NULL;
+            if (job.linebuf) {
+                job.z = z;
+                job.start = res_comp;
+                job.output = output;
+                job.n = n;
+                job.decode_n = decode_n;
+                job.is_rgb = is_rgb;
+                stbi__jpeg_parallel_run(stbi__jpeg_convert_task, &job, tasks, stbi__jpeg_parallel_user);
+                STBI_FREE(job.linebuf);
             }
             else {
-                if (is_rgb) {
-                    if (n == 1)
-                        for (i = 0; i < z->s->img_x; ++i)
-                            *out++ = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
-                    else {
-                        for (i = 0; i < z->s->img_x; ++i, out += 2) {
-                            out[0] = stbi__compute_y(coutput[0][i], coutput[1][i], coutput[2][i]);
-                            out[1] = 255;
-                        }
-                    }
-                }
-                else if (z->s->img_n == 4 && z->app14_color_transform == 0) {
-                    for (i = 0; i < z->s->img_x; ++i) {
-                        stbi_uc m = coutput[3][i];
-                        stbi_uc r = stbi__blinn_8x8(coutput[0][i], m);
-                        stbi_uc g = stbi__blinn_8x8(coutput[1][i], m);
-                        stbi_uc b = stbi__blinn_8x8(coutput[2][i], m);
-                        out[0] = stbi__compute_y(r, g, b);
-                        out[1] = 255;
-                        out += n;
-                    }
-                }
-                else if (z->s->img_n == 4 && z->app14_color_transform == 2) {
-                    for (i = 0; i < z->s->img_x; ++i) {
-                        out[0] = stbi__blinn_8x8(255 - coutput[0][i], coutput[3][i]);
-                        out[1] = 255;
-                        out += n;
-                    }
-                }
-                else {
-                    stbi_uc* y = coutput[0];
-                    if (n == 1)
-                        for (i = 0; i < z->s->img_x; ++i) out[i] = y[i];
-                    else
-                        for (i = 0; i < z->s->img_x; ++i) { *out++ = y[i]; *out++ = 255; }
-                }
+                stbi_uc* linebuf[4];
+                for (k = 0; k < decode_n; ++k)
+                    linebuf[k] = z->img_comp[k].linebuf;
+                stbi__jpeg_convert_rows(z, res_comp, linebuf, NULL, output, n, decode_n, is_rgb, 0, z->s->img_y);
             }
         }
         stbi__cleanup_jpeg(z);
@@ -4063,6 +4921,7 @@ static void* stbi__jpeg_load(stbi__context* s, int* x, int* y, int* comp, int re
     memset(j, 0, sizeof(stbi__jpeg));
     STBI_NOTUSED(ri);
     j->s = s;
+    j->scale_shift = s->jpeg_scale_shift;
     stbi__setup_jpeg(j);
     result = load_jpeg_image(j, x, y, comp, req_comp);
     STBI_FREE(j);
@@ -4121,6 +4980,9 @@ static int stbi__jpeg_info(stbi__context* s, int* x, int* y, int* comp)
 #define STBI__ZFAST_BITS  9 // accelerate all cases in default tables
 #define STBI__ZFAST_MASK  ((1 << STBI__ZFAST_BITS) - 1)
 #define STBI__ZNSYMS 288 // number of symbols in literal/length alphabet
+// the literal table decodes one or two literals whose codes together fit in this many bits
+#define STBI__ZLIT_BITS   11
+#define STBI__ZLIT_MASK   ((1 << STBI__ZLIT_BITS) - 1)
 
 // zlib-style huffman encoding
 // (jpegs packs from left, zlib from right, so can't share code)
@@ -4198,6 +5060,63 @@ static int stbi__zbuild_huffman(stbi__zhuffman* z, const stbi_uc* sizelist, int
     return 1;
 }
 
+// fills table with an entry for every STBI__ZLIT_BITS-bit input whose next one or two codes of the
+// literal/length alphabet sizelist (num symbols, already accepted by stbi__zbuild_huffman) are
+// literals: bits 0-7 and 8-15 the literals, 16-23 the bits they take, 24-31 how many (0 = none,
+// decode that input symbol by symbol)
+static void stbi__zbuild_literals(stbi__uint32* table, const stbi_uc* sizelist, int num)
+{
+    int i, j, k, n = 0;
+    int code, next_code[16], sizes[16], start[STBI__ZLIT_BITS + 2];
+    stbi_uc sym[256], len[256];
+    stbi__uint16 rev[256];
+
+    memset(table, 0, sizeof(table[0]) << STBI__ZLIT_BITS);
+    memset(sizes, 0, sizeof(sizes));
+    memset(start, 0, sizeof(start));
+    for (i = 0; i < num; ++i)
+        ++sizes[sizelist[i]];
+    sizes[0] = 0;
+    code = 0;
+    for (i = 1; i < 16; ++i) {
+        next_code[i] = code;
+        code = (code + sizes[i]) << 1;
+    }
+    // the short literal codes, bucketed by length so the pairs below stop at the first one too long
+    for (i = 0; i < 256 && i < num; ++i)
+        if (sizelist[i] && sizelist[i] <= STBI__ZLIT_BITS)
+            ++start[sizelist[i] + 1];
+    for (i = 1; i <= STBI__ZLIT_BITS + 1; ++i)
+        start[i] += start[i - 1];
+    for (i = 0; i < num; ++i) {
+        int s = sizelist[i];
+        if (s) {
+            if (i < 256 && s <= STBI__ZLIT_BITS) {
+                k = start[s]++;
+                sym[k] = (stbi_uc)i;
+                len[k] = (stbi_uc)s;
+                rev[k] = (stbi__uint16)stbi__bit_reverse(next_code[s], s);
+                ++n;
+            }
+            ++next_code[s];
+        }
+    }
+    // codes are prefix free, so each literal owns the entries ending in its code and each pair the
+    // ones ending in both; filling the single first leaves the rest of its entries single
+    for (i = 0; i < n; ++i) {
+        int s1 = len[i];
+        stbi__uint32 single = (1u << 24) | ((stbi__uint32)s1 << 16) | sym[i];
+        for (j = rev[i]; j < (1 << STBI__ZLIT_BITS); j += 1 << s1)
+            table[j] = single;
+        for (k = 0; k < n && len[k] <= STBI__ZLIT_BITS - s1; ++k) {
+            int s = s1 + len[k];
+            stbi__uint32 pair = (2u << 24) | ((stbi__uint32)s << 16) | ((stbi__uint32)sym[k] << 8) | sym[i];
+            for (j = rev[i] | (rev[k] << s1); j < (1 << STBI__ZLIT_BITS); j += 1 << s)
+                table[j] = pair;
+        }
+    }
+}
+
 // zlib-from-memory implementation for PNG reading
 //    because PNG allows splitting the zlib stream arbitrarily,
 //    and it's annoying structurally to have PNG call ZLIB call PNG,
@@ -4208,7 +5127,8 @@ typedef struct
 {
     stbi_uc* zbuffer, * zbuffer_end;
     int num_bits;
-    stbi__uint32 code_buffer;
+    int hit_zeof_once;
+    stbi__uint64 code_buffer;   // bits above num_bits are always 0
 
     char* zout;
     char* zout_start;
@@ -4216,6 +5136,7 @@ typedef struct
     int   z_expandable;
 
     stbi__zhuffman z_length, z_distance;
+    stbi__uint32 z_literals[1 << STBI__ZLIT_BITS]; // see stbi__zbuild_literals
 } stbi__zbuf;
 
 stbi_inline static int stbi__zeof(stbi__zbuf* z)
@@ -4228,23 +5149,60 @@ stbi_inline static stbi_uc stbi__zget8(stbi__zbuf* z)
     return stbi__zeof(z) ? 0 : *z->zbuffer++;
 }
 
+// reads whole bytes until the buffer holds more than 56 bits or the data runs out (see
+// stbi__zhuffman_decode for what happens then)
 static void stbi__fill_bits(stbi__zbuf* z)
 {
-    do {
-        if (z->code_buffer >= (1U << z->num_bits)) {
+    while (z->num_bits <= 56 && !stbi__zeof(z)) {
+        if (z->code_buffer >= ((stbi__uint64)1 << z->num_bits)) {
             z->zbuffer = z->zbuffer_end;  /* treat this as EOF so we fail. */
             return;
         }
-        z->code_buffer |= (unsigned int)stbi__zget8(z) << z->num_bits;
+        z->code_buffer |= (stbi__uint64)*z->zbuffer++ << z->num_bits;
         z->num_bits += 8;
-    } while (z->num_bits <= 24);
+    }
+}
+
+stbi_inline static stbi__uint64 stbi__zload64(const stbi_uc* p)
+{
+#if defined(STBI__X86_TARGET) || defined(STBI__X64_TARGET) || defined(_M_ARM64) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    stbi__uint64 v;
+    memcpy(&v, p, 8);
+    return v;
+#else
+    return (stbi__uint64)p[0] | ((stbi__uint64)p[1] << 8) | ((stbi__uint64)p[2] << 16) | ((stbi__uint64)p[3] << 24)
+        | ((stbi__uint64)p[4] << 32) | ((stbi__uint64)p[5] << 40) | ((stbi__uint64)p[6] << 48) | ((stbi__uint64)p[7] << 56);
+#endif
+}
+
+// tops the bit buffer up to at least 56 bits: with 8 input bytes left, one unaligned load that
+// takes as many whole bytes as fit, otherwise a byte at a time as stbi__fill_bits
+stbi_inline static void stbi__zrefill(stbi__zbuf* z)
+{
+    if (z->zbuffer_end - z->zbuffer >= 8) {
+        z->code_buffer |= stbi__zload64(z->zbuffer) << z->num_bits;
+        z->zbuffer += (63 - z->num_bits) >> 3;
+        z->num_bits |= 56;
+        z->code_buffer &= ((stbi__uint64)1 << z->num_bits) - 1; // drop the part of a byte not taken
+    }
+    else
+        stbi__fill_bits(z);
 }
 
 stbi_inline static unsigned int stbi__zreceive(stbi__zbuf* z, int n)
 {
     unsigned int k;
-    if (z->num_bits < n) stbi__fill_bits(z);
-    k = z->code_buffer & ((1 << n) - 1);
+    if (z->num_bits < n) {
+        stbi__zrefill(z);
+        if (z->num_bits < n) {
+            // past the end of the data: return zeros and leave nothing, so the next code fails
+            z->hit_zeof_once = 1;
+            z->code_buffer = 0;
+            z->num_bits = 0;
+            return 0;
+        }
+    }
+    k = (unsigned int)(z->code_buffer & ((1 << n) - 1));
     z->code_buffer >>= n;
     z->num_bits -= n;
     return k;
@@ -4255,7 +5213,7 @@ static int stbi__zhuffman_decode_slowpath(stbi__zbuf* a, stbi__zhuffman* z)
     int b, s, k;
     // not resolved by fast table, so compute it the slow way
     // use jpeg approach, which requires MSbits at top
-    k = stbi__bit_reverse(a->code_buffer, 16);
+    k = stbi__bit_reverse((int)(a->code_buffer & 0xffff), 16);
     for (s = STBI__ZFAST_BITS + 1; ; ++s)
         if (k < z->maxcode[s])
             break;
@@ -4274,9 +5232,15 @@ stbi_inline static int stbi__zhuffman_decode(stbi__zbuf* a, stbi__zhuffman* z)
     int b, s;
     if (a->num_bits < 16) {
         if (stbi__zeof(a)) {
-            return -1;   /* report error for unexpected end of data. */
+            if (a->hit_zeof_once)
+                return -1;   /* report error for unexpected end of data. */
+            // the last code may be shorter than 16 bits: allow 16 implicit zero bits once, which
+            // the end-of-block code must not reach into
+            a->hit_zeof_once = 1;
+            a->num_bits += 16;
         }
-        stbi__fill_bits(a);
+        else
+            stbi__zrefill(a);
     }
     b = z->fast[a->code_buffer & STBI__ZFAST_MASK];
     if (b) {
@@ -4328,7 +5292,23 @@ static int stbi__parse_huffman_block(stbi__zbuf* a)
 {
     char* zout = a->zout;
     for (;;) {
-        int z = stbi__zhuffman_decode(a, &a->z_length);
+        int z;
+        stbi__uint32 literals;
+        // one refill covers a literal pair or a whole length/distance pair (at most 48 bits)
+        if (a->num_bits < 48 && !stbi__zeof(a))
+            stbi__zrefill(a);
+        // with 32 bits in hand neither literal can hit the end-of-data check below
+        literals = a->z_literals[a->code_buffer & STBI__ZLIT_MASK];
+        if (literals && a->num_bits >= 32 && a->zout_end - zout >= 2) {
+            int s = (literals >> 16) & 255;
+            zout[0] = (char)(literals & 255);
+            zout[1] = (char)((literals >> 8) & 255);
+            zout += literals >> 24;
+            a->code_buffer >>= s;
+            a->num_bits -= s;
+            continue;
+        }
+        z = stbi__zhuffman_decode(a, &a->z_length);
         if (z < 256) {
             if (z < 0) return stbi__err("bad huffman code", "Corrupt PNG"); // error in huffman codes
             if (zout >= a->zout_end) {
@@ -4342,6 +5322,7 @@ static int stbi__parse_huffman_block(stbi__zbuf* a)
             int len, dist;
             if (z == 256) {
                 a->zout = zout;
+                if (a->hit_zeof_once && a->num_bits < 16) return stbi__err("unexpected end", "Corrupt PNG");
                 return 1;
             }
             if (z >= 286) return stbi__err("bad huffman code", "Corrupt PNG"); // per DEFLATE, length codes 286 and 287 must not appear in compressed data
@@ -4359,8 +5340,18 @@ static int stbi__parse_huffman_block(stbi__zbuf* a)
             }
             p = (stbi_uc*)(zout - dist);
             if (dist == 1) { // run of one byte; common in images.
-                stbi_uc v = *p;
-                if (len) { do *zout++ = v; while (--len); }
+                memset(zout, *p, len);
+                zout += len;
+            }
+            else if (dist >= 8 && a->zout_end - zout >= len + 16) {
+                // whole chunks, each read entirely from bytes already written; the last may run
+                // up to 15 bytes past the match, into room the next symbols overwrite
+                char* end = zout + len;
+                if (dist >= 16)
+                    do { memcpy(zout, p, 16); zout += 16; p += 16; } while (zout < end);
+                else
+                    do { memcpy(zout, p, 8); zout += 8; p += 8; } while (zout < end);
+                zout = end;
             }
             else {
                 if (len) { do *zout++ = *p++; while (--len); }
@@ -4419,18 +5410,20 @@ static int stbi__compute_huffman_codes(stbi__zbuf* a)
     if (n != ntot) return stbi__err("bad codelengths", "Corrupt PNG");
     if (!stbi__zbuild_huffman(&a->z_length, lencodes, hlit)) return 0;
     if (!stbi__zbuild_huffman(&a->z_distance, lencodes + hlit, hdist)) return 0;
+    stbi__zbuild_literals(a->z_literals, lencodes, hlit);
     return 1;
 }
 
 static int stbi__parse_uncompressed_block(stbi__zbuf* a)
 {
     stbi_uc header[4];
-    int len, nlen, k;
+    int len, nlen, k, buffered;
+    if (a->hit_zeof_once) return stbi__err("unexpected end", "Corrupt PNG");
     if (a->num_bits & 7)
         stbi__zreceive(a, a->num_bits & 7); // discard
     // drain the bit-packed data into header
     k = 0;
-    while (a->num_bits > 0) {
+    while (a->num_bits > 0 && k < 4) {
         header[k++] = (stbi_uc)(a->code_buffer & 255); // suppress MSVC run-time check
         a->code_buffer >>= 8;
         a->num_bits -= 8;
@@ -4442,9 +5435,18 @@ static int stbi__parse_uncompressed_block(stbi__zbuf* a)
     len = header[1] * 256 + header[0];
     nlen = header[3] * 256 + header[2];
     if (nlen != (len ^ 0xffff)) return stbi__err("zlib corrupt", "Corrupt PNG");
-    if (a->zbuffer + len > a->zbuffer_end) return stbi__err("read past buffer", "Corrupt PNG");
+    // the bit buffer can still hold the first bytes of the block (or of the blocks after it)
+    buffered = a->num_bits >> 3;
+    if (buffered > len) buffered = len;
+    if (a->zbuffer + (len - buffered) > a->zbuffer_end) return stbi__err("read past buffer", "Corrupt PNG");
     if (a->zout + len > a->zout_end)
         if (!stbi__zexpand(a, a->zout, len)) return 0;
+    for (k = 0; k < buffered; ++k) {
+        *a->zout++ = (char)(a->code_buffer & 255);
+        a->code_buffer >>= 8;
+        a->num_bits -= 8;
+    }
+    len -= buffered;
     memcpy(a->zout, a->zbuffer, len);
     a->zbuffer += len;
     a->zout += len;
@@ -4501,6 +5503,7 @@ static int stbi__parse_zlib(stbi__zbuf* a, int parse_header)
         if (!stbi__parse_zlib_header(a)) return 0;
     a->num_bits = 0;
     a->code_buffer = 0;
+    a->hit_zeof_once = 0;
     do {
         final = stbi__zreceive(a, 1);
         type = stbi__zreceive(a, 2);
@@ -4515,6 +5518,7 @@ static int stbi__parse_zlib(stbi__zbuf* a, int parse_header)
                 // use fixed code lengths
                 if (!stbi__zbuild_huffman(&a->z_length, stbi__zdefault_length, STBI__ZNSYMS)) return 0;
                 if (!stbi__zbuild_huffman(&a->z_distance, stbi__zdefault_distance, 32)) return 0;
+                stbi__zbuild_literals(a->z_literals, stbi__zdefault_length, STBI__ZNSYMS);
             }
             else {
                 if (!stbi__compute_huffman_codes(a)) return 0;
@@ -4538,7 +5542,7 @@ static int stbi__do_zlib(stbi__zbuf* a, char* obuf, int olen, int exp, int parse
 STBIDEF char* stbi_zlib_decode_malloc_guesssize(const char* buffer, int len, int initial_size, int* outlen)
 {
     stbi__zbuf a;
-    char* p = (char*)stbi__malloc(initial_size);
+    char* p = (char*)stbi__malloc_result(initial_size);
     if (p == NULL) return NULL;
     a.zbuffer = (stbi_uc*)buffer;
     a.zbuffer_end = (stbi_uc*)buffer + len;
@@ -4560,7 +5564,7 @@ STBIDEF char* stbi_zlib_decode_malloc(char const* buffer, int len, int* outlen)
 STBIDEF char* stbi_zlib_decode_malloc_guesssize_headerflag(const char* buffer, int len, int initial_size, int* outlen, int parse_header)
 {
     stbi__zbuf a;
-    char* p = (char*)stbi__malloc(initial_size);
+    char* p = (char*)stbi__malloc_result(initial_size);
     if (p == NULL) return NULL;
     a.zbuffer = (stbi_uc*)buffer;
     a.zbuffer_end = (stbi_uc*)buffer + len;
@@ -4588,7 +5592,7 @@ STBIDEF int stbi_zlib_decode_buffer(char* obuffer, int olen, char const* ibuffer
 STBIDEF char* stbi_zlib_decode_noheader_malloc(char const* buffer, int len, int* outlen)
 {
     stbi__zbuf a;
-    char* p = (char*)stbi__malloc(16384);
+    char* p = (char*)stbi__malloc_result(16384);
     if (p == NULL) return NULL;
     a.zbuffer = (stbi_uc*)buffer;
     a.zbuffer_end = (stbi_uc*)buffer + len;
@@ -4687,10 +5691,104 @@ static int stbi__paeth(int a, int b, int c)
     return c;
 }
 
+#ifdef STBI_SSE2
+// one pixel of n (3 or 4) bytes in the low lanes of a register, and back
+stbi_inline static __m128i stbi__png_load_pixel(const stbi_uc* p, int n)
+{
+    stbi__uint32 v;
+    if (n == 4)
+        memcpy(&v, p, 4);
+    else
+        v = p[0] | (p[1] << 8) | (p[2] << 16);
+    return _mm_cvtsi32_si128((int)v);
+}
+
+stbi_inline static void stbi__png_store_pixel(stbi_uc* p, __m128i x, int n)
+{
+    stbi__uint32 v = (stbi__uint32)_mm_cvtsi128_si32(x);
+    if (n == 4)
+        memcpy(p, &v, 4);
+    else {
+        p[0] = (stbi_uc)v;
+        p[1] = (stbi_uc)(v >> 8);
+        p[2] = (stbi_uc)(v >> 16);
+    }
+}
+
+// SSE2 unfiltering of the nk bytes after a row's first pixel, for rows whose filter works in place
+// with pixels of n bytes: "up" 16 bytes at a time for any n, the others a pixel at a time (each
+// depends on the one to its left) for n = 3 or 4. Returns 0 for rows left to the scalar loops.
+static int stbi__png_unfilter_row_sse2(int filter, stbi_uc* cur, const stbi_uc* prior, const stbi_uc* raw, int nk, int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a, b, c, x;
+    int k;
+    if (filter == STBI__F_up) {
+        for (k = 0; k + 16 <= nk; k += 16) {
+            x = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(raw + k)), _mm_loadu_si128((const __m128i*)(prior + k)));
+            _mm_storeu_si128((__m128i*)(cur + k), x);
+        }
+        for (; k < nk; ++k)
+            cur[k] = STBI__BYTECAST(raw[k] + prior[k]);
+        return 1;
+    }
+    if (n != 3 && n != 4)
+        return 0;
+    a = stbi__png_load_pixel(cur - n, n); // the pixel to the left
+    switch (filter) {
+    case STBI__F_sub:
+    case STBI__F_paeth_first: // paeth(a, 0, 0) is a
+        for (k = 0; k < nk; k += n) {
+            a = _mm_add_epi8(stbi__png_load_pixel(raw + k, n), a);
+            stbi__png_store_pixel(cur + k, a, n);
+        }
+        return 1;
+    case STBI__F_avg:
+    case STBI__F_avg_first: {
+        // (a + b) >> 1 in bytes: the average rounded up, less the low bit that rounding added
+        const __m128i one = _mm_set1_epi8(1);
+        for (k = 0; k < nk; k += n) {
+            b = filter == STBI__F_avg ? stbi__png_load_pixel(prior + k, n) : zero;
+            x = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+            a = _mm_add_epi8(stbi__png_load_pixel(raw + k, n), x);
+            stbi__png_store_pixel(cur + k, a, n);
+        }
+        return 1;
+    }
+    case STBI__F_paeth:
+        // stbi__paeth in 16-bit lanes: with p = a + b - c, pa = |b - c|, pb = |a - c| and
+        // pc = |(b - c) + (a - c)|; a wins ties, then b
+        a = _mm_unpacklo_epi8(a, zero);
+        c = _mm_unpacklo_epi8(stbi__png_load_pixel(prior - n, n), zero);
+        for (k = 0; k < nk; k += n) {
+            __m128i pa, pb, pc, smallest, pick;
+            b = _mm_unpacklo_epi8(stbi__png_load_pixel(prior + k, n), zero);
+            pa = _mm_sub_epi16(b, c);
+            pb = _mm_sub_epi16(a, c);
+            pc = _mm_add_epi16(pa, pb);
+            pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+            pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+            pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+            smallest = _mm_min_epi16(pa, _mm_min_epi16(pb, pc));
+            pick = _mm_cmpeq_epi16(pb, smallest);
+            x = _mm_or_si128(_mm_and_si128(pick, b), _mm_andnot_si128(pick, c));
+            pick = _mm_cmpeq_epi16(pa, smallest);
+            x = _mm_or_si128(_mm_and_si128(pick, a), _mm_andnot_si128(pick, x));
+            a = _mm_add_epi8(stbi__png_load_pixel(raw + k, n), _mm_packus_epi16(x, zero));
+            stbi__png_store_pixel(cur + k, a, n);
+            a = _mm_unpacklo_epi8(a, zero);
+            c = b;
+        }
+        return 1;
+    }
+    return 0;
+}
+#endif
+
 static const stbi_uc stbi__depth_scale_table[9] = { 0, 0xff, 0x55, 0, 0x11, 0,0,0, 0x01 };
 
-// create the png data from post-deflated data
-static int stbi__create_png_image_raw(stbi__png* a, stbi_uc* raw, stbi__uint32 raw_len, int out_n, stbi__uint32 x, stbi__uint32 y, int depth, int color)
+// create the png data from post-deflated data; in_place if raw is a->expanded and may be reused
+static int stbi__create_png_image_raw(stbi__png* a, stbi_uc* raw, stbi__uint32 raw_len, int out_n, stbi__uint32 x, stbi__uint32 y, int depth, int color, int in_place)
 {
     int bytes = (depth == 16 ? 2 : 1);
     stbi__context* s = a->s;
@@ -4702,10 +5800,22 @@ static int stbi__create_png_image_raw(stbi__png* a, stbi_uc* raw, stbi__uint32 r
     int output_bytes = out_n * bytes;
     int filter_bytes = img_n * bytes;
     int width = x;
+#ifdef STBI_SSE2
+    int sse2 = stbi__sse2_available();
+#endif
 
     STBI_ASSERT(out_n == s->img_n || out_n == s->img_n + 1);
-    a->out = (stbi_uc*)stbi__malloc_mad3(x, y, output_bytes, 0); // extra bytes to write off the end into
-    if (!a->out) return stbi__err("outofmem", "Out of memory");
+    if (in_place && depth >= 8 && img_n == out_n) {
+        // rows keep their layout apart from the filter byte, so unfilter them where they are: row j
+        // moves j + 1 bytes down, over bytes already read, and no second image-sized buffer is
+        // touched
+        a->out = raw;
+        a->expanded = NULL;
+    }
+    else {
+        a->out = (stbi_uc*)stbi__malloc_result_mad3(x, y, output_bytes, 0); // extra bytes to write off the end into
+        if (!a->out) return stbi__err("outofmem", "Out of memory");
+    }
 
     if (!stbi__mad3sizes_valid(img_n, x, depth, 7)) return stbi__err("too large", "Corrupt PNG");
     img_width_bytes = (((img_n * x * depth) + 7) >> 3);
@@ -4773,12 +5883,18 @@ static int stbi__create_png_image_raw(stbi__png* a, stbi_uc* raw, stbi__uint32 r
         // this is a little gross, so that we don't switch per-pixel or per-component
         if (depth < 8 || img_n == out_n) {
             int nk = (width - 1) * filter_bytes;
+#ifdef STBI_SSE2
+            if (sse2 && filter != STBI__F_none && stbi__png_unfilter_row_sse2(filter, cur, prior, raw, nk, filter_bytes)) {
+                raw += nk;
+                continue;
+            }
+#endif
 #define STBI__CASE(f) \
              case f:     \
                 for (k=0; k < nk; ++k)
             switch (filter) {
                 // "none" filter turns into a memcpy here; make that explicit.
-            case STBI__F_none:         memcpy(cur, raw, nk); break;
+            case STBI__F_none:         memmove(cur, raw, nk); break;
                 STBI__CASE(STBI__F_sub) { cur[k] = STBI__BYTECAST(raw[k] + cur[k - filter_bytes]); } break;
                 STBI__CASE(STBI__F_up) { cur[k] = STBI__BYTECAST(raw[k] + prior[k]); } break;
                 STBI__CASE(STBI__F_avg) { cur[k] = STBI__BYTECAST(raw[k] + ((prior[k] + cur[k - filter_bytes]) >> 1)); } break;
@@ -4916,10 +6032,10 @@ static int stbi__create_png_image(stbi__png* a, stbi_uc* image_data, stbi__uint3
     stbi_uc* final;
     int p;
     if (!interlaced)
-        return stbi__create_png_image_raw(a, image_data, image_data_len, out_n, a->s->img_x, a->s->img_y, depth, color);
+        return stbi__create_png_image_raw(a, image_data, image_data_len, out_n, a->s->img_x, a->s->img_y, depth, color, image_data == a->expanded);
 
     // de-interlacing
-    final = (stbi_uc*)stbi__malloc_mad3(a->s->img_x, a->s->img_y, out_bytes, 0);
+    final = (stbi_uc*)stbi__malloc_result_mad3(a->s->img_x, a->s->img_y, out_bytes, 0);
     if (!final) return stbi__err("outofmem", "Out of memory");
     for (p = 0; p < 7; ++p) {
         int xorig[] = { 0,4,0,2,0,1,0 };
@@ -4932,7 +6048,7 @@ static int stbi__create_png_image(stbi__png* a, stbi_uc* image_data, stbi__uint3
         y = (a->s->img_y - yorig[p] + yspc[p] - 1) / yspc[p];
         if (x && y) {
             stbi__uint32 img_len = ((((a->s->img_n * x * depth) + 7) >> 3) + 1) * y;
-            if (!stbi__create_png_image_raw(a, image_data, image_data_len, out_n, x, y, depth, color)) {
+            if (!stbi__create_png_image_raw(a, image_data, image_data_len, out_n, x, y, depth, color, 0)) {
                 STBI_FREE(final);
                 return 0;
             }
@@ -5011,7 +6127,7 @@ static int stbi__expand_png_palette(stbi__png* a, stbi_uc* palette, int len, int
     stbi__uint32 i, pixel_count = a->s->img_x * a->s->img_y;
     stbi_uc* p, * temp_out, * orig = a->out;
 
-    p = (stbi_uc*)stbi__malloc_mad2(pixel_count, pal_img_n, 0);
+    p = (stbi_uc*)stbi__malloc_result_mad3(pixel_count, pal_img_n, 1, 0);
     if (p == NULL) return stbi__err("outofmem", "Out of memory");
 
     // between here and free(out) below, exitting would leak
@@ -0,0 +1,1248 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+
+#include "stb_image.h"
+
+#include <decoded_image_cache.h>
+#include <image_loader.h>
+#include <mipmap.h>
+#include <pixel_buffer_ring.h>
+#include <texture_manifest.h>
+#include <texture_pack.h>
+#include <thread_pool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+// S3TC (BC1/BC3) is an extension rather than core GL, so the core loader does not define these
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// How a texture is sampled and loaded; part of the cache key, so the same image with different
+// settings is a different texture
+struct TextureSettings
+{
+    GLint wrapS = GL_REPEAT;
+    GLint wrapT = GL_REPEAT;
+    GLint minFilter = GL_LINEAR;
+    GLint magFilter = GL_LINEAR;
+    bool flip = true;           // flip rows on load so the first row is the bottom of the image
+    int maxSize = 0;            // largest width or height to load (halving as needed), 0 for no limit
+
+    bool operator<(const TextureSettings& other) const
+    {
+        return std::tie(wrapS, wrapT, minFilter, magFilter, flip, maxSize)
+            < std::tie(other.wrapS, other.wrapT, other.minFilter, other.magFilter, other.flip, other.maxSize);
+    }
+    bool operator==(const TextureSettings& other) const
+    {
+        return std::tie(wrapS, wrapT, minFilter, magFilter, flip, maxSize)
+            == std::tie(other.wrapS, other.wrapT, other.minFilter, other.magFilter, other.flip, other.maxSize);
+    }
+};
+
+// GPU memory held by TextureCache, refreshed by every update(); the last three count what that
+// update did to stay within the budget
+struct TextureResidency
+{
+    size_t budgetBytes = 0;     // 0 when there is no budget
+    size_t residentBytes = 0;   // every level currently allocated, placeholders excluded
+    size_t residentTextures = 0;
+    size_t droppedLevels = 0;   // top mip levels currently released, over all textures
+    size_t evictions = 0;       // textures sent back to their placeholder
+    size_t drops = 0;           // top mip levels released
+    size_t restores = 0;        // textures reloading their released levels
+};
+
+// Loads 2D textures once per (path, settings) pair and hands out reference-counted GL names.
+// Textures can be requested directly with acquire() or listed in a manifest file (see
+// texture_manifest.h for the format); manifest names with layer suffixes become one
+// GL_TEXTURE_2D_ARRAY per name instead.
+//
+// Manifest textures are loaded on demand: loadManifest() only binds every name to a 1x1 grey
+// placeholder texture, and a texture is loaded the first time use() reports a visible draw
+// referencing it. Textures found in a texture pack (usePack(), baked offline by texbake) are then
+// uploaded level by level straight from the mapped pack. The rest are streamed: images are
+// decoded on a worker pool, and update() (called once per frame on the GL thread) copies decoded
+// rows through a ring of pixel buffer objects within a byte budget. The GL name never changes; a
+// texture switches from placeholder to image when the last row of its last layer has arrived, and
+// back to the placeholder when it has gone unused for the setIdleEviction() number of frames.
+// flush() finishes everything at once for callers that cannot wait.
+//
+// With setMemoryBudget() update() also keeps the textures' GPU memory under a byte budget, taking
+// memory from the least recently used first: textures no visible draw used last frame go back to
+// their placeholder, and if that is not enough the ones in use lose their largest mip levels
+// (sampling moves down the chain) until the budget is met. Released levels are reloaded once
+// they fit again. residency() reports the counters.
+//
+// Mip chains are built on the CPU by the thread that decoded the image (see mipmap.h) and every
+// level is uploaded explicitly, so no path calls glGenerateMipmap and the result does not depend
+// on the driver's filter. With useDiskCache() the decoded levels are also kept on disk, and later
+// runs map them instead of decoding (see decoded_image_cache.h).
+//
+// A texture with a maxSize (per manifest line, or for every texture with setMaxTextureSize()) is
+// loaded without the levels above that size: JPEGs are decoded straight to 1/2, 1/4 or 1/8 size
+// with stb_image's reduced IDCT, and any halving still needed is taken from the mip chain.
+class TextureCache
+{
+public:
+    // returns the texture for path with the given settings, loading it synchronously on first use;
+    // every successful call must be paired with release(). Returns 0 if the image cannot be loaded.
+    // A texture that is still streaming is returned as is and becomes resident later.
+    unsigned int acquire(const std::string& path, const TextureSettings& settings)
+    {
+        Key key(path, capped(settings));
+        std::map<Key, Entry>::iterator it = entries.find(key);
+        if (it != entries.end())
+        {
+            if (it->second.lazy && !it->second.requested)
+                request(it);
+            ++it->second.refCount;
+            return it->second.ID;
+        }
+
+        DecodedImage image;
+        if (!decode(path, settings.flip, key.second.maxSize, image, &diskCache))
+        {
+            std::cout << image.error << std::endl;
+            return 0;
+        }
+        Entry entry;
+        upload(image, key.second, entry);
+        entry.refCount = 1;
+        it = entries.emplace(key, entry).first;
+        byID[entry.ID] = it;
+        return entry.ID;
+    }
+
+    // drops one reference; the GL texture is deleted with the last one
+    void release(unsigned int id)
+    {
+        for (std::map<Key, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+        {
+            if (it->second.ID != id)
+                continue;
+            if (--it->second.refCount == 0)
+            {
+                // a decode still in flight is dropped when it arrives and finds no entry
+                for (std::vector<Upload>::iterator upload = uploads.begin(); upload != uploads.end();)
+                {
+                    if (upload->ID == id)
+                    {
+                        freeImage(upload->image);
+                        upload = uploads.erase(upload);
+                    }
+                    else
+                        ++upload;
+                }
+                if (it->second.baked)
+                    --bakedCount;
+                byID.erase(id);
+                glDeleteTextures(1, &it->second.ID);
+                entries.erase(it);
+            }
+            return;
+        }
+    }
+
+    // acquires every texture listed in the manifest under its name, registering the ones not known
+    // yet with a placeholder to be loaded on their first use(); returns false if the file cannot be
+    // read or has a malformed line or array. Textures that fail to decode are reported and keep a
+    // black placeholder.
+    bool loadManifest(const std::string& manifestPath)
+    {
+        std::vector<ManifestEntry> manifest;
+        bool ok = readTextureManifest(manifestPath, manifest);
+
+        // register everything not known yet, then hand out one reference per manifest name
+        if (!pool)
+        {
+            pool.reset(new ThreadPool());
+            useDecodePool(pool.get());
+        }
+        std::map<std::string, std::vector<const ManifestEntry*>> arrays;
+        for (const ManifestEntry& item : manifest)
+        {
+            if (item.layer >= 0)
+            {
+                // layers are gathered first; each array becomes one texture below
+                std::vector<const ManifestEntry*>& layers = arrays[item.name];
+                if (layers.size() <= static_cast<size_t>(item.layer))
+                    layers.resize(item.layer + 1, nullptr);
+                layers[item.layer] = &item;
+                continue;
+            }
+            Key key(item.path, settingsFor(item));
+            std::map<Key, Entry>::iterator it = entries.find(key);
+            if (it == entries.end())
+                it = registerTexture(key, GL_TEXTURE_2D, std::vector<LayerSource>(1, LayerSource{ item.path, item.flip, key.second.maxSize }));
+            ++it->second.refCount;
+            named[item.name] = it->second.ID;
+        }
+
+        for (const std::pair<const std::string, std::vector<const ManifestEntry*>>& array : arrays)
+        {
+            // every layer from 0 up must be present, and the sampler settings and size limit are
+            // per texture
+            const std::vector<const ManifestEntry*>& layers = array.second;
+            bool valid = layers.size() <= MAX_ARRAY_LAYERS;
+            std::vector<LayerSource> sources;
+            for (const ManifestEntry* layer : layers)
+            {
+                valid = valid && layer && layer->wrap == layers[0]->wrap && layer->filter == layers[0]->filter
+                    && layer->maxSize == layers[0]->maxSize;
+                if (valid)
+                    sources.push_back(LayerSource{ layer->path, layer->flip, settingsFor(*layer).maxSize });
+            }
+            if (!valid)
+            {
+                std::cout << "ERROR::TEXTURE_CACHE::BAD_ARRAY: " << manifestPath << ": " << array.first
+                    << " needs layers 0.." << layers.size() - 1 << " with the same wrap, filter and max" << std::endl;
+                ok = false;
+                continue;
+            }
+
+            Key key(array.first + "[" + std::to_string(layers.size()) + "]", settingsFor(*layers[0]));
+            std::map<Key, Entry>::iterator it = entries.find(key);
+            if (it == entries.end())
+                it = registerTexture(key, GL_TEXTURE_2D_ARRAY, sources);
+            ++it->second.refCount;
+            named[array.first] = it->second.ID;
+        }
+        // update() must not allocate once frames are running, even with every texture streaming
+        uploads.reserve(registeredLayers);
+        return ok;
+    }
+
+    // marks the texture as referenced by a draw that is visible this frame; a manifest texture that
+    // is not loaded starts loading now. Call it for every visible draw, every frame, since textures
+    // that stop being used are evicted.
+    void use(unsigned int id)
+    {
+        std::map<unsigned int, std::map<Key, Entry>::iterator>::iterator it = byID.find(id);
+        if (it == byID.end())
+            return;
+        Entry& entry = it->second->second;
+        entry.lastUsed = frameIndex;
+        if (entry.lazy && !entry.requested)
+            request(it->second);
+    }
+
+    // frames a manifest texture may go without a use() before update() evicts it back to its
+    // placeholder, freeing its GPU memory until it is used again; 0 (the default) never evicts
+    void setIdleEviction(uint64_t frames)
+    {
+        idleFrames = frames;
+    }
+
+    // GPU bytes update() keeps manifest textures within; 0 (the default) means no limit
+    void setMemoryBudget(size_t bytes)
+    {
+        memoryBudget = bytes;
+    }
+
+    // largest width or height any texture is loaded at from now on, on top of each texture's own
+    // maxSize (the smaller wins); 0 (the default) means no limit. Textures already registered keep
+    // the size they have.
+    void setMaxTextureSize(int size)
+    {
+        maxTextureSize = size > 0 ? size : 0;
+    }
+
+    // residency counters as of the last update()
+    const TextureResidency& residency() const
+    {
+        return residencyStats;
+    }
+
+    // maps a texture pack whose entries loadManifest() then prefers over decoding the sources;
+    // false if the pack is missing or invalid (everything is decoded as usual)
+    bool usePack(const std::string& packPath)
+    {
+        return pack.open(packPath);
+    }
+
+    // keeps decoded images (with their mip chains) in directory, at most maxBytes of them, and
+    // maps them from there instead of decoding on later runs; false if the directory is unusable
+    bool useDiskCache(const std::string& directory, uint64_t maxBytes)
+    {
+        return diskCache.open(directory, maxBytes);
+    }
+
+    // starts a new frame: evicts idle textures and moves decoded images to the GPU, at most about
+    // byteBudget bytes per call and without ever waiting on the GPU. Returns true on the call that
+    // made the last texture of a batch resident.
+    bool update(size_t byteBudget)
+    {
+        ++frameIndex;
+        residencyStats.evictions = residencyStats.drops = residencyStats.restores = 0;
+        if (idleFrames > 0)
+            evictIdle();
+        if (memoryBudget > 0)
+            enforceBudget();
+        bool finished = pump(byteBudget, false);
+        countResidency();
+        return finished;
+    }
+
+    // blocks until every streamed texture is resident; returns true if that finished a batch
+    bool flush()
+    {
+        bool finished = false;
+        while (pendingDecodes > 0 || !uploads.empty())
+        {
+            if (uploads.empty())
+                receive(decoded.pop());
+            finished = pump(SIZE_MAX, true);
+        }
+        if (batchOpen)
+            finished = pump(SIZE_MAX, true); // textures loaded from the pack, nothing streamed
+        return finished;
+    }
+
+    // texture registered under name by loadManifest(), or 0 if it is unknown or failed to load
+    unsigned int get(std::string_view name) const
+    {
+        std::map<std::string, unsigned int, std::less<>>::const_iterator it = named.find(name);
+        return it != named.end() ? it->second : 0;
+    }
+
+    // one line per loaded texture with its decode/mip/upload cost and GPU footprint. Upload time
+    // is the time spent submitting uploads, not waiting for the GPU.
+    void writeReport(std::ostream& out) const
+    {
+        double decodeMs = 0.0, mipMs = 0.0, uploadMs = 0.0;
+        size_t gpuBytes = 0;
+        size_t loaded = 0;
+        for (const std::pair<const Key, Entry>& item : entries)
+            loaded += !item.second.lazy || item.second.requested ? 1 : 0;
+        out << "Textures (" << entries.size() << ", " << loaded << " loaded, " << bakedCount << " from pack, " << evictedCount
+            << " evicted), last batch " << std::fixed << std::setprecision(2)
+            << batchWallMs << " ms wall on " << (pool ? pool->size() : 0) << " decode thread(s):" << std::endl;
+        for (const std::pair<const Key, Entry>& item : entries)
+        {
+            const Entry& entry = item.second;
+            if (!entry.resident)
+            {
+                const char* state = entry.missing ? "  missing" : (entry.lazy && !entry.requested ? "  not loaded" : "  placeholder");
+                out << "  " << std::left << std::setw(32) << item.first.first << std::right << state << std::endl;
+                continue;
+            }
+            out << "  " << std::left << std::setw(32) << item.first.first << std::right
+                << std::setw(5) << entry.width << "x" << std::left << std::setw(5) << entry.height << std::right
+                << " refs " << entry.refCount
+                << "  decode " << std::fixed << std::setprecision(2) << std::setw(7) << entry.decodeMs << " ms"
+                << "  mips " << std::setw(6) << entry.mipMs << " ms"
+                << "  upload " << std::setw(7) << entry.uploadMs << " ms"
+                << "  gpu " << std::setw(8) << entry.gpuBytes / 1024 << " KiB" << (entry.baked ? "  (pack)" : "")
+                << (entry.cachedLayers == entry.layers ? "  (disk cache)" : "")
+                << (entry.baseLevel > 0 ? "  (from level " + std::to_string(entry.baseLevel) + ")" : "")
+                << (item.first.second.maxSize > 0 ? "  (max " + std::to_string(item.first.second.maxSize) + ")" : "") << std::endl;
+            decodeMs += entry.decodeMs;
+            mipMs += entry.mipMs;
+            uploadMs += entry.uploadMs;
+            gpuBytes += entry.gpuBytes;
+        }
+        out << "  total decode " << decodeMs << " ms, mips " << mipMs << " ms, upload " << uploadMs << " ms, gpu "
+            << gpuBytes / 1024 << " KiB" << std::defaultfloat << std::endl;
+        if (memoryBudget > 0)
+        {
+            out << "  memory budget " << memoryBudget / 1024 << " KiB, " << residencyStats.droppedLevels << " level(s) released, "
+                << droppedCount << " level drop(s), " << restoredCount << " restore(s)" << std::endl;
+        }
+        if (diskCache.isOpen())
+        {
+            out << "  decoded-image cache: " << diskCache.hits() << " hit(s), " << diskCache.misses() << " miss(es), "
+                << diskCache.stores() << " stored, " << diskCache.bytes() / 1024 << " of " << diskCache.maxBytes() / 1024
+                << " KiB on disk" << std::endl;
+        }
+    }
+
+    // deletes every texture regardless of outstanding references (call before the context goes away)
+    void clear()
+    {
+        pool.reset(); // finishes queued decodes and joins the workers
+        useDecodePool(nullptr);
+        StreamedImage result;
+        while (decoded.tryPop(result))
+            freeImage(result.image);
+        for (Upload& upload : uploads)
+            freeImage(upload.image);
+        uploads.clear();
+        pendingDecodes = 0;
+        ring.destroy();
+
+        for (std::pair<const Key, Entry>& item : entries)
+            glDeleteTextures(1, &item.second.ID);
+        entries.clear();
+        byID.clear();
+        named.clear();
+        registeredLayers = 0;
+        batchOpen = false;
+        pack.close();
+        bakedCount = 0;
+    }
+
+private:
+    typedef std::pair<std::string, TextureSettings> Key;
+
+    // where one layer of a texture comes from
+    struct LayerSource
+    {
+        std::string path;
+        bool flip;
+        int maxSize;    // 0 for the size as stored
+    };
+
+    struct Entry
+    {
+        unsigned int ID = 0;
+        GLenum target = GL_TEXTURE_2D; // or GL_TEXTURE_2D_ARRAY
+        int layers = 1;
+        int layersLeft = 0;     // layers still streaming
+        int cachedLayers = 0;   // layers mapped from the decoded-image cache
+        int refCount = 0;
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        double decodeMs = 0.0;
+        double mipMs = 0.0;
+        double uploadMs = 0.0;
+        size_t gpuBytes = 0;
+        bool resident = false;  // false while the placeholder is showing
+        bool missing = false;   // the image failed to decode; the placeholder stays
+        bool baked = false;     // uploaded from the texture pack
+        bool lazy = false;      // registered by a manifest: loaded on first use, evictable
+        bool requested = false; // loading started (always true for textures that are not lazy)
+        uint64_t lastUsed = 0;  // frame of the last use()
+        int baseLevel = 0;      // top levels released to stay within the memory budget
+        PackFormat packFormat = PACK_RGBA8; // format of the levels if baked
+        std::vector<LayerSource> sources;
+    };
+
+    // pixels decoded by a worker, waiting for the GL thread to upload them; release with freeImage()
+    struct DecodedImage
+    {
+        const unsigned char* pixels = nullptr;      // level 0
+        const unsigned char* mipLevels = nullptr;   // levels 1 and below, laid out by buildMipChain()
+        unsigned char* decoded = nullptr;           // stb_image allocation behind pixels after a decode
+        std::vector<unsigned char> mips;            // storage behind mipLevels after a decode
+        std::unique_ptr<MappedFile> cached;         // storage behind both after a disk cache hit
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        double decodeMs = 0.0;
+        double mipMs = 0.0;
+        std::string error;      // set when pixels is null
+    };
+
+    // a finished decode on its way from a worker to the GL thread
+    struct StreamedImage
+    {
+        Key key;
+        unsigned int ID = 0;
+        int layer = 0;
+        DecodedImage image;
+    };
+
+    // a texture layer whose levels are copied to the GPU row by row over one or more frames
+    struct Upload
+    {
+        Key key;
+        unsigned int ID = 0;
+        GLenum target = GL_TEXTURE_2D;
+        int layer = 0;
+        GLenum format = GL_RGBA;
+        DecodedImage image;
+        int level = 0;          // level being copied, its size and where it starts in image.mipLevels
+        int levelWidth = 0;
+        int levelHeight = 0;
+        size_t levelOffset = 0;
+        int nextRow = 0;
+        double uploadMs = 0.0;
+
+        const unsigned char* levelPixels() const
+        {
+            return level == 0 ? image.pixels : image.mipLevels + levelOffset;
+        }
+    };
+
+    // PBO ring sizing: each buffer carries one band of rows per transfer
+    static const int UPLOAD_BUFFERS = 4;
+    static const size_t UPLOAD_CHUNK_BYTES = 4 * 1024 * 1024;
+    // GL guarantees at least this many array layers
+    static const size_t MAX_ARRAY_LAYERS = 256;
+    // the memory budget never releases a level whose next level is smaller than this on both sides
+    static const int MIN_RESIDENT_SIZE = 64;
+
+    std::map<Key, Entry> entries;
+    std::map<unsigned int, std::map<Key, Entry>::iterator> byID;
+    std::map<std::string, unsigned int, std::less<>> named;
+    std::unique_ptr<ThreadPool> pool;
+    WorkQueue<StreamedImage> decoded;
+    std::vector<Upload> uploads;    // in arrival order; only the front one is being copied
+    PixelBufferRing ring;
+    size_t pendingDecodes = 0;
+    std::chrono::steady_clock::time_point batchStart;
+    bool batchOpen = false;         // a texture was requested since the last finished batch
+    double batchWallMs = 0.0;
+    TexturePack pack;
+    size_t bakedCount = 0;
+    DecodedImageCache diskCache;
+    uint64_t frameIndex = 0;        // update() calls so far
+    uint64_t idleFrames = 0;
+    size_t evictedCount = 0;
+    size_t registeredLayers = 0;
+    size_t memoryBudget = 0;
+    int maxTextureSize = 0;         // setMaxTextureSize(), 0 for none
+    size_t droppedCount = 0;
+    size_t restoredCount = 0;
+    TextureResidency residencyStats;
+    int s3tcSupported = -1;         // -1 until the extension list has been checked
+
+    // whether the context can sample a pack format; BC7 (BPTC) is core since GL 4.2, S3TC is an
+    // extension. Unsupported entries are decoded from their sources instead.
+    bool formatSupported(uint32_t format)
+    {
+        if (format != PACK_BC1 && format != PACK_BC3)
+            return true;
+        if (s3tcSupported < 0)
+        {
+            s3tcSupported = 0;
+            GLint count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (GLint i = 0; i < count && !s3tcSupported; ++i)
+            {
+                const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+                s3tcSupported = name && std::string_view(name) == "GL_EXT_texture_compression_s3tc";
+            }
+        }
+        return s3tcSupported != 0;
+    }
+
+    // creates the placeholder texture for a manifest texture, which is loaded on its first use()
+    std::map<Key, Entry>::iterator registerTexture(const Key& key, GLenum target, const std::vector<LayerSource>& sources)
+    {
+        static const unsigned char grey[4] = { 128, 128, 128, 255 };
+        Entry entry;
+        entry.target = target;
+        entry.layers = static_cast<int>(sources.size());
+        entry.lazy = true;
+        entry.sources = sources;
+        glGenTextures(1, &entry.ID);
+        glBindTexture(target, entry.ID);
+        applySettings(target, key.second);
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, 0);
+        specifyTexel(target, 0, GL_RGBA, entry.layers, grey);
+        glBindTexture(target, 0);
+        registeredLayers += sources.size();
+
+        std::map<Key, Entry>::iterator it = entries.emplace(key, entry).first;
+        byID[entry.ID] = it;
+        return it;
+    }
+
+    // loads a registered texture from the pack when every layer is baked there with the same format
+    // and size, otherwise starts streaming it from the source images
+    void request(std::map<Key, Entry>::iterator it)
+    {
+        Entry& entry = it->second;
+        entry.requested = true;
+        if (!batchOpen)
+            batchStart = std::chrono::steady_clock::now();
+        batchOpen = true;
+        std::vector<const PackTexture*> baked;
+        for (const LayerSource& source : entry.sources)
+        {
+            const PackTexture* texture = pack.isOpen() ? pack.find(source.path, source.flip) : nullptr;
+            // a pack baked without the size limit would upload the levels the limit drops
+            if (!texture || !formatSupported(texture->format)
+                || (source.maxSize > 0 && std::max(texture->levels[0].width, texture->levels[0].height) > static_cast<uint32_t>(source.maxSize)))
+                break;
+            if (!baked.empty() && (texture->format != baked[0]->format || texture->levelCount != baked[0]->levelCount
+                || texture->levels[0].width != baked[0]->levels[0].width || texture->levels[0].height != baked[0]->levels[0].height))
+                break;
+            baked.push_back(texture);
+        }
+        if (baked.size() == entry.sources.size())
+            loadBaked(it, baked);
+        else
+            startStreaming(it);
+    }
+
+    // drops a loaded texture's levels and puts its placeholder back, keeping its GL name; it is
+    // loaded again on its next use()
+    void evict(Entry& entry)
+    {
+        static const unsigned char grey[4] = { 128, 128, 128, 255 };
+        glBindTexture(entry.target, entry.ID);
+        if (entry.width > 0)
+        {
+            // zero-sized levels release their storage
+            int lastLevel = mipLevelCount(entry.width, entry.height) - 1;
+            for (int level = 1; level <= lastLevel; ++level)
+            {
+                if (entry.target == GL_TEXTURE_2D_ARRAY)
+                    glTexImage3D(entry.target, level, GL_RGBA, 0, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+                else
+                    glTexImage2D(entry.target, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            }
+        }
+        glTexParameteri(entry.target, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(entry.target, GL_TEXTURE_MAX_LEVEL, 0);
+        specifyTexel(entry.target, 0, GL_RGBA, entry.layers, grey);
+        glBindTexture(entry.target, 0);
+
+        if (entry.baked)
+            --bakedCount;
+        ++evictedCount;
+        ++residencyStats.evictions;
+        entry.width = entry.height = entry.channels = 0;
+        entry.baseLevel = 0;
+        entry.cachedLayers = 0;
+        entry.decodeMs = entry.mipMs = entry.uploadMs = 0.0;
+        entry.gpuBytes = 0;
+        entry.resident = entry.missing = entry.baked = false;
+        entry.requested = false;
+    }
+
+    // whether update() may evict the texture or release its levels: a loaded manifest texture
+    bool evictable(const Entry& entry) const
+    {
+        return entry.lazy && entry.requested && entry.layersLeft == 0;
+    }
+
+    // evicts every loaded manifest texture that has gone idleFrames frames without a use()
+    void evictIdle()
+    {
+        for (std::pair<const Key, Entry>& item : entries)
+        {
+            Entry& entry = item.second;
+            if (evictable(entry) && frameIndex - entry.lastUsed > idleFrames)
+                evict(entry);
+        }
+    }
+
+    // GPU bytes of one mip level over all layers, as allocated when the texture was loaded
+    static size_t levelBytes(const Entry& entry, int level)
+    {
+        int width = entry.width, height = entry.height;
+        for (int i = 0; i < level; ++i)
+            mipLevelSize(width, height, width, height);
+        size_t bytes = entry.baked ? static_cast<size_t>(packLevelBytes(entry.packFormat, width, height))
+            : static_cast<size_t>(width) * height * entry.channels;
+        return bytes * entry.layers;
+    }
+
+    // bytes in use by every texture, placeholders excluded
+    size_t residentBytes() const
+    {
+        size_t total = 0;
+        for (const std::pair<const Key, Entry>& item : entries)
+            total += item.second.gpuBytes;
+        return total;
+    }
+
+    // releases the largest level of a texture and moves sampling down to the next one
+    void dropTopLevel(Entry& entry)
+    {
+        glBindTexture(entry.target, entry.ID);
+        glTexParameteri(entry.target, GL_TEXTURE_BASE_LEVEL, entry.baseLevel + 1);
+        if (entry.target == GL_TEXTURE_2D_ARRAY)
+            glTexImage3D(entry.target, entry.baseLevel, GL_RGBA, 0, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        else
+            glTexImage2D(entry.target, entry.baseLevel, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glBindTexture(entry.target, 0);
+        entry.gpuBytes -= levelBytes(entry, entry.baseLevel);
+        ++entry.baseLevel;
+        ++droppedCount;
+        ++residencyStats.drops;
+    }
+
+    // brings resident bytes back under memoryBudget, least recently used first: whole textures no
+    // draw used last frame, then top levels of the ones in use, never below MIN_RESIDENT_SIZE. Once
+    // there is room again, reloads the released levels of one texture in use per call.
+    void enforceBudget()
+    {
+        size_t total = residentBytes();
+        while (total > memoryBudget)
+        {
+            Entry* victim = nullptr;
+            bool whole = false;
+            for (std::pair<const Key, Entry>& item : entries)
+            {
+                Entry& entry = item.second;
+                if (!evictable(entry) || entry.gpuBytes == 0)
+                    continue;
+                bool idle = entry.lastUsed + 1 < frameIndex;
+                int width = entry.width, height = entry.height;
+                for (int level = 0; level <= entry.baseLevel; ++level)
+                    mipLevelSize(width, height, width, height);
+                bool droppable = std::max(width, height) >= MIN_RESIDENT_SIZE;
+                if (!idle && !droppable)
+                    continue;
+                // idle textures go first, then the least recently used, then the largest
+                bool better = !victim || (idle && !whole)
+                    || (idle == whole && (entry.lastUsed < victim->lastUsed
+                        || (entry.lastUsed == victim->lastUsed && entry.gpuBytes > victim->gpuBytes)));
+                if (better)
+                {
+                    victim = &entry;
+                    whole = idle;
+                }
+            }
+            if (!victim)
+                return; // everything left is in use at its smallest allowed size
+            total -= victim->gpuBytes;
+            if (whole)
+                evict(*victim);
+            else
+                dropTopLevel(*victim);
+            total += victim->gpuBytes;
+        }
+
+        for (std::map<Key, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+        {
+            Entry& entry = it->second;
+            if (!evictable(entry) || entry.baseLevel == 0 || entry.lastUsed + 1 < frameIndex)
+                continue;
+            size_t released = 0;
+            for (int level = 0; level < entry.baseLevel; ++level)
+                released += levelBytes(entry, level);
+            if (total + released <= memoryBudget)
+            {
+                ++restoredCount;
+                ++residencyStats.restores;
+                request(it);
+                return;
+            }
+        }
+    }
+
+    // refreshes the totals in residencyStats
+    void countResidency()
+    {
+        residencyStats.budgetBytes = memoryBudget;
+        residencyStats.residentBytes = 0;
+        residencyStats.residentTextures = 0;
+        residencyStats.droppedLevels = 0;
+        for (const std::pair<const Key, Entry>& item : entries)
+        {
+            residencyStats.residentBytes += item.second.gpuBytes;
+            residencyStats.residentTextures += item.second.gpuBytes > 0 ? 1 : 0;
+            residencyStats.droppedLevels += static_cast<size_t>(item.second.baseLevel);
+        }
+    }
+
+    // uploads every level of every layer directly from the mapped pack; no decode and no
+    // glGenerateMipmap. Levels are specified one by one rather than with glTexStorage so that the
+    // texture can be evicted back to its placeholder.
+    void loadBaked(std::map<Key, Entry>::iterator it, const std::vector<const PackTexture*>& layers)
+    {
+        typedef std::chrono::steady_clock clock;
+        clock::time_point start = clock::now();
+        const PackTexture& first = *layers[0];
+        GLenum format = first.format == PACK_RGBA8 ? GL_RGBA : GL_RGB;
+        GLenum internalFormat = first.format == PACK_RGBA8 ? GL_RGBA8 : GL_RGB8;
+        bool compressed = packFormatCompressed(first.format);
+        if (first.format == PACK_BC1)
+            internalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        else if (first.format == PACK_BC3)
+            internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        else if (first.format == PACK_BC7)
+            internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+
+        Entry& entry = it->second;
+        GLenum target = entry.target;
+        glBindTexture(target, entry.ID);
+        entry.gpuBytes = 0;
+        GLsizei width = static_cast<GLsizei>(first.levels[0].width);
+        GLsizei height = static_cast<GLsizei>(first.levels[0].height);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // small levels have rows that are not 4-byte multiples
+        for (uint32_t level = 0; level < first.levelCount; ++level)
+        {
+            const PackLevel& data = first.levels[level];
+            GLsizei levelWidth = static_cast<GLsizei>(data.width), levelHeight = static_cast<GLsizei>(data.height);
+            GLsizei bytes = static_cast<GLsizei>(packLevelBytes(first.format, data.width, data.height));
+            if (target == GL_TEXTURE_2D_ARRAY && compressed)
+                glCompressedTexImage3D(target, level, internalFormat, levelWidth, levelHeight, entry.layers, 0, bytes * entry.layers, NULL);
+            else if (target == GL_TEXTURE_2D_ARRAY)
+                glTexImage3D(target, level, internalFormat, levelWidth, levelHeight, entry.layers, 0, format, GL_UNSIGNED_BYTE, NULL);
+            else if (compressed)
+                glCompressedTexImage2D(target, level, internalFormat, levelWidth, levelHeight, 0, bytes, NULL);
+            else
+                glTexImage2D(target, level, internalFormat, levelWidth, levelHeight, 0, format, GL_UNSIGNED_BYTE, NULL);
+        }
+        for (int layer = 0; layer < entry.layers; ++layer)
+        {
+            for (uint32_t level = 0; level < first.levelCount; ++level)
+            {
+                const PackLevel& data = layers[layer]->levels[level];
+                GLsizei levelWidth = static_cast<GLsizei>(data.width), levelHeight = static_cast<GLsizei>(data.height);
+                GLsizei bytes = static_cast<GLsizei>(packLevelBytes(first.format, data.width, data.height));
+                const unsigned char* pixels = pack.levelData(data);
+                if (target == GL_TEXTURE_2D_ARRAY && compressed)
+                    glCompressedTexSubImage3D(target, level, 0, 0, layer, levelWidth, levelHeight, 1, internalFormat, bytes, pixels);
+                else if (target == GL_TEXTURE_2D_ARRAY)
+                    glTexSubImage3D(target, level, 0, 0, layer, levelWidth, levelHeight, 1, format, GL_UNSIGNED_BYTE, pixels);
+                else if (compressed)
+                    glCompressedTexSubImage2D(target, level, 0, 0, levelWidth, levelHeight, internalFormat, bytes, pixels);
+                else
+                    glTexSubImage2D(target, level, 0, 0, levelWidth, levelHeight, format, GL_UNSIGNED_BYTE, pixels);
+                entry.gpuBytes += static_cast<size_t>(bytes);
+            }
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(target, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(first.levelCount) - 1);
+        glBindTexture(target, 0);
+
+        std::chrono::duration<double, std::milli> uploadTime = clock::now() - start;
+        entry.width = width;
+        entry.height = height;
+        entry.channels = first.format == PACK_RGB8 || first.format == PACK_BC1 ? 3 : 4;
+        entry.uploadMs = uploadTime.count();
+        entry.resident = true;
+        if (!entry.baked)
+            ++bakedCount;
+        entry.baked = true;
+        entry.packFormat = static_cast<PackFormat>(first.format);
+        entry.baseLevel = 0;
+    }
+
+    // queues the decode of each layer of a registered texture on the worker pool; its placeholder
+    // (or, when reloading released levels, the levels still resident) shows until they have all
+    // been uploaded
+    void startStreaming(std::map<Key, Entry>::iterator it)
+    {
+        const Key& key = it->first;
+        Entry& entry = it->second;
+        entry.layersLeft = entry.layers;
+        entry.cachedLayers = 0;
+        entry.decodeMs = entry.mipMs = entry.uploadMs = 0.0;
+        if (entry.baseLevel > 0)
+        {
+            // reallocate the released levels; sampling stays on the resident ones until finish()
+            GLenum format = entry.channels == 4 ? GL_RGBA : GL_RGB;
+            int width = entry.width, height = entry.height;
+            glBindTexture(entry.target, entry.ID);
+            for (int level = 0; level < entry.baseLevel; ++level)
+            {
+                if (entry.target == GL_TEXTURE_2D_ARRAY)
+                    glTexImage3D(entry.target, level, format, width, height, entry.layers, 0, format, GL_UNSIGNED_BYTE, NULL);
+                else
+                    glTexImage2D(entry.target, level, format, width, height, 0, format, GL_UNSIGNED_BYTE, NULL);
+                entry.gpuBytes += levelBytes(entry, level);
+                mipLevelSize(width, height, width, height);
+            }
+            glBindTexture(entry.target, 0);
+        }
+        unsigned int id = entry.ID;
+        for (int layer = 0; layer < entry.layers; ++layer)
+        {
+            ++pendingDecodes;
+            LayerSource source = entry.sources[layer];
+            pool->submit([this, key, id, layer, source] {
+                StreamedImage result;
+                result.key = key;
+                result.ID = id;
+                result.layer = layer;
+                decode(source.path, source.flip, source.maxSize, result.image, &diskCache);
+                decoded.push(std::move(result));
+            });
+        }
+    }
+
+    // takes a finished decode off the queue. The first layer to arrive allocates the texture's
+    // levels while the placeholder moves to the smallest one, which is the only level sampled
+    // until every layer has been uploaded.
+    void receive(StreamedImage result)
+    {
+        --pendingDecodes;
+        std::map<Key, Entry>::iterator it = entries.find(result.key);
+        if (it == entries.end() || it->second.ID != result.ID)
+        {
+            freeImage(result.image); // released while decoding
+            return;
+        }
+        Entry& entry = it->second;
+        glBindTexture(entry.target, result.ID);
+        bool matches = entry.width == 0 || (result.image.width == entry.width && result.image.height == entry.height
+            && result.image.channels == entry.channels);
+        if (!result.image.pixels || !matches || entry.missing)
+        {
+            if (!result.image.pixels)
+                std::cout << result.image.error << std::endl;
+            else if (!matches)
+                std::cout << "ERROR::TEXTURE_CACHE::LAYER_MISMATCH: " << result.key.first << " layer " << result.layer
+                    << " is not " << entry.width << "x" << entry.height << " with " << entry.channels << " channels" << std::endl;
+            freeImage(result.image);
+            --entry.layersLeft;
+            if (!entry.missing)
+            {
+                // keep black texels so a missing image samples like an unbound texture
+                static const unsigned char black[4] = { 0, 0, 0, 255 };
+                entry.missing = true;
+                int level = entry.width == 0 ? 0 : mipLevelCount(entry.width, entry.height) - 1;
+                specifyTexel(entry.target, level, GL_RGBA, entry.layers, black);
+            }
+            glBindTexture(entry.target, 0);
+            return;
+        }
+        if (uploads.empty() && ring.chunkBytes() == 0)
+            ring.create(UPLOAD_BUFFERS, UPLOAD_CHUNK_BYTES);
+
+        static const unsigned char grey[4] = { 128, 128, 128, 255 };
+        Upload upload;
+        upload.key = std::move(result.key);
+        upload.ID = result.ID;
+        upload.target = entry.target;
+        upload.layer = result.layer;
+        upload.format = result.image.channels == 4 ? GL_RGBA : GL_RGB;
+        upload.image = std::move(result.image);
+        upload.levelWidth = upload.image.width;
+        upload.levelHeight = upload.image.height;
+        if (entry.width == 0)
+        {
+            int width = upload.image.width, height = upload.image.height;
+            int lastLevel = mipLevelCount(width, height) - 1;
+            for (int level = 0; level < std::max(lastLevel, 1); ++level)
+            {
+                if (entry.target == GL_TEXTURE_2D_ARRAY)
+                    glTexImage3D(entry.target, level, upload.format, width, height, entry.layers, 0, upload.format, GL_UNSIGNED_BYTE, NULL);
+                else
+                    glTexImage2D(entry.target, level, upload.format, width, height, 0, upload.format, GL_UNSIGNED_BYTE, NULL);
+                mipLevelSize(width, height, width, height);
+            }
+            if (lastLevel > 0)
+                specifyTexel(entry.target, lastLevel, upload.format, entry.layers, grey);
+            glTexParameteri(entry.target, GL_TEXTURE_BASE_LEVEL, lastLevel);
+            glTexParameteri(entry.target, GL_TEXTURE_MAX_LEVEL, lastLevel);
+            entry.width = upload.image.width;
+            entry.height = upload.image.height;
+            entry.channels = upload.image.channels;
+            entry.gpuBytes = mipChainBytes(entry.width, entry.height, entry.channels) * entry.layers;
+        }
+        glBindTexture(entry.target, 0);
+        uploads.push_back(std::move(upload));
+    }
+
+    // drains the decode queue and streams bands of rows, level after level, through the PBO ring
+    // until byteBudget is spent, a buffer is still busy (unless wait), or nothing is left
+    bool pump(size_t byteBudget, bool wait)
+    {
+        if (pendingDecodes == 0 && uploads.empty() && !batchOpen)
+            return false;
+        StreamedImage result;
+        while (decoded.tryPop(result))
+            receive(std::move(result));
+
+        typedef std::chrono::steady_clock clock;
+        size_t spent = 0;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        while (!uploads.empty() && spent < byteBudget)
+        {
+            clock::time_point start = clock::now();
+            Upload& upload = uploads.front();
+            size_t rowBytes = static_cast<size_t>(upload.levelWidth) * upload.image.channels;
+            size_t rowsLeft = static_cast<size_t>(upload.levelHeight - upload.nextRow);
+            size_t rows = std::min(ring.chunkBytes(), byteBudget - spent) / rowBytes;
+            rows = std::min(std::max<size_t>(rows, 1), rowsLeft);
+            PixelBufferRing::StageResult staged = ring.stage(upload.levelPixels() + upload.nextRow * rowBytes, rows * rowBytes, wait);
+            if (staged == PixelBufferRing::STAGE_BUSY)
+                break;
+            if (staged == PixelBufferRing::STAGE_FAILED)
+            {
+                // drop the layer and keep its placeholder, or flush() would retry it forever
+                std::cout << "ERROR::TEXTURE_CACHE::UPLOAD_FAILED: " << upload.key.first << " layer " << upload.layer
+                    << " level " << upload.level << std::endl;
+                entries[upload.key].missing = true;
+                finish(upload);
+                uploads.erase(uploads.begin());
+                continue;
+            }
+            glBindTexture(upload.target, upload.ID);
+            if (upload.target == GL_TEXTURE_2D_ARRAY)
+                glTexSubImage3D(upload.target, upload.level, 0, upload.nextRow, upload.layer, upload.levelWidth, static_cast<GLsizei>(rows), 1,
+                    upload.format, GL_UNSIGNED_BYTE, (void*)0);
+            else
+                glTexSubImage2D(upload.target, upload.level, 0, upload.nextRow, upload.levelWidth, static_cast<GLsizei>(rows),
+                    upload.format, GL_UNSIGNED_BYTE, (void*)0);
+            ring.submit();
+            upload.nextRow += static_cast<int>(rows);
+            spent += rows * rowBytes;
+
+            std::chrono::duration<double, std::milli> elapsed = clock::now() - start;
+            upload.uploadMs += elapsed.count();
+            if (upload.nextRow < upload.levelHeight)
+                continue;
+            if (upload.levelWidth > 1 || upload.levelHeight > 1)
+            {
+                // on to the next level, which follows this one in image.mipLevels
+                if (upload.level > 0)
+                    upload.levelOffset += static_cast<size_t>(upload.levelWidth) * upload.levelHeight * upload.image.channels;
+                mipLevelSize(upload.levelWidth, upload.levelHeight, upload.levelWidth, upload.levelHeight);
+                ++upload.level;
+                upload.nextRow = 0;
+                continue;
+            }
+            finish(upload);
+            uploads.erase(uploads.begin());
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        if (pendingDecodes > 0 || !uploads.empty())
+            return false;
+        std::chrono::duration<double, std::milli> wall = clock::now() - batchStart;
+        batchWallMs = wall.count();
+        batchOpen = false;
+        return true;
+    }
+
+    // every level of a layer is on its way; once every layer is, switch sampling over from the
+    // placeholder (the texture is still bound by pump())
+    void finish(Upload& upload)
+    {
+        Entry& entry = entries[upload.key];
+        entry.cachedLayers += upload.image.cached ? 1 : 0;
+        freeImage(upload.image);
+        entry.decodeMs += upload.image.decodeMs;
+        entry.mipMs += upload.image.mipMs;
+        entry.uploadMs += upload.uploadMs;
+        if (--entry.layersLeft > 0 || entry.missing)
+            return;
+
+        glTexParameteri(entry.target, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(entry.target, GL_TEXTURE_MAX_LEVEL, mipLevelCount(entry.width, entry.height) - 1);
+        entry.gpuBytes = mipChainBytes(entry.width, entry.height, entry.channels) * entry.layers;
+        entry.baseLevel = 0;
+        entry.resident = true;
+    }
+
+    // maps the source file and takes its levels from the disk cache (if open), or else decodes it
+    // and builds the mip chain, storing the result in the cache. With a maxSize the levels larger
+    // than it are never kept: a JPEG is decoded at a reduced scale and the rest is dropped from the
+    // top of the chain. Runs on the calling thread and is safe to call from several threads at once
+    // since the flip flag and failure reason are per thread.
+    static bool decode(const std::string& path, bool flip, int maxSize, DecodedImage& image, DecodedImageCache* cache)
+    {
+        typedef std::chrono::steady_clock clock;
+        clock::time_point start = clock::now();
+        MappedFile source;
+        if (!source.open(path, MappedFile::ACCESS_SEQUENTIAL) || source.size() > static_cast<size_t>(INT_MAX))
+        {
+            image.error = "Texture failed to load at path: " + path;
+            return false;
+        }
+
+        uint64_t key = 0;
+        if (cache && cache->isOpen())
+        {
+            key = DecodedImageCache::keyFor(source.data(), source.size(), 0, flip, maxSize);
+            std::unique_ptr<MappedFile> file(new MappedFile());
+            DecodedImageCache::View view;
+            if (cache->load(key, *file, view))
+            {
+                image.pixels = view.pixels;
+                image.mipLevels = view.mips;
+                image.width = view.width;
+                image.height = view.height;
+                image.channels = view.channels;
+                image.cached = std::move(file);
+                std::chrono::duration<double, std::milli> loadTime = clock::now() - start;
+                image.decodeMs = loadTime.count();
+                return true;
+            }
+        }
+
+        stbi_set_flip_vertically_on_load_thread(flip);
+        int scale = decodeScaleFor(source.data(), source.size(), maxSize);
+        image.decoded = decodeImage(source.data(), source.size(), &image.width, &image.height, &image.channels, 0, scale);
+        image.pixels = image.decoded;
+        if (!image.pixels)
+        {
+            image.error = "Texture failed to load at path: " + path;
+            return false;
+        }
+        if (image.channels != 3 && image.channels != 4)
+        {
+            image.error = "Not implemented to handle image with " + std::to_string(image.channels) + " channels";
+            freeImage(image);
+            return false;
+        }
+        clock::time_point decodeEnd = clock::now();
+        std::chrono::duration<double, std::milli> decodeTime = decodeEnd - start;
+        image.decodeMs = decodeTime.count();
+
+        image.mips.resize(mipChainTailBytes(image.width, image.height, image.channels));
+        buildMipChain(image.pixels, image.width, image.height, image.channels, image.mips.data());
+        image.mipLevels = image.mips.data();
+        dropLevelsAbove(image, maxSize);
+        std::chrono::duration<double, std::milli> mipTime = clock::now() - decodeEnd;
+        image.mipMs = mipTime.count();
+
+        if (cache && cache->isOpen())
+            cache->store(key, image.pixels, image.mipLevels, image.width, image.height, image.channels);
+        return true;
+    }
+
+    // makes the first level no larger than maxSize the image's level 0, freeing the ones above it;
+    // the image must have just been decoded (levels in decoded and mips)
+    static void dropLevelsAbove(DecodedImage& image, int maxSize)
+    {
+        int width = image.width, height = image.height;
+        size_t offset = 0;
+        bool first = true;
+        while (maxSize > 0 && std::max(width, height) > maxSize && (width > 1 || height > 1))
+        {
+            if (!first)
+                offset += static_cast<size_t>(width) * height * image.channels;
+            first = false;
+            mipLevelSize(width, height, width, height);
+        }
+        if (first)
+            return;
+        std::vector<unsigned char>(image.mips.begin() + offset, image.mips.end()).swap(image.mips);
+        stbi_image_free(image.decoded);
+        image.decoded = nullptr;
+        image.pixels = image.mips.data();
+        image.mipLevels = image.pixels + static_cast<size_t>(width) * height * image.channels;
+        image.width = width;
+        image.height = height;
+    }
+
+    // releases whatever holds an image's levels
+    static void freeImage(DecodedImage& image)
+    {
+        stbi_image_free(image.decoded);
+        std::vector<unsigned char>().swap(image.mips);
+        image.cached.reset();
+        image.decoded = nullptr;
+        image.pixels = nullptr;
+        image.mipLevels = nullptr;
+    }
+
+    // creates the GL texture from the decoded levels and frees them
+    static void upload(DecodedImage& image, const TextureSettings& settings, Entry& entry)
+    {
+        typedef std::chrono::steady_clock clock;
+        clock::time_point start = clock::now();
+        GLenum format = image.channels == 4 ? GL_RGBA : GL_RGB;
+        glGenTextures(1, &entry.ID);
+        glBindTexture(GL_TEXTURE_2D, entry.ID);
+        applySettings(GL_TEXTURE_2D, settings);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // small levels have rows that are not 4-byte multiples
+        int width = image.width, height = image.height, level = 0;
+        const unsigned char* pixels = image.pixels;
+        const unsigned char* next = image.mipLevels;
+        while (true)
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, format, GL_UNSIGNED_BYTE, pixels);
+            if (width == 1 && height == 1)
+                break;
+            mipLevelSize(width, height, width, height);
+            pixels = next;
+            next += static_cast<size_t>(width) * height * image.channels;
+            ++level;
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        entry.cachedLayers = image.cached ? 1 : 0;
+        freeImage(image);
+
+        std::chrono::duration<double, std::milli> uploadTime = clock::now() - start;
+        entry.width = image.width;
+        entry.height = image.height;
+        entry.channels = image.channels;
+        entry.decodeMs = image.decodeMs;
+        entry.mipMs = image.mipMs;
+        entry.uploadMs = uploadTime.count();
+        entry.gpuBytes = mipChainBytes(entry.width, entry.height, entry.channels);
+        entry.resident = true;
+    }
+
+    static void applySettings(GLenum target, const TextureSettings& settings)
+    {
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, settings.wrapS);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, settings.wrapT);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, settings.minFilter);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, settings.magFilter);
+    }
+
+    // (re)specifies level of the bound texture as 1x1 texel in every layer
+    static void specifyTexel(GLenum target, GLint level, GLenum format, int layers, const unsigned char texel[4])
+    {
+        if (target == GL_TEXTURE_2D_ARRAY)
+        {
+            glTexImage3D(target, level, format, 1, 1, layers, 0, format, GL_UNSIGNED_BYTE, NULL);
+            for (int layer = 0; layer < layers; ++layer)
+                glTexSubImage3D(target, level, 0, 0, layer, 1, 1, 1, format, GL_UNSIGNED_BYTE, texel);
+        }
+        else
+            glTexImage2D(target, level, format, 1, 1, 0, format, GL_UNSIGNED_BYTE, texel);
+    }
+
+    // bytes of a full mip chain down to 1x1
+    static size_t mipChainBytes(int width, int height, int channels)
+    {
+        size_t bytes = 0;
+        while (true)
+        {
+            bytes += static_cast<size_t>(width) * height * channels;
+            if (width == 1 && height == 1)
+                return bytes;
+            width = width > 1 ? width / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+    }
+
+    // settings with the size limit set by setMaxTextureSize() applied
+    TextureSettings capped(TextureSettings settings) const
+    {
+        if (maxTextureSize > 0 && (settings.maxSize == 0 || settings.maxSize > maxTextureSize))
+            settings.maxSize = maxTextureSize;
+        return settings;
+    }
+
+    // GL settings for a manifest line (readTextureManifest has validated the words)
+    TextureSettings settingsFor(const ManifestEntry& item) const
+    {
+        TextureSettings settings;
+        if (item.wrap == "mirrored_repeat")
+            settings.wrapS = GL_MIRRORED_REPEAT;
+        else if (item.wrap == "clamp_to_edge")
+            settings.wrapS = GL_CLAMP_TO_EDGE;
+        else
+            settings.wrapS = GL_REPEAT;
+        settings.wrapT = settings.wrapS;
+
+        if (item.filter == "nearest")
+            settings.minFilter = settings.magFilter = GL_NEAREST;
+        else if (item.filter == "trilinear")
+            settings.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+        settings.flip = item.flip;
+        settings.maxSize = item.maxSize;
+        return capped(settings);
+    }
+};
+#endif
@@ -0,0 +1,115 @@
+#ifndef TEXTURE_MANIFEST_H
+#define TEXTURE_MANIFEST_H
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// One line of a texture manifest (textures.txt), one texture per line:
+//
+//     # name    "path"                      wrap             filter  flip
+//     wood      "resources/WoodTexture.jpg" clamp_to_edge    linear  flip
+//
+// wrap is repeat, mirrored_repeat or clamp_to_edge; filter is nearest, linear or trilinear
+// (linear with mipmap filtering for minification); flip is flip or noflip. An optional max=N
+// after flip loads the image halved as often as it takes to be at most N texels on each side,
+// for content only ever seen small or far away (JPEGs are decoded at the reduced size). A name
+// ending in [n] makes the image layer n of a texture array under the plain name:
+//
+//     faces[0]  "resources/Front.png"       repeat           linear  flip
+//     faces[1]  "resources/Back.png"        repeat           linear  flip
+//
+// Shared by the runtime TextureCache and the offline texbake tool, so it has no GL dependency.
+struct ManifestEntry
+{
+    std::string name;       // without the [n] suffix
+    std::string path;
+    std::string wrap;
+    std::string filter;
+    bool flip = true;       // flip rows on load so the first row is the bottom of the image
+    int maxSize = 0;        // largest width or height to load, or 0 for the size as stored
+    int layer = -1;         // array layer, or -1 for a plain 2D texture
+};
+
+// splits "name[n]" into name and n; leaves plain names alone. False if the suffix is malformed.
+inline bool parseManifestLayer(std::string& name, int& layer)
+{
+    layer = -1;
+    size_t open = name.find('[');
+    if (open == std::string::npos)
+        return true;
+    if (open == 0 || name.size() < open + 3 || name.back() != ']' || name.size() - open > 5)
+        return false;
+    int value = 0;
+    for (size_t i = open + 1; i + 1 < name.size(); ++i)
+    {
+        if (name[i] < '0' || name[i] > '9')
+            return false;
+        value = value * 10 + (name[i] - '0');
+    }
+    name.erase(open);
+    layer = value;
+    return true;
+}
+
+// reads the value of a "max=N" word; false unless N is a positive number
+inline bool parseManifestMaxSize(const std::string& word, int& maxSize)
+{
+    if (word.compare(0, 4, "max=") != 0 || word.size() == 4 || word.size() > 12)
+        return false;
+    int value = 0;
+    for (size_t i = 4; i < word.size(); ++i)
+    {
+        if (word[i] < '0' || word[i] > '9')
+            return false;
+        value = value * 10 + (word[i] - '0');
+    }
+    maxSize = value;
+    return value > 0;
+}
+
+// appends every entry of the manifest to entries; returns false if the file cannot be read or has
+// a malformed line (reported, skipped, and the remaining lines still read)
+inline bool readTextureManifest(const std::string& manifestPath, std::vector<ManifestEntry>& entries)
+{
+    std::ifstream file(manifestPath);
+    if (!file)
+    {
+        std::cout << "ERROR::TEXTURE_MANIFEST::NOT_FOUND: " << manifestPath << std::endl;
+        return false;
+    }
+
+    bool ok = true;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        std::istringstream fields(line);
+        ManifestEntry entry;
+        std::string flip, maxSize;
+        if (!(fields >> entry.name) || entry.name[0] == '#')
+            continue;
+
+        bool valid = static_cast<bool>(fields >> std::quoted(entry.path) >> entry.wrap >> entry.filter >> flip);
+        valid = valid && (entry.wrap == "repeat" || entry.wrap == "mirrored_repeat" || entry.wrap == "clamp_to_edge");
+        valid = valid && (entry.filter == "nearest" || entry.filter == "linear" || entry.filter == "trilinear");
+        valid = valid && (flip == "flip" || flip == "noflip");
+        if (valid && fields >> maxSize)
+            valid = parseManifestMaxSize(maxSize, entry.maxSize);
+        valid = valid && parseManifestLayer(entry.name, entry.layer);
+        if (!valid)
+        {
+            std::cout << "ERROR::TEXTURE_MANIFEST::BAD_LINE: " << manifestPath << ":" << lineNumber << std::endl;
+            ok = false;
+            continue;
+        }
+        entry.flip = flip == "flip";
+        entries.push_back(entry);
+    }
+    return ok;
+}
+#endif
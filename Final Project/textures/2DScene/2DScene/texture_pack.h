@@ -0,0 +1,186 @@
+#ifndef TEXTURE_PACK_H
+#define TEXTURE_PACK_H
+
+#include <mapped_file.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+
+// Texture pack: every manifest texture with its full mip chain, already flipped and stored in
+// the layout glTexImage2D or glCompressedTexImage2D takes, written offline by texbake and memory-mapped at runtime so a
+// warm start uploads straight from the page cache without decoding or generating mipmaps.
+//
+// File layout (little endian, offsets from the start of the file):
+//     PackHeader
+//     PackTexture[textureCount]
+//     level data, each level starting on a PACK_LEVEL_ALIGNMENT boundary
+
+const char TEXTURE_PACK_MAGIC[8] = { 'T', 'E', 'X', 'P', 'A', 'C', 'K', '1' };
+const uint32_t TEXTURE_PACK_VERSION = 2;
+const int PACK_MAX_LEVELS = 16;         // 32768 x 32768
+const int PACK_PATH_LENGTH = 192;
+const uint64_t PACK_LEVEL_ALIGNMENT = 16;
+
+// pixel layout of every level of a texture; the BC formats are 4x4 blocks (see block_compress.h)
+enum PackFormat : uint32_t
+{
+    PACK_RGB8 = 0,
+    PACK_RGBA8 = 1,
+    PACK_BC1 = 2,
+    PACK_BC3 = 3,
+    PACK_BC7 = 4
+};
+
+struct PackHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t textureCount;
+};
+
+struct PackLevel
+{
+    uint64_t offset;
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct PackTexture
+{
+    char path[PACK_PATH_LENGTH];    // source image as written in the manifest, zero padded
+    uint64_t sourceSize;            // size and modification time of the source when it was baked,
+    int64_t sourceModified;         // so edited images fall back to a decode instead of going stale
+    uint32_t format;                // PackFormat
+    uint32_t flipped;
+    uint32_t levelCount;
+    uint32_t reserved;
+    PackLevel levels[PACK_MAX_LEVELS];
+};
+
+static_assert(sizeof(PackHeader) == 16, "PackHeader layout is part of the file format");
+static_assert(sizeof(PackLevel) == 24, "PackLevel layout is part of the file format");
+static_assert(sizeof(PackTexture) == 608, "PackTexture layout is part of the file format");
+
+inline bool packFormatCompressed(uint32_t format)
+{
+    return format == PACK_BC1 || format == PACK_BC3 || format == PACK_BC7;
+}
+
+// bytes of one width x height level stored in format
+inline uint64_t packLevelBytes(uint32_t format, uint32_t width, uint32_t height)
+{
+    if (packFormatCompressed(format))
+    {
+        uint64_t blocks = static_cast<uint64_t>((width + 3) / 4) * ((height + 3) / 4);
+        return blocks * (format == PACK_BC1 ? 8 : 16);
+    }
+    return static_cast<uint64_t>(width) * height * (format == PACK_RGBA8 ? 4 : 3);
+}
+
+// size and modification time of a source image; false if it does not exist
+inline bool packSourceStamp(const std::string& path, uint64_t& size, int64_t& modified)
+{
+    std::error_code error;
+    std::uintmax_t bytes = std::filesystem::file_size(path, error);
+    if (error)
+        return false;
+    std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+    if (error)
+        return false;
+    size = static_cast<uint64_t>(bytes);
+    modified = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+// Read-only view of a mapped texture pack
+class TexturePack
+{
+public:
+    // maps the pack and checks that its header, directory and level ranges are consistent
+    bool open(const std::string& path)
+    {
+        close();
+        if (!file.open(path))
+            return false;
+
+        const PackHeader* header = reinterpret_cast<const PackHeader*>(file.data());
+        if (file.size() < sizeof(PackHeader) || std::memcmp(header->magic, TEXTURE_PACK_MAGIC, 8) != 0
+            || header->version != TEXTURE_PACK_VERSION
+            || file.size() < sizeof(PackHeader) + static_cast<uint64_t>(header->textureCount) * sizeof(PackTexture))
+        {
+            std::cout << "ERROR::TEXTURE_PACK::INVALID_HEADER: " << path << std::endl;
+            close();
+            return false;
+        }
+
+        const PackTexture* directory = reinterpret_cast<const PackTexture*>(file.data() + sizeof(PackHeader));
+        for (uint32_t i = 0; i < header->textureCount; ++i)
+        {
+            const PackTexture& texture = directory[i];
+            bool valid = texture.levelCount >= 1 && texture.levelCount <= PACK_MAX_LEVELS
+                && texture.path[PACK_PATH_LENGTH - 1] == '\0' && texture.format <= PACK_BC7;
+            for (uint32_t level = 0; valid && level < texture.levelCount; ++level)
+            {
+                const PackLevel& data = texture.levels[level];
+                valid = data.offset <= file.size() && data.size <= file.size() - data.offset
+                    && data.size >= packLevelBytes(texture.format, data.width, data.height);
+            }
+            if (!valid)
+            {
+                std::cout << "ERROR::TEXTURE_PACK::INVALID_ENTRY: " << path << " #" << i << std::endl;
+                close();
+                return false;
+            }
+        }
+
+        textures = directory;
+        count = header->textureCount;
+        return true;
+    }
+
+    void close()
+    {
+        file.close();
+        textures = nullptr;
+        count = 0;
+    }
+
+    bool isOpen() const
+    {
+        return textures != nullptr;
+    }
+
+    // the baked entry for path with the given flip, or null if the pack has none or the source
+    // image changed since it was baked. A pack shipped without its sources is always used.
+    const PackTexture* find(const std::string& path, bool flip) const
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const PackTexture& texture = textures[i];
+            if ((texture.flipped != 0) != flip || path != texture.path)
+                continue;
+            uint64_t size = 0;
+            int64_t modified = 0;
+            if (packSourceStamp(path, size, modified) && (size != texture.sourceSize || modified != texture.sourceModified))
+                return nullptr;
+            return &texture;
+        }
+        return nullptr;
+    }
+
+    const unsigned char* levelData(const PackLevel& level) const
+    {
+        return file.data() + level.offset;
+    }
+
+private:
+    MappedFile file;
+    const PackTexture* textures = nullptr;
+    uint32_t count = 0;
+};
+#endif
@@ -0,0 +1,155 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread-safe FIFO used to hand results from worker threads back to the GL thread
+template <typename T>
+class WorkQueue
+{
+public:
+    void push(T item)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            items.push_back(std::move(item));
+        }
+        ready.notify_one();
+    }
+
+    // blocks until an item is available
+    T pop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return !items.empty(); });
+        T item = std::move(items.front());
+        items.pop_front();
+        return item;
+    }
+
+    // takes an item if one is waiting; never blocks
+    bool tryPop(T& item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop_front();
+        return true;
+    }
+
+private:
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable ready;
+};
+
+// Fixed set of worker threads running submitted jobs in order. Jobs must not touch GL: the
+// context is only current on the main thread.
+class ThreadPool
+{
+public:
+    // threadCount 0 uses one thread per hardware core
+    explicit ThreadPool(unsigned int threadCount = 0)
+    {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int i = 0; i < threadCount; ++i)
+            workers.emplace_back([this] { run(); });
+    }
+
+    // runs every job already submitted, then joins the workers
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        wake.notify_one();
+    }
+
+    // calls task(i) for every i in [0, count) on the workers and the calling thread, returning once
+    // every call has finished. The caller takes indices too, so this is safe to call from a job
+    // even when every other worker is busy: it then simply runs everything itself.
+    void parallelFor(int count, const std::function<void(int)>& task)
+    {
+        struct Shared
+        {
+            std::atomic<int> next{ 0 };
+            std::atomic<int> done{ 0 };
+            std::mutex mutex;
+            std::condition_variable finished;
+        };
+        std::shared_ptr<Shared> shared = std::make_shared<Shared>();
+        // helpers that only start after the last index was taken return without touching task
+        std::function<void()> work = [shared, count, &task] {
+            for (int i = shared->next++; i < count; i = shared->next++)
+            {
+                task(i);
+                if (++shared->done == count)
+                {
+                    std::lock_guard<std::mutex> lock(shared->mutex);
+                    shared->finished.notify_all();
+                }
+            }
+        };
+        int helpers = std::min(count - 1, static_cast<int>(workers.size()));
+        for (int i = 0; i < helpers; ++i)
+            submit(work);
+        work();
+        std::unique_lock<std::mutex> lock(shared->mutex);
+        shared->finished.wait(lock, [&shared, count] { return shared->done == count; });
+    }
+
+    unsigned int size() const
+    {
+        return static_cast<unsigned int>(workers.size());
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void run()
+    {
+        while (true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty())
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+};
+#endif
@@ -0,0 +1,133 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// floats per vertex as meshes are built: position (3), normal (3), texture coordinates (2)
+const size_t VERTEX_FLOATS = 8;
+
+// Compact vertex layout the scene's meshes are uploaded in. Meshes are still built as
+// VERTEX_FLOATS-float vertices (position, normal, texture coordinates: 32 bytes), optionally
+// followed by a texture array layer, and packed to 16 bytes each before they reach a buffer:
+//     position    3 x snorm16, position / positionScale
+//     layer       uint16, texture array layer (0 for meshes without one)
+//     normal      2 x snorm16, octahedral encoding of the unit normal
+//     texCoord    2 x unorm16, texture coordinates / texCoordScale
+// Object color is not part of a vertex; it comes from the draw's MaterialBlock.
+// glVertexAttribPointer normalizes the integers back to [-1, 1] / [0, 1]. The two scales belong to
+// the mesh (its largest position component and texture coordinate), so precision follows the size
+// of what is drawn; shader.vs multiplies them back in from its vertexScale uniform and decodes the
+// normal (light_cube.vs only reads the position).
+
+struct PackedVertex
+{
+    int16_t position[3];
+    uint16_t layer;
+    int16_t normal[2];
+    uint16_t texCoord[2];
+};
+
+static_assert(sizeof(PackedVertex) == 16, "setPackedVertexAttributes describes this layout to GL");
+
+struct PackedMesh
+{
+    std::vector<PackedVertex> vertices;
+    glm::vec2 scale = glm::vec2(1.0f);  // x: positions, y: texture coordinates (vertexScale in shader.vs)
+
+    size_t bytes() const
+    {
+        return vertices.size() * sizeof(PackedVertex);
+    }
+};
+
+inline int16_t packSnorm16(float value)
+{
+    return static_cast<int16_t>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+}
+
+inline uint16_t packUnorm16(float value)
+{
+    return static_cast<uint16_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f));
+}
+
+// normal projected onto the octahedron |x| + |y| + |z| = 1 and unfolded into [-1, 1]^2, the lower
+// half folded over the diagonals (octahedralDecode in shader.vs undoes it); a zero vector gives +z
+inline glm::vec2 octahedralEncode(const glm::vec3& normal)
+{
+    float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    if (length == 0.0f)
+        return glm::vec2(0.0f);
+    glm::vec3 n = normal / length;
+    if (n.z >= 0.0f)
+        return glm::vec2(n.x, n.y);
+    return glm::vec2((1.0f - std::fabs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::fabs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+}
+
+// packs vertexCount vertices of stride floats each: VERTEX_FLOATS, or one more with the texture
+// array layer last.
+// Texture coordinates are expected to be non-negative (unorm16 cannot hold anything below 0).
+inline PackedMesh packVertices(const float* vertices, size_t vertexCount, size_t stride)
+{
+    PackedMesh mesh;
+    float positionScale = 0.0f, texCoordScale = 0.0f;
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const float* v = vertices + i * stride;
+        positionScale = std::max(positionScale, std::max(std::fabs(v[0]), std::max(std::fabs(v[1]), std::fabs(v[2]))));
+        texCoordScale = std::max(texCoordScale, std::max(v[6], v[7]));
+    }
+    mesh.scale = glm::vec2(positionScale > 0.0f ? positionScale : 1.0f, texCoordScale > 0.0f ? texCoordScale : 1.0f);
+
+    mesh.vertices.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const float* v = vertices + i * stride;
+        PackedVertex& packed = mesh.vertices[i];
+        for (int c = 0; c < 3; ++c)
+            packed.position[c] = packSnorm16(v[c] / mesh.scale.x);
+        packed.layer = stride > VERTEX_FLOATS ? static_cast<uint16_t>(v[VERTEX_FLOATS]) : 0;
+        glm::vec2 normal = octahedralEncode(glm::vec3(v[3], v[4], v[5]));
+        packed.normal[0] = packSnorm16(normal.x);
+        packed.normal[1] = packSnorm16(normal.y);
+        packed.texCoord[0] = packUnorm16(v[6] / mesh.scale.y);
+        packed.texCoord[1] = packUnorm16(v[7] / mesh.scale.y);
+    }
+    return mesh;
+}
+
+// packs a fixed-size array of VERTEX_FLOATS-float vertices
+template <size_t N>
+inline PackedMesh packVertices(const float (&vertices)[N])
+{
+    static_assert(N % VERTEX_FLOATS == 0, "expected whole vertices");
+    return packVertices(vertices, N / VERTEX_FLOATS, VERTEX_FLOATS);
+}
+
+// points attribute 0 of the bound vertex array at the positions in the bound PackedVertex buffer
+inline void setPackedPositionAttribute()
+{
+    glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
+    glEnableVertexAttribArray(0);
+}
+
+// points the bound vertex array at every attribute of the bound PackedVertex buffer: position (0),
+// normal (1), texture coordinates (3) and the texture array layer (4), which is converted to float
+// without normalization
+inline void setPackedVertexAttributes()
+{
+    setPackedPositionAttribute();
+    glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(3, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, texCoord));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(4, 1, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, layer));
+    glEnableVertexAttribArray(4);
+}
+#endif
@@ -0,0 +1,750 @@
+// For textures; stb_image's scratch memory comes from per-thread arenas (see decode_arena.h)
+#include <decode_arena.h>
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_MALLOC(size) decodeArenaMalloc(size)
+#define STBI_REALLOC_SIZED(pointer, oldSize, newSize) decodeArenaRealloc(pointer, oldSize, newSize)
+#define STBI_FREE(pointer) decodeArenaFree(pointer)
+#define STBI_MALLOC_RESULT(size) decodeArenaMallocResult(size)
+#include "stb_image.h"
+
+#include <block_compress.h>
+#include <image_loader.h>
+#include <mipmap.h>
+#include <texture_manifest.h>
+#include <texture_pack.h>
+#include <thread_pool.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+* texbake: offline texture baker for 2DScene
+*
+* Decodes every image listed in a texture manifest, flips it the way the manifest asks, builds its
+* full mip chain, block-compresses every level and writes everything into one texture pack that
+* the scene memory-maps at startup (see texture_pack.h). Run it from the 2DScene project directory
+* so the manifest's relative paths resolve the same way they do for the scene:
+*
+*     texbake [--format F] [--quality Q] [--benchmark-jpeg] [--benchmark-alloc] [manifest] [output]
+*
+*     --format          auto (default: BC1 for opaque images, BC3 when any texel is translucent),
+*                       bc1, bc3, bc7, or none to store uncompressed RGB8/RGBA8
+*     --quality         fast, normal (default) or high; see CompressionQuality in block_compress.h
+*     --benchmark-jpeg  bake nothing; instead time stb_image's scalar, SSE2 and AVX2 JPEG kernels
+*                       on every JPEG in the manifest and print their throughput
+*     --benchmark-alloc bake nothing; instead decode every image in the manifest on all cores at
+*                       once, with stb_image's scratch memory from the heap and then from the
+*                       per-thread decode arenas, and print the time spent allocating
+*     manifest          default textures.txt
+*     output            default textures.pack
+*/
+
+namespace
+{
+    enum FormatChoice
+    {
+        FORMAT_AUTO,
+        FORMAT_NONE,
+        FORMAT_BC1,
+        FORMAT_BC3,
+        FORMAT_BC7
+    };
+
+    struct BakeOptions
+    {
+        FormatChoice format = FORMAT_AUTO;
+        CompressionQuality quality = COMPRESS_NORMAL;
+        std::string manifestPath = "textures.txt";
+        std::string outputPath = "textures.pack";
+        bool benchmarkJpeg = false;
+        bool benchmarkAlloc = false;
+    };
+
+    bool parseOptions(int argc, char** argv, BakeOptions& options)
+    {
+        int positional = 0;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "--format" && i + 1 < argc)
+            {
+                std::string value = argv[++i];
+                if (value == "auto")
+                    options.format = FORMAT_AUTO;
+                else if (value == "none")
+                    options.format = FORMAT_NONE;
+                else if (value == "bc1")
+                    options.format = FORMAT_BC1;
+                else if (value == "bc3")
+                    options.format = FORMAT_BC3;
+                else if (value == "bc7")
+                    options.format = FORMAT_BC7;
+                else
+                    return false;
+            }
+            else if (arg == "--quality" && i + 1 < argc)
+            {
+                std::string value = argv[++i];
+                if (value == "fast")
+                    options.quality = COMPRESS_FAST;
+                else if (value == "normal")
+                    options.quality = COMPRESS_NORMAL;
+                else if (value == "high")
+                    options.quality = COMPRESS_HIGH;
+                else
+                    return false;
+            }
+            else if (arg == "--benchmark-jpeg")
+                options.benchmarkJpeg = true;
+            else if (arg == "--benchmark-alloc")
+                options.benchmarkAlloc = true;
+            else if (arg.compare(0, 2, "--") != 0 && positional == 0)
+            {
+                options.manifestPath = arg;
+                ++positional;
+            }
+            else if (arg.compare(0, 2, "--") != 0 && positional == 1)
+            {
+                options.outputPath = arg;
+                ++positional;
+            }
+            else
+                return false;
+        }
+        return true;
+    }
+
+    const char* formatName(uint32_t format)
+    {
+        switch (format)
+        {
+        case PACK_RGB8: return "RGB8";
+        case PACK_RGBA8: return "RGBA8";
+        case PACK_BC1: return "BC1";
+        case PACK_BC3: return "BC3";
+        default: return "BC7";
+        }
+    }
+
+    // true if no texel of the image is translucent
+    bool isOpaque(const unsigned char* pixels, int width, int height, int channels)
+    {
+        if (channels != 4)
+            return true;
+        size_t texels = static_cast<size_t>(width) * height;
+        for (size_t i = 0; i < texels; ++i)
+        {
+            if (pixels[i * 4 + 3] != 255)
+                return false;
+        }
+        return true;
+    }
+
+    // pack format for an image with channels bytes per texel
+    uint32_t chooseFormat(FormatChoice choice, const unsigned char* pixels, int width, int height, int channels)
+    {
+        switch (choice)
+        {
+        case FORMAT_NONE:
+            return channels == 4 ? PACK_RGBA8 : PACK_RGB8;
+        case FORMAT_BC1:
+            return PACK_BC1;
+        case FORMAT_BC3:
+            return PACK_BC3;
+        case FORMAT_BC7:
+            return PACK_BC7;
+        default:
+            break;
+        }
+        return isOpaque(pixels, width, height, channels) ? PACK_BC1 : PACK_BC3;
+    }
+
+    // one baked texture: its directory entry and the pixels of every level
+    struct BakedTexture
+    {
+        PackTexture record;
+        std::vector<std::vector<unsigned char>> levels;
+    };
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // true if every block of a width x height BC7 image decodes to alpha 255; BC7 stores alpha
+    // with the same p-bits as colour, so an opaque level has to be checked to come back opaque
+    bool bc7StaysOpaque(const std::vector<unsigned char>& blocks, int width, int height)
+    {
+        size_t blockCount = static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4);
+        for (size_t b = 0; b < blockCount; ++b)
+        {
+            unsigned char texels[64];
+            if (!decodeBC7Block(&blocks[b * 16], texels))
+                return false;
+            for (int t = 0; t < 16; ++t)
+            {
+                if (texels[t * 4 + 3] != 255)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // decodes path, builds its mip chain and compresses every level no larger than maxSize (0 for
+    // all of them); false (after printing why) if it cannot be baked
+    bool bake(const std::string& path, bool flip, int maxSize, const BakeOptions& options, BakedTexture& baked)
+    {
+        if (path.size() >= PACK_PATH_LENGTH)
+        {
+            std::cout << "Path too long to bake: " << path << std::endl;
+            return false;
+        }
+        uint64_t sourceSize = 0;
+        int64_t sourceModified = 0;
+        if (!packSourceStamp(path, sourceSize, sourceModified))
+        {
+            std::cout << "Texture failed to load at path: " << path << std::endl;
+            return false;
+        }
+
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load(flip);
+        unsigned char* data = loadImageMapped(path, &width, &height, &channels, 0, maxSize);
+        if (!data)
+        {
+            const char* reason = stbi_failure_reason();
+            std::cout << "Texture failed to load at path: " << path << " (" << (reason ? reason : "cannot map file") << ")" << std::endl;
+            return false;
+        }
+        if (channels != 3 && channels != 4)
+        {
+            std::cout << "Cannot bake " << path << ": " << width << "x" << height << " with " << channels << " channels" << std::endl;
+            stbi_image_free(data);
+            return false;
+        }
+
+        // the same sRGB-correct chain the scene builds when it decodes the source itself, starting
+        // at the same level: the first one no larger than maxSize
+        std::vector<unsigned char> tail(mipChainTailBytes(width, height, channels));
+        buildMipChain(data, width, height, channels, tail.data());
+        const unsigned char* top = data;
+        const unsigned char* next = tail.data();
+        while (maxSize > 0 && std::max(width, height) > maxSize && (width > 1 || height > 1))
+        {
+            mipLevelSize(width, height, width, height);
+            top = next;
+            next += static_cast<size_t>(width) * height * channels;
+        }
+        if (mipLevelCount(width, height) > PACK_MAX_LEVELS)
+        {
+            std::cout << "Cannot bake " << path << ": " << width << "x" << height << " with " << channels << " channels" << std::endl;
+            stbi_image_free(data);
+            return false;
+        }
+
+        PackTexture& record = baked.record;
+        std::memset(&record, 0, sizeof(record));
+        std::memcpy(record.path, path.c_str(), path.size());
+        record.sourceSize = sourceSize;
+        record.sourceModified = sourceModified;
+        record.format = chooseFormat(options.format, top, width, height, channels);
+        record.flipped = flip ? 1 : 0;
+        record.levelCount = static_cast<uint32_t>(mipLevelCount(width, height));
+
+        baked.levels.resize(record.levelCount);
+        baked.levels[0].assign(top, top + static_cast<size_t>(width) * height * channels);
+        stbi_image_free(data);
+        for (uint32_t level = 0; level < record.levelCount; ++level)
+        {
+            record.levels[level].width = static_cast<uint32_t>(width);
+            record.levels[level].height = static_cast<uint32_t>(height);
+            int nextWidth, nextHeight;
+            mipLevelSize(width, height, nextWidth, nextHeight);
+            if (level + 1 < record.levelCount)
+            {
+                size_t bytes = static_cast<size_t>(nextWidth) * nextHeight * channels;
+                baked.levels[level + 1].assign(next, next + bytes);
+                next += bytes;
+            }
+
+            if (packFormatCompressed(record.format))
+            {
+                BlockFormat blockFormat = record.format == PACK_BC1 ? BLOCK_BC1 : (record.format == PACK_BC3 ? BLOCK_BC3 : BLOCK_BC7);
+                std::vector<unsigned char> blocks(compressedImageBytes(blockFormat, width, height));
+                compressImage(blockFormat, baked.levels[level].data(), width, height, channels, options.quality, blocks.data());
+                if (blockFormat == BLOCK_BC7 && isOpaque(baked.levels[level].data(), width, height, channels)
+                    && !bc7StaysOpaque(blocks, width, height))
+                {
+                    std::cout << "ERROR::TEXBAKE::BC7_ALPHA: " << path << " level " << level << " is opaque but does not decode to alpha 255" << std::endl;
+                    return false;
+                }
+                baked.levels[level].swap(blocks);
+            }
+            record.levels[level].size = baked.levels[level].size();
+            width = nextWidth;
+            height = nextHeight;
+        }
+        return true;
+    }
+
+    // stb_image's JPEG kernels for one instruction set; the functions are internal to stb_image,
+    // which is why the benchmark lives in the translation unit holding its implementation
+    struct JpegKernels
+    {
+        const char* name;
+        void (*idct)(stbi_uc* out, int outStride, short data[64]);
+        stbi_uc* (*upsample)(stbi_uc* out, stbi_uc* inNear, stbi_uc* inFar, int width, int hs);
+        void (*convert)(stbi_uc* out, const stbi_uc* y, const stbi_uc* cb, const stbi_uc* cr, int count, int step);
+    };
+
+    std::vector<JpegKernels> availableJpegKernels()
+    {
+        std::vector<JpegKernels> kernels;
+        kernels.push_back({ "scalar", stbi__idct_block, stbi__resample_row_hv_2, stbi__YCbCr_to_RGB_row });
+#ifdef STBI_SSE2
+        kernels.push_back({ "sse2", stbi__idct_simd, stbi__resample_row_hv_2_simd, stbi__YCbCr_to_RGB_simd });
+#endif
+#ifdef STBI_AVX2
+        if (stbi__avx2_available())
+            kernels.push_back({ "avx2", stbi__idct_avx2, stbi__resample_row_hv_2_avx2, stbi__YCbCr_to_RGB_avx2 });
+#endif
+        return kernels;
+    }
+
+    // what the kernels see while decoding one image: the dequantized coefficients of every whole
+    // luma block, and the Y, Cb and Cr planes with chroma at full and at 4:2:0 resolution. These
+    // come from re-encoding the decoded pixels with the standard luma quantization table, which
+    // gives the IDCT realistic sparsity.
+    struct JpegKernelInput
+    {
+        int width = 0, height = 0, chromaWidth = 0, chromaHeight = 0;
+        std::vector<short> blocks;
+        std::vector<unsigned char> y, cb, cr, cbHalf, crHalf;
+    };
+
+    bool prepareJpegKernelInput(const std::string& path, JpegKernelInput& input)
+    {
+        int width, height, channels;
+        unsigned char* rgb = loadImageMapped(path, &width, &height, &channels, 3);
+        if (!rgb)
+        {
+            std::cout << "Texture failed to load at path: " << path << std::endl;
+            return false;
+        }
+        size_t texels = static_cast<size_t>(width) * height;
+        input.width = width;
+        input.height = height;
+        input.y.resize(texels);
+        input.cb.resize(texels);
+        input.cr.resize(texels);
+        auto toByte = [](float value) { return static_cast<unsigned char>(std::min(std::max(value + 0.5f, 0.0f), 255.0f)); };
+        for (size_t i = 0; i < texels; ++i)
+        {
+            float r = rgb[i * 3], g = rgb[i * 3 + 1], b = rgb[i * 3 + 2];
+            input.y[i] = toByte(0.299f * r + 0.587f * g + 0.114f * b);
+            input.cb[i] = toByte(-0.168736f * r - 0.331264f * g + 0.5f * b + 128.0f);
+            input.cr[i] = toByte(0.5f * r - 0.418688f * g - 0.081312f * b + 128.0f);
+        }
+        stbi_image_free(rgb);
+
+        input.chromaWidth = (width + 1) / 2;
+        input.chromaHeight = (height + 1) / 2;
+        input.cbHalf.resize(static_cast<size_t>(input.chromaWidth) * input.chromaHeight);
+        input.crHalf.resize(input.cbHalf.size());
+        for (int j = 0; j < input.chromaHeight; ++j)
+        {
+            for (int i = 0; i < input.chromaWidth; ++i)
+            {
+                int x0 = i * 2, y0 = j * 2, x1 = std::min(x0 + 1, width - 1), y1 = std::min(y0 + 1, height - 1);
+                size_t a = static_cast<size_t>(y0) * width, b = static_cast<size_t>(y1) * width;
+                size_t out = static_cast<size_t>(j) * input.chromaWidth + i;
+                input.cbHalf[out] = static_cast<unsigned char>((input.cb[a + x0] + input.cb[a + x1] + input.cb[b + x0] + input.cb[b + x1] + 2) / 4);
+                input.crHalf[out] = static_cast<unsigned char>((input.cr[a + x0] + input.cr[a + x1] + input.cr[b + x0] + input.cr[b + x1] + 2) / 4);
+            }
+        }
+
+        static const int LUMA_QUANT[64] = {
+            16, 11, 10, 16, 24, 40, 51, 61, 12, 12, 14, 19, 26, 58, 60, 55,
+            14, 13, 16, 24, 40, 57, 69, 56, 14, 17, 22, 29, 51, 87, 80, 62,
+            18, 22, 37, 56, 68, 109, 103, 77, 24, 35, 55, 64, 81, 104, 113, 92,
+            49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99 };
+        float basis[8][8]; // basis[u][x] = C(u) / 2 * cos((2x + 1) u pi / 16)
+        for (int u = 0; u < 8; ++u)
+            for (int x = 0; x < 8; ++x)
+                basis[u][x] = (u == 0 ? 0.35355339f : 0.5f) * std::cos((2 * x + 1) * u * 3.14159265f / 16.0f);
+        int blocksX = width / 8, blocksY = height / 8;
+        input.blocks.resize(static_cast<size_t>(blocksX) * blocksY * 64);
+        short* block = input.blocks.data();
+        for (int by = 0; by < blocksY; ++by)
+        {
+            for (int bx = 0; bx < blocksX; ++bx, block += 64)
+            {
+                float rows[8][8];
+                for (int y = 0; y < 8; ++y)
+                {
+                    const unsigned char* line = &input.y[static_cast<size_t>(by * 8 + y) * width + bx * 8];
+                    for (int u = 0; u < 8; ++u)
+                    {
+                        float sum = 0.0f;
+                        for (int x = 0; x < 8; ++x)
+                            sum += (line[x] - 128.0f) * basis[u][x];
+                        rows[y][u] = sum;
+                    }
+                }
+                for (int v = 0; v < 8; ++v)
+                {
+                    for (int u = 0; u < 8; ++u)
+                    {
+                        float sum = 0.0f;
+                        for (int y = 0; y < 8; ++y)
+                            sum += rows[y][u] * basis[v][y];
+                        int q = LUMA_QUANT[v * 8 + u];
+                        block[v * 8 + u] = static_cast<short>(static_cast<int>(std::lround(sum / q)) * q);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // seconds for the fastest of a few runs of work
+    template <typename Work>
+    double fastestRun(Work work)
+    {
+        double best = 1e30;
+        for (int run = 0; run < 5; ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            work();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    // times every available version of the IDCT, the h2v2 upsampler and the RGB and RGBA color
+    // conversion on each JPEG in the manifest, printing MB/s of output. Every version must produce
+    // exactly what the scalar one does; false if one does not or no image could be loaded.
+    bool benchmarkJpegKernels(const std::vector<ManifestEntry>& manifest)
+    {
+        std::vector<JpegKernels> kernels = availableJpegKernels();
+        std::vector<std::string> paths;
+        for (const ManifestEntry& entry : manifest)
+        {
+            std::string extension = entry.path.substr(std::min(entry.path.size(), entry.path.find_last_of('.') + 1));
+            for (char& c : extension)
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            if ((extension == "jpg" || extension == "jpeg") && std::find(paths.begin(), paths.end(), entry.path) == paths.end())
+                paths.push_back(entry.path);
+        }
+
+        bool matched = true;
+        size_t measured = 0;
+        std::cout << "JPEG kernel throughput in MB/s of output, fastest of 5 runs" << std::endl;
+        for (const std::string& path : paths)
+        {
+            JpegKernelInput input;
+            if (!prepareJpegKernelInput(path, input))
+                continue;
+            ++measured;
+            int width = input.width, height = input.height;
+            std::cout << "  " << path << " (" << width << "x" << height << ")" << std::endl;
+            std::cout << "    " << std::left << std::setw(16) << "kernel";
+            for (const JpegKernels& set : kernels)
+                std::cout << std::right << std::setw(10) << set.name;
+            std::cout << std::endl;
+
+            // the output of each version, compared against the first (scalar) one
+            const int KERNEL_COUNT = 4;
+            const char* kernelNames[KERNEL_COUNT] = { "idct", "upsample h2v2", "ycbcr->rgb", "ycbcr->rgba" };
+            std::vector<double> seconds(kernels.size() * KERNEL_COUNT);
+            std::vector<std::vector<unsigned char>> reference(KERNEL_COUNT);
+            size_t blockCount = input.blocks.size() / 64;
+            size_t outputBytes[KERNEL_COUNT] = { blockCount * 64, static_cast<size_t>(height) * input.chromaWidth * 2,
+                static_cast<size_t>(width) * height * 3, static_cast<size_t>(width) * height * 4 };
+            for (size_t k = 0; k < kernels.size(); ++k)
+            {
+                const JpegKernels& set = kernels[k];
+                std::vector<unsigned char> output[KERNEL_COUNT];
+
+                // the IDCT may use the block as scratch, so each call gets a fresh aligned copy
+                output[0].resize(outputBytes[0]);
+                seconds[k * KERNEL_COUNT] = fastestRun([&] {
+                    STBI_SIMD_ALIGN(short, data[64]);
+                    for (size_t b = 0; b < blockCount; ++b)
+                    {
+                        std::memcpy(data, &input.blocks[b * 64], sizeof(data));
+                        set.idct(&output[0][b * 64], 8, data);
+                    }
+                });
+
+                // one call per output row, blending the nearest chroma row with its neighbour the
+                // way load_jpeg_image does
+                output[1].resize(outputBytes[1]);
+                seconds[k * KERNEL_COUNT + 1] = fastestRun([&] {
+                    for (int j = 0; j < height; ++j)
+                    {
+                        int nearRow = j / 2, farRow = (j & 1) ? std::min(nearRow + 1, input.chromaHeight - 1) : std::max(nearRow - 1, 0);
+                        set.upsample(&output[1][static_cast<size_t>(j) * input.chromaWidth * 2],
+                            &input.cbHalf[static_cast<size_t>(nearRow) * input.chromaWidth],
+                            &input.cbHalf[static_cast<size_t>(farRow) * input.chromaWidth], input.chromaWidth, 2);
+                    }
+                });
+
+                for (int step = 3; step <= 4; ++step)
+                {
+                    std::vector<unsigned char>& pixels = output[step - 1];
+                    pixels.resize(outputBytes[step - 1] + 1); // the converters write a padding byte after a row
+                    seconds[k * KERNEL_COUNT + step - 1] = fastestRun([&] {
+                        for (int j = 0; j < height; ++j)
+                        {
+                            size_t row = static_cast<size_t>(j) * width;
+                            set.convert(&pixels[row * step], &input.y[row], &input.cb[row], &input.cr[row], width, step);
+                        }
+                    });
+                    pixels.resize(outputBytes[step - 1]);
+                }
+
+                for (int kernel = 0; kernel < KERNEL_COUNT; ++kernel)
+                {
+                    if (k == 0)
+                        reference[kernel].swap(output[kernel]);
+                    else if (output[kernel] != reference[kernel])
+                    {
+                        std::cout << "ERROR::TEXBAKE::KERNEL_MISMATCH: " << kernelNames[kernel] << " " << set.name << " on " << path << std::endl;
+                        matched = false;
+                    }
+                }
+            }
+
+            for (int kernel = 0; kernel < KERNEL_COUNT; ++kernel)
+            {
+                std::cout << "    " << std::left << std::setw(16) << kernelNames[kernel] << std::right << std::fixed << std::setprecision(0);
+                for (size_t k = 0; k < kernels.size(); ++k)
+                    std::cout << std::setw(10) << outputBytes[kernel] / seconds[k * KERNEL_COUNT + kernel] / 1e6;
+                std::cout << std::endl;
+            }
+        }
+        if (measured == 0)
+            std::cout << "ERROR::TEXBAKE::NO_JPEGS: nothing to benchmark in the manifest" << std::endl;
+        return matched && measured > 0;
+    }
+
+    // decodes every image in the manifest once per pool thread (and the caller) at the same time,
+    // first with stb_image's scratch memory from the heap, then from the per-thread decode arenas,
+    // and prints for each the fastest of 5 rounds: wall time, time spent in the allocator hooks
+    // and the calls they served. Both must give the same pixels; false if they do not or no image
+    // could be decoded.
+    bool benchmarkAllocator(const std::vector<ManifestEntry>& manifest, ThreadPool& pool)
+    {
+        std::vector<std::string> paths;
+        for (const ManifestEntry& entry : manifest)
+        {
+            if (std::find(paths.begin(), paths.end(), entry.path) == paths.end())
+                paths.push_back(entry.path);
+        }
+
+        const int tasks = static_cast<int>(pool.size()) + 1;
+        bool matched = true;
+        size_t measured = 0;
+        std::cout << "stb_image allocation, " << tasks << " concurrent decode(s) per image, fastest of 5 rounds" << std::endl;
+        std::cout << "  " << std::left << std::setw(36) << "image" << std::setw(8) << "scratch" << std::right
+            << std::setw(10) << "wall ms" << std::setw(10) << "alloc ms" << std::setw(8) << "heap" << std::setw(8) << "arena" << std::endl;
+        for (const std::string& path : paths)
+        {
+            MappedFile file;
+            if (!file.open(path) || file.size() > static_cast<size_t>(INT_MAX))
+            {
+                std::cout << "Texture failed to load at path: " << path << std::endl;
+                continue;
+            }
+            std::vector<unsigned char> reference;
+            bool decoded = true;
+            for (int useArena = 0; useArena < 2 && decoded; ++useArena)
+            {
+                double bestWall = 1e30;
+                DecodeArenaStats best;
+                for (int round = 0; round < 5 && decoded; ++round)
+                {
+                    std::vector<DecodeArenaStats> used(tasks);
+                    std::vector<unsigned char*> pixels(tasks, nullptr);
+                    std::vector<size_t> sizes(tasks, 0);
+                    auto start = std::chrono::steady_clock::now();
+                    pool.parallelFor(tasks, [&](int task) {
+                        DecodeArena& arena = threadDecodeArena();
+                        DecodeArenaStats before = arena.stats;
+                        arena.timing = true;
+                        int width = 0, height = 0, channels = 0;
+                        if (useArena)
+                            pixels[task] = decodeImage(file.data(), file.size(), &width, &height, &channels, 0);
+                        else
+                            pixels[task] = stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &channels, 0);
+                        arena.timing = false;
+                        sizes[task] = static_cast<size_t>(width) * height * channels;
+                        used[task].arenaAllocations = arena.stats.arenaAllocations - before.arenaAllocations;
+                        used[task].heapAllocations = arena.stats.heapAllocations - before.heapAllocations;
+                        used[task].milliseconds = arena.stats.milliseconds - before.milliseconds;
+                    });
+                    double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                    DecodeArenaStats total;
+                    for (int task = 0; task < tasks; ++task)
+                    {
+                        if (!pixels[task])
+                        {
+                            decoded = false;
+                            continue;
+                        }
+                        if (reference.empty())
+                            reference.assign(pixels[task], pixels[task] + sizes[task]);
+                        else if (sizes[task] != reference.size() || std::memcmp(pixels[task], reference.data(), sizes[task]) != 0)
+                        {
+                            std::cout << "ERROR::TEXBAKE::ALLOC_MISMATCH: " << path << std::endl;
+                            matched = false;
+                        }
+                        stbi_image_free(pixels[task]);
+                        total.arenaAllocations += used[task].arenaAllocations;
+                        total.heapAllocations += used[task].heapAllocations;
+                        total.milliseconds += used[task].milliseconds;
+                    }
+                    if (wall < bestWall)
+                    {
+                        bestWall = wall;
+                        best = total;
+                    }
+                }
+                if (!decoded)
+                {
+                    const char* reason = stbi_failure_reason();
+                    std::cout << "Texture failed to load at path: " << path << " (" << (reason ? reason : "unknown") << ")" << std::endl;
+                    break;
+                }
+                std::cout << "  " << std::left << std::setw(36) << (useArena ? "" : path) << std::setw(8) << (useArena ? "arena" : "heap")
+                    << std::right << std::fixed << std::setprecision(2) << std::setw(10) << bestWall << std::setw(10) << best.milliseconds
+                    << std::setw(8) << best.heapAllocations << std::setw(8) << best.arenaAllocations << std::endl;
+            }
+            if (decoded)
+                ++measured;
+        }
+        if (measured == 0)
+            std::cout << "ERROR::TEXBAKE::NO_IMAGES: nothing to benchmark in the manifest" << std::endl;
+        return matched && measured > 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BakeOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        std::cout << "Usage: " << argv[0] << " [--format auto|none|bc1|bc3|bc7] [--quality fast|normal|high] [--benchmark-jpeg] [--benchmark-alloc] [manifest] [output]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const std::string& outputPath = options.outputPath;
+
+    std::vector<ManifestEntry> manifest;
+    if (!readTextureManifest(options.manifestPath, manifest))
+        return EXIT_FAILURE;
+    if (options.benchmarkJpeg)
+        return benchmarkJpegKernels(manifest) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    ThreadPool pool;
+    if (options.benchmarkAlloc)
+        return benchmarkAllocator(manifest, pool) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    // images are baked one at a time, each large JPEG decoded on every core
+    useDecodePool(&pool);
+
+    // one pack entry per distinct (path, flip); sampler settings are applied at load time. Entries
+    // sharing an image are baked at the largest size any of them allows (no max beats every max),
+    // and the scene decodes the source instead for an entry whose max the pack exceeds.
+    std::vector<BakedTexture> textures;
+    for (size_t i = 0; i < manifest.size(); ++i)
+    {
+        const ManifestEntry& entry = manifest[i];
+        bool seen = false;
+        for (const BakedTexture& texture : textures)
+            seen = seen || (entry.path == texture.record.path && entry.flip == (texture.record.flipped != 0));
+        if (seen)
+            continue;
+        int maxSize = entry.maxSize;
+        for (size_t j = i + 1; j < manifest.size() && maxSize > 0; ++j)
+        {
+            if (manifest[j].path == entry.path && manifest[j].flip == entry.flip)
+                maxSize = manifest[j].maxSize > 0 ? std::max(maxSize, manifest[j].maxSize) : 0;
+        }
+        BakedTexture baked;
+        if (bake(entry.path, entry.flip, maxSize, options, baked))
+            textures.push_back(std::move(baked));
+    }
+
+    // lay the levels out after the directory
+    PackHeader header;
+    std::memcpy(header.magic, TEXTURE_PACK_MAGIC, sizeof(header.magic));
+    header.version = TEXTURE_PACK_VERSION;
+    header.textureCount = static_cast<uint32_t>(textures.size());
+    uint64_t offset = sizeof(PackHeader) + textures.size() * sizeof(PackTexture);
+    for (BakedTexture& texture : textures)
+    {
+        for (uint32_t level = 0; level < texture.record.levelCount; ++level)
+        {
+            offset = alignUp(offset, PACK_LEVEL_ALIGNMENT);
+            texture.record.levels[level].offset = offset;
+            offset += texture.record.levels[level].size;
+        }
+    }
+
+    // write to a temporary file first so a failed bake never leaves a truncated pack behind
+    std::string tempPath = outputPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cout << "ERROR::TEXBAKE::CANNOT_WRITE: " << tempPath << std::endl;
+            return EXIT_FAILURE;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const BakedTexture& texture : textures)
+            file.write(reinterpret_cast<const char*>(&texture.record), sizeof(PackTexture));
+        static const char padding[PACK_LEVEL_ALIGNMENT] = {};
+        for (const BakedTexture& texture : textures)
+        {
+            for (uint32_t level = 0; level < texture.record.levelCount; ++level)
+            {
+                uint64_t position = static_cast<uint64_t>(file.tellp());
+                file.write(padding, static_cast<std::streamsize>(texture.record.levels[level].offset - position));
+                file.write(reinterpret_cast<const char*>(texture.levels[level].data()),
+                    static_cast<std::streamsize>(texture.levels[level].size()));
+            }
+        }
+        if (!file)
+        {
+            std::cout << "ERROR::TEXBAKE::CANNOT_WRITE: " << tempPath << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::remove(outputPath.c_str());
+    if (std::rename(tempPath.c_str(), outputPath.c_str()) != 0)
+    {
+        std::cout << "ERROR::TEXBAKE::CANNOT_WRITE: " << outputPath << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Baked " << textures.size() << " texture(s) into " << outputPath << " (" << offset / 1024 << " KiB)" << std::endl;
+    for (const BakedTexture& texture : textures)
+    {
+        std::cout << "  " << texture.record.path << ": " << texture.record.levels[0].width << "x" << texture.record.levels[0].height
+            << " " << formatName(texture.record.format) << ", " << texture.record.levelCount << " levels"
+            << (texture.record.flipped ? ", flipped" : "") << std::endl;
+    }
+    return EXIT_SUCCESS;
+}